@@ -25,6 +25,8 @@
 #include "board.h"
 
 #include "hal/sysctl.h"
+#include "hal/dwt.h"
+#include "hal/gpdma.h"
 #include "hal/gpio.h"
 
 #include "clk.h"
@@ -58,18 +60,15 @@ void board_init(void)
 	// This means we have to configure all the peripherals first, and then
 	// activate PLL0.
 	gpio_init();
+	gpdma_init();
 	nfc_init();
 	ccc_init();
 
 	clk_init();
+	dwt_cyccnt_init();
 
 #ifndef NDEBUG
 	const u8 ver = nfc_get_device_version();
 	app_assert(ver == 0x1A);
 #endif // NDEBUG
-}
-
-void board_tick(void)
-{
-	ccc_tick();
 }
\ No newline at end of file
@@ -22,5 +22,4 @@
 
 #pragma once
 
-void board_init(void);
-void board_tick(void);
\ No newline at end of file
+void board_init(void);
\ No newline at end of file
@@ -28,9 +28,4 @@ void ccc_init(void)
 {
 	ccc_gpio_init();
 	ccc_usb_init();
-}
-
-void ccc_tick(void)
-{
-	ccc_usb_tick();
 }
\ No newline at end of file
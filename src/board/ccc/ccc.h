@@ -24,5 +24,4 @@
 
 #include "usb.h"
 
-void ccc_init(void);
-void ccc_tick(void);
\ No newline at end of file
+void ccc_init(void);
\ No newline at end of file
@@ -34,8 +34,10 @@
 #define CFG_TUSB_DEBUG 0
 #endif // CFG_TUSB_DEBUG
 
+// Endpoint buffers and DMA descriptors must be reachable by the USB DMA
+// engine; see linker-script.ld.
 #ifndef CFG_TUSB_MEM_SECTION
-#define CFG_TUSB_MEM_SECTION
+#define CFG_TUSB_MEM_SECTION __attribute__((section(".usb_ram")))
 #endif // CFG_TUSB_MEM_SECTION
 
 #ifndef CFG_TUSB_MEM_ALIGN
@@ -54,14 +56,25 @@
 #define CFG_TUD_MSC 0
 #define CFG_TUD_HID 0
 #define CFG_TUD_MIDI 0
-#define CFG_TUD_VENDOR 0
+#define CFG_TUD_VENDOR 1
 
 // Enable use of notification endpoint
 #define CFG_TUD_CDC_NOTIFY 1
 
-// CDC FIFO size of TX and RX
-#define CFG_TUD_CDC_RX_BUFSIZE (64)
-#define CFG_TUD_CDC_TX_BUFSIZE (64)
+// CDC FIFO size of TX and RX, large enough to hold a full-sized command frame
+// and its reply without stalling the host or the command task.
+#define CFG_TUD_CDC_RX_BUFSIZE (2048)
+#define CFG_TUD_CDC_TX_BUFSIZE (2048)
 
-// CDC Endpoint transfer buffer size, more is faster
-#define CFG_TUD_CDC_EP_BUFSIZE (64)
\ No newline at end of file
+// CDC Endpoint transfer buffer size, more is faster. Each transfer spans
+// several bulk packets.
+#define CFG_TUD_CDC_EP_BUFSIZE (512)
+
+// Vendor FIFO and endpoint buffer sizes, see the CDC ones above. The TX FIFO is
+// larger as bulk reads produce more data than the host sends. The endpoints
+// are still described with the full-speed bulk packet size. Together with the
+// CDC buffers, all of this has to fit into the 16K AHB SRAM bank reserved for
+// TinyUSB.
+#define CFG_TUD_VENDOR_RX_BUFSIZE (2048)
+#define CFG_TUD_VENDOR_TX_BUFSIZE (4096)
+#define CFG_TUD_VENDOR_EPSIZE (512)
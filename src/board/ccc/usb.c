@@ -27,11 +27,17 @@
 #include "common/util.h"
 
 #include "usb.h"
+#include "sched.h"
+#include "hal/dwt.h"
+#include "hal/nvic.h"
+#include "hal/scb.h"
 #include "hal/usb.h"
+#include "hal/util.h"
 
 enum {
-	CONFIG_TOTAL_LEN =
-		TUD_CONFIG_DESC_LEN + (CFG_TUD_CDC * TUD_CDC_DESC_LEN)
+	CONFIG_TOTAL_LEN = TUD_CONFIG_DESC_LEN +
+			   (CFG_TUD_CDC * TUD_CDC_DESC_LEN) +
+			   (CFG_TUD_VENDOR * TUD_VENDOR_DESC_LEN)
 };
 
 enum {
@@ -40,6 +46,7 @@ enum {
 	STRID_PRODUCT = 2,
 	STRID_SERIAL = 3,
 	STRID_INTERFACE = 4,
+	STRID_VENDOR_INTERFACE = 5,
 	STRID_NUM_MAX
 };
 
@@ -52,15 +59,28 @@ enum {
 enum {
 	EPNUM_CDC_0_NOTIF = 0x81,
 	EPNUM_CDC_0_OUT = 0x02,
-	EPNUM_CDC_0_IN = 0x82
+	EPNUM_CDC_0_IN = 0x82,
+
+	// Logical endpoints 3, 6, 9 and 12 are isochronous-only on this
+	// controller; 5 is the next one capable of bulk transfers.
+	EPNUM_VENDOR_0_OUT = 0x05,
+	EPNUM_VENDOR_0_IN = 0x85
 };
 
 enum {
 	ITF_NUM_CDC_0,
 	ITF_NUM_CDC_0_DATA,
+	ITF_NUM_VENDOR_0,
 	ITF_NUM_TOTAL,
 };
 
+// Instance numbers within TinyUSB's CDC and vendor class drivers, as opposed to
+// the interface numbers above.
+enum {
+	CDC_INST = 0,
+	VENDOR_INST = 0
+};
+
 static const tusb_desc_device_t dev = {
 	// clang-format off
 
@@ -85,7 +105,9 @@ static const tusb_desc_device_t dev = {
 static const u8 dev_desc_cfg[] = {
 	TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0x00, 100),
 	TUD_CDC_DESCRIPTOR(ITF_NUM_CDC_0, 4, EPNUM_CDC_0_NOTIF, 16,
-			   EPNUM_CDC_0_OUT, EPNUM_CDC_0_IN, 64)
+			   EPNUM_CDC_0_OUT, EPNUM_CDC_0_IN, 64),
+	TUD_VENDOR_DESCRIPTOR(ITF_NUM_VENDOR_0, STRID_VENDOR_INTERFACE,
+			      EPNUM_VENDOR_0_OUT, EPNUM_VENDOR_0_IN, 64)
 };
 
 // array of pointer to string descriptors
@@ -96,11 +118,69 @@ const char *const string_desc_arr[STRID_NUM_MAX] = {
 	[STRID_MANUFACTURER]	= "mcrod",
 	[STRID_PRODUCT]		= "OM26630FDK-Playground",
 	[STRID_SERIAL]		= "AllYourBaseAreBelongToUs",
-	[STRID_INTERFACE]	= "OM26630FDK-Playground CDC"
+	[STRID_INTERFACE]	= "OM26630FDK-Playground CDC",
+	[STRID_VENDOR_INTERFACE]	= "OM26630FDK-Playground Vendor"
 
 	// clang-format on
 };
 
+static struct ccc_usb_tx_stats tx_stats[CCC_USB_LINK_NUM];
+
+static struct {
+	/** Cycle count at which the oldest undispatched event was queued. */
+	u32 queued_at;
+	volatile bool pending;
+
+	struct ccc_usb_dispatch_stats stats;
+} dispatch;
+
+// TinyUSB's stack runs in PendSV, which has the lowest priority of all
+// exceptions. The USB interrupt queues events and pends PendSV; everything
+// else the firmware does in thread mode is preempted as soon as it returns.
+// Calls into TinyUSB from thread mode must hold this lock, as the class drivers
+// assume that they are not reentered.
+static u32 usb_lock(void)
+{
+	const u32 basepri = basepri_read();
+
+	basepri_write(nvic_prio_to_reg(NVIC_PRIO_LOWEST));
+	return basepri;
+}
+
+static void usb_unlock(const u32 basepri)
+{
+	basepri_write(basepri);
+}
+
+void isr_PendSV(void)
+{
+	const u32 latency = dwt_cyccnt_read() - dispatch.queued_at;
+
+	dispatch.pending = false;
+	dispatch.stats.dispatches++;
+	dispatch.stats.latency_last = latency;
+
+	if (latency > dispatch.stats.latency_max)
+		dispatch.stats.latency_max = latency;
+
+	tud_task();
+}
+
+void tud_event_hook_cb(const u8 rhport, const u32 eventid, const bool in_isr)
+{
+	(void)rhport;
+	(void)eventid;
+	(void)in_isr;
+
+	if (!dispatch.pending) {
+		dispatch.queued_at = dwt_cyccnt_read();
+		dispatch.pending = true;
+	}
+
+	dispatch.stats.events++;
+	scb_pendsv_set();
+}
+
 void isr_USB(void)
 {
 	tud_int_handler(ITF_NUM_CDC_0);
@@ -118,34 +198,130 @@ void ccc_usb_init(void)
 
 		// clang-format on
 	};
+
+	scb_pendsv_priority_set(NVIC_PRIO_LOWEST);
 	tusb_init(ITF_NUM_CDC_0, &dev_init);
 }
 
-void ccc_usb_tick(void)
+static bool link_connected(const enum ccc_usb_link link)
 {
-	tud_task();
+	switch (link) {
+	case CCC_USB_LINK_CDC:
+		return tud_cdc_n_connected(CDC_INST);
+
+	case CCC_USB_LINK_VENDOR:
+		return tud_vendor_n_mounted(VENDOR_INST);
+
+	default:
+		UNREACHABLE;
+	}
 }
 
-bool ccc_cdc_read_byte(u8 *const dst)
+u32 ccc_usb_read(const enum ccc_usb_link link, u8 *const dst, const u32 size)
 {
-	const int32_t ch = tud_cdc_n_read_char(ITF_NUM_CDC_0);
+	const u32 lock = usb_lock();
 
-	if (ch != -1) {
-		*dst = ch;
-		return true;
-	}
-	return false;
+	const u32 n = (link == CCC_USB_LINK_CDC) ?
+			      tud_cdc_n_read(CDC_INST, dst, size) :
+			      tud_vendor_n_read(VENDOR_INST, dst, size);
+
+	usb_unlock(lock);
+	return n;
 }
 
-bool ccc_cdc_write_byte(const u8 byte)
+bool ccc_usb_write(const enum ccc_usb_link link,
+		   const struct ccc_usb_buf *const bufs, const u32 num)
 {
-	if (tud_cdc_n_connected(ITF_NUM_CDC_0)) {
-		tud_cdc_n_write_char(ITF_NUM_CDC_0, byte);
-		tud_cdc_n_write_flush(ITF_NUM_CDC_0);
+	if (!link_connected(link))
+		return false;
+
+	u32 size = 0;
+
+	for (u32 i = 0; i < num; ++i)
+		size += bufs[i].size;
+
+	// TinyUSB starts a transfer by itself whenever a full packet's worth
+	// of data is queued, so the FIFO only fills up if the host stops
+	// reading. Waiting for it then would stall every task, so the write
+	// is refused whole rather than leaving part of it queued.
+	const u32 lock = usb_lock();
+	const u32 available = (link == CCC_USB_LINK_CDC) ?
+				      tud_cdc_n_write_available(CDC_INST) :
+				      tud_vendor_n_write_available(VENDOR_INST);
+
+	if (available < size) {
+		usb_unlock(lock);
+		tx_stats[link].drops++;
+		return false;
+	}
 
-		return true;
+	for (u32 i = 0; i < num; ++i) {
+		if (link == CCC_USB_LINK_CDC)
+			tud_cdc_n_write(CDC_INST, bufs[i].data, bufs[i].size);
+		else
+			tud_vendor_n_write(VENDOR_INST, bufs[i].data,
+					   bufs[i].size);
 	}
-	return false;
+
+	usb_unlock(lock);
+
+	tx_stats[link].bytes += size;
+	return true;
+}
+
+void ccc_usb_flush(const enum ccc_usb_link link)
+{
+	const u32 lock = usb_lock();
+
+	const u32 n = (link == CCC_USB_LINK_CDC) ?
+			      tud_cdc_n_write_flush(CDC_INST) :
+			      tud_vendor_n_write_flush(VENDOR_INST);
+
+	usb_unlock(lock);
+
+	if (n)
+		tx_stats[link].flushes++;
+}
+
+void ccc_usb_tx_stats_get(const enum ccc_usb_link link,
+			  struct ccc_usb_tx_stats *const stats)
+{
+	*stats = tx_stats[link];
+}
+
+void ccc_usb_dispatch_stats_get(struct ccc_usb_dispatch_stats *const stats)
+{
+	*stats = dispatch.stats;
+}
+
+void tud_cdc_rx_cb(const u8 itf)
+{
+	(void)itf;
+	sched_signal(SCHED_TASK_CCC);
+}
+
+void tud_vendor_rx_cb(const u8 itf, const u8 *const buffer,
+		      const u16 bufsize)
+{
+	(void)itf;
+	(void)buffer;
+	(void)bufsize;
+
+	sched_signal(SCHED_TASK_CCC);
+}
+
+void tud_cdc_tx_complete_cb(const u8 itf)
+{
+	if (itf == CDC_INST)
+		tx_stats[CCC_USB_LINK_CDC].packets++;
+}
+
+void tud_vendor_tx_cb(const u8 itf, const u32 sent_bytes)
+{
+	(void)sent_bytes;
+
+	if (itf == VENDOR_INST)
+		tx_stats[CCC_USB_LINK_VENDOR].packets++;
 }
 
 u8 const *tud_descriptor_device_cb(void)
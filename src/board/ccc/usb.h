@@ -25,14 +25,86 @@
 #include <stdbool.h>
 #include "common/types.h"
 
+// Matches the endpoint buffer sizes in tusb_config.h, so that a whole OUT
+// transfer is drained at once.
 enum {
-	CCC_USB_RX_SIZE_MAX = 64,
-	CCC_USB_TX_SIZE_MAX = 64
+	CCC_USB_RX_SIZE_MAX = 512,
+	CCC_USB_TX_SIZE_MAX = 512
+};
+
+/**
+ * The interfaces which carry the command protocol. The vendor interface has
+ * its own bulk endpoints and no line-coding or control-line state, which makes
+ * it the faster of the two for host tooling; the CDC interface remains for
+ * terminals and existing tools.
+ */
+enum ccc_usb_link {
+	CCC_USB_LINK_CDC,
+	CCC_USB_LINK_VENDOR,
+	CCC_USB_LINK_NUM
 };
 
 void ccc_usb_init(void);
-void ccc_usb_tick(void);
 
-bool ccc_cdc_read_byte(u8 *dst);
+/**
+ * Moves up to @p size bytes which the host has sent out of the RX FIFO of
+ * @p link.
+ *
+ * @returns The number of bytes read, 0 if the FIFO is empty.
+ */
+u32 ccc_usb_read(enum ccc_usb_link link, u8 *dst, u32 size);
+
+struct ccc_usb_tx_stats {
+	/** Bytes handed to the interface. */
+	u32 bytes;
+
+	/** Completed IN transfers, including zero-length packets. */
+	u32 packets;
+
+	/** Explicit flushes which started a transfer. */
+	u32 flushes;
+
+	/** Writes refused as the TX FIFO could not take all of them. */
+	u32 drops;
+};
+
+/** A piece of a write, such as the header of a frame. */
+struct ccc_usb_buf {
+	const u8 *data;
+	u32 size;
+};
+
+/**
+ * Queues the @p num pieces in @p bufs for transmission as one, without
+ * flushing them, so that the replies produced within a tick share as few USB
+ * packets as possible. A transfer is started early only once a full packet has
+ * been queued.
+ *
+ * @returns false if the host is not connected or the TX FIFO cannot take all
+ * of the pieces, in which case none of them is queued.
+ */
+bool ccc_usb_write(enum ccc_usb_link link, const struct ccc_usb_buf *bufs,
+		   u32 num);
+
+/** Sends whatever has been queued by ccc_usb_write(). */
+void ccc_usb_flush(enum ccc_usb_link link);
+
+void ccc_usb_tx_stats_get(enum ccc_usb_link link,
+			  struct ccc_usb_tx_stats *stats);
+
+struct ccc_usb_dispatch_stats {
+	/** Events queued by the USB interrupt and the class drivers. */
+	u32 events;
+
+	/** Runs of the USB stack from PendSV. */
+	u32 dispatches;
+
+	/**
+	 * Cycles from the oldest pending event being queued to the stack
+	 * starting to process it, for the latest and the slowest dispatch.
+	 */
+	u32 latency_last;
+	u32 latency_max;
+};
 
-bool ccc_cdc_write_byte(u8 byte);
\ No newline at end of file
+void ccc_usb_dispatch_stats_get(struct ccc_usb_dispatch_stats *stats);
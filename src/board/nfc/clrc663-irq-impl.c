@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stdbool.h>
+
+#include "drivers/clrc663/clrc663-irq.h"
+#include "hal/gpio.h"
+#include "hal/nvic.h"
+#include "hal/util.h"
+#include "sched.h"
+
+#include "gpio.h"
+#include "irq.h"
+
+// The IRQ pin of the CLRC663 is configured as a push-pull, active-high output
+// by drv_clrc663_irq_arm(). Its rising edge is caught by the port 2 GPIO
+// interrupt, which shares the EINT3 vector.
+
+static struct {
+	volatile bool asserted;
+} clrc_irq;
+
+void isr_EINT3(void)
+{
+	if (gpio_pin_int_pending(GPIO_PIN_CLRC_IRQ)) {
+		gpio_pin_int_clear(GPIO_PIN_CLRC_IRQ);
+		clrc_irq.asserted = true;
+	}
+}
+
+void nfc_irq_init(void)
+{
+	gpio_pin_int_clear(GPIO_PIN_CLRC_IRQ);
+	gpio_pin_int_enable(GPIO_PIN_CLRC_IRQ, GPIO_INT_EDGE_RISING);
+
+	nvic_irq_enable(NVIC_IRQ_EINT3);
+}
+
+void drv_clrc663_irq_pin_arm(void)
+{
+	gpio_pin_int_clear(GPIO_PIN_CLRC_IRQ);
+
+	// The edge may have happened before the interrupt was cleared.
+	clrc_irq.asserted = gpio_pin_read(GPIO_PIN_CLRC_IRQ);
+}
+
+bool drv_clrc663_irq_pin_asserted(void)
+{
+	return clrc_irq.asserted;
+}
+
+bool drv_clrc663_irq_pin_wait(const u32 timeout_us)
+{
+	const u64 start = sched_time_us();
+
+	for (;;) {
+		// Sleep until the next interrupt, but check first with
+		// interrupts masked so that the edge cannot slip in between.
+		irq_disable();
+
+		if (clrc_irq.asserted) {
+			irq_enable();
+			return true;
+		}
+
+		// The tick interrupt cannot run in here; a pending tick
+		// would otherwise put the time behind start.
+		if (sched_time_us_masked() - start >= timeout_us) {
+			irq_enable();
+			return false;
+		}
+
+		wfi();
+		irq_enable();
+	}
+}
@@ -21,12 +21,74 @@
 // SOFTWARE.
 
 #include <stddef.h>
+#include <string.h>
 
+#include "drivers/clrc663/clrc663.h"
 #include "drivers/clrc663/clrc663-spi.h"
+#include "hal/gpdma.h"
+#include "hal/util.h"
 
 #include "gpio.h"
 #include "spi.h"
 
+enum {
+	// Transfers up to the depth of the SSP FIFO are cheaper to do by hand
+	// than to set up the GPDMA for.
+	DMA_THRESHOLD = 8,
+
+	// A full FIFO burst plus its address byte.
+	DMA_BUF_SIZE = DRV_CLRC663_FIFO_NUM_BYTES_MAX + 1
+};
+
+// Buffers in the local SRAM, which the GPDMA cannot reach, are staged here.
+// Those the callers already keep in GPDMA_MEM are transferred in place.
+static GPDMA_MEM u8 dma_tx_buf[DMA_BUF_SIZE];
+static GPDMA_MEM u8 dma_rx_buf[DMA_BUF_SIZE];
+
+static void dma_wait(void)
+{
+	// isr_GPDMA reports the completion; sleep until then instead of
+	// polling, checking with interrupts masked so that it cannot slip in
+	// between the check and the WFI.
+	for (;;) {
+		irq_disable();
+
+		if (!spi_dma_busy(SPI_INST)) {
+			irq_enable();
+			return;
+		}
+
+		wfi();
+		irq_enable();
+	}
+}
+
+static void dma_xfer(const u8 *const src, const u8 fill, u8 *const dst,
+		     const size_t size)
+{
+	const bool stage_src = src && !gpdma_addr_reachable(src);
+	const bool stage_dst = dst && !gpdma_addr_reachable(dst);
+
+	if (stage_src)
+		memcpy(dma_tx_buf, src, size);
+
+	const struct spi_dma_desc desc = {
+		// clang-format off
+
+		.src	= stage_src ? dma_tx_buf : src,
+		.fill	= fill,
+		.dst	= stage_dst ? dma_rx_buf : dst,
+		.size	= size
+
+		// clang-format on
+	};
+	spi_dma_tx_rx_u8(SPI_INST, &desc, 1, NULL, NULL);
+	dma_wait();
+
+	if (stage_dst)
+		memcpy(dst, dma_rx_buf, size);
+}
+
 void drv_clrc663_nss_pin_set_low(void)
 {
 	gpio_pin_set_low(GPIO_PIN_LPC_SSEL);
@@ -39,11 +101,26 @@ void drv_clrc663_nss_pin_set_high(void)
 
 void drv_clrc663_spi_tx_blocking(const u8 *const src, const size_t src_size)
 {
-	spi_tx_blocking_u8(SPI_INST, src, src_size);
+	if ((src_size > DMA_THRESHOLD) && (src_size <= DMA_BUF_SIZE))
+		dma_xfer(src, 0, NULL, src_size);
+	else
+		spi_tx_blocking_u8(SPI_INST, src, src_size);
 }
 
 void drv_clrc663_spi_tx_rx_blocking(const u8 *const src, u8 *const dst,
 				    const size_t size)
 {
-	spi_tx_rx_blocking_u8(SPI_INST, src, dst, size);
-}
\ No newline at end of file
+	if ((size > DMA_THRESHOLD) && (size <= DMA_BUF_SIZE))
+		dma_xfer(src, 0, dst, size);
+	else
+		spi_tx_rx_blocking_u8(SPI_INST, src, dst, size);
+}
+
+void drv_clrc663_spi_rx_fill_blocking(const u8 fill, u8 *const dst,
+				      const size_t size)
+{
+	if ((size > DMA_THRESHOLD) && (size <= DMA_BUF_SIZE))
+		dma_xfer(NULL, fill, dst, size);
+	else
+		spi_rx_blocking_u8(SPI_INST, fill, dst, size);
+}
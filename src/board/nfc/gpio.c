@@ -91,6 +91,20 @@ static void pin_init_clrc_rst(void)
 	gpio_pin_init(GPIO_PIN_CLRC_RST, &cfg);
 }
 
+static void pin_init_clrc_irq(void)
+{
+	const struct gpio_pin_cfg cfg = {
+		// clang-format off
+
+		.resistor	= PINMODE_RESISTOR_PULL_DOWN,
+		.pin_func	= PINSEL_FUNC_GPIO,
+		.dir		= GPIO_PIN_DIR_INPUT
+
+		// clang-format on
+	};
+	gpio_pin_init(GPIO_PIN_CLRC_IRQ, &cfg);
+}
+
 void nfc_gpio_init(void)
 {
 	pin_init_lpc_sck();
@@ -99,4 +113,5 @@ void nfc_gpio_init(void)
 	pin_init_lpc_mosi();
 
 	pin_init_clrc_rst();
+	pin_init_clrc_irq();
 }
\ No newline at end of file
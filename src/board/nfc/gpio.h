@@ -31,6 +31,7 @@
 #define GPIO_PIN_LPC_MISO	(&GPIO_PIN_P_0_17)
 #define GPIO_PIN_LPC_MOSI	(&GPIO_PIN_P_0_18)
 #define GPIO_PIN_CLRC_RST	(&GPIO_PIN_P_2_5)
+#define GPIO_PIN_CLRC_IRQ	(&GPIO_PIN_P_2_12)
 
 // clang-format on
 
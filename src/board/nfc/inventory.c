@@ -0,0 +1,231 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <string.h>
+
+#include "common/types.h"
+#include "hal/dwt.h"
+
+#include "inventory.h"
+#include "iso14443a.h"
+#include "nfc.h"
+
+enum {
+	// Each collision pushes one branch, and each card found pops at most
+	// one, so this covers a full field without falling back to the root.
+	BRANCH_NUM_MAX = INVENTORY_CARD_NUM_MAX,
+
+	// Bounds the walk if a card keeps answering but fails to be selected.
+	WALK_ROUND_NUM_MAX = 2 * INVENTORY_CARD_NUM_MAX
+};
+
+static struct {
+	struct iso14443a_card cards[INVENTORY_CARD_NUM_MAX];
+	u32 card_num;
+
+	// Untaken branches of the anticollision tree. When they run out
+	// while cards still answer, the walk restarts from the root.
+	struct iso14443a_path branches[BRANCH_NUM_MAX];
+	u32 branch_num;
+
+	struct inventory_event events[INVENTORY_EVENT_NUM_MAX];
+	u32 event_head;
+	u32 event_num;
+
+	struct inventory_stats stats;
+} inventory;
+
+static void event_push(const enum inventory_event_type type,
+		       const struct iso14443a_card *const card)
+{
+	if (inventory.event_num == INVENTORY_EVENT_NUM_MAX) {
+		inventory.stats.events_dropped++;
+		return;
+	}
+
+	const u32 idx = (inventory.event_head + inventory.event_num) %
+			INVENTORY_EVENT_NUM_MAX;
+
+	inventory.events[idx].type = type;
+	inventory.events[idx].card = *card;
+	inventory.event_num++;
+}
+
+static void branch_push(void *const ctx,
+			const struct iso14443a_path *const branch)
+{
+	(void)ctx;
+
+	// A branch which does not fit is not lost: its cards still answer the
+	// REQA of the root walk.
+	if (inventory.branch_num == BRANCH_NUM_MAX)
+		return;
+
+	inventory.branches[inventory.branch_num++] = *branch;
+}
+
+/** Checks on the known cards, dropping those which are gone. */
+static void check_known(void)
+{
+	u32 i = 0;
+
+	while (i < inventory.card_num) {
+		struct iso14443a_card *const card = &inventory.cards[i];
+
+		inventory.stats.checks++;
+
+		const enum nfc_status status =
+			iso14443a_reselect(ISO14443A_REQ_WUPA, card);
+
+		if (status == NFC_STATUS_OK) {
+			iso14443a_halt();
+			i++;
+			continue;
+		}
+
+		// Anything but silence may be a transient error; the card is
+		// checked again on the next poll.
+		if (status != NFC_STATUS_TIMEOUT) {
+			i++;
+			continue;
+		}
+
+		event_push(INVENTORY_EVENT_DEPARTED, card);
+		inventory.stats.departures++;
+
+		*card = inventory.cards[--inventory.card_num];
+	}
+}
+
+static bool is_known(const struct iso14443a_card *const card)
+{
+	for (u32 i = 0; i < inventory.card_num; ++i) {
+		const struct iso14443a_card *const known = &inventory.cards[i];
+
+		if ((known->uid_size == card->uid_size) &&
+		    !memcmp(known->uid, card->uid, card->uid_size))
+			return true;
+	}
+
+	return false;
+}
+
+/** Finds the cards which are not halted, i.e. the new ones. */
+static void walk(void)
+{
+	inventory.branch_num = 0;
+
+	for (u32 round = 0; round < WALK_ROUND_NUM_MAX; ++round) {
+		struct iso14443a_card card;
+
+		// Cards moved to IDLE by the previous round's SELECTs answer
+		// REQA again; halted ones do not. Silence means that all cards
+		// have been found, whatever branches are left.
+		if (iso14443a_request(ISO14443A_REQ_REQA, card.atqa) ==
+		    NFC_STATUS_TIMEOUT)
+			break;
+
+		struct iso14443a_path path = {
+			// clang-format off
+
+			.level		= 0,
+			.known_bits	= 0
+
+			// clang-format on
+		};
+
+		if (inventory.branch_num)
+			path = inventory.branches[--inventory.branch_num];
+
+		inventory.stats.branches++;
+
+		if (iso14443a_select_path(&path, branch_push, NULL, &card) !=
+		    NFC_STATUS_OK)
+			continue;
+
+		iso14443a_halt();
+
+		if (is_known(&card))
+			continue;
+
+		if (inventory.card_num == INVENTORY_CARD_NUM_MAX) {
+			inventory.stats.cards_dropped++;
+			continue;
+		}
+
+		inventory.cards[inventory.card_num++] = card;
+
+		event_push(INVENTORY_EVENT_ARRIVED, &card);
+		inventory.stats.arrivals++;
+	}
+}
+
+u32 inventory_poll(void)
+{
+	const u32 start = dwt_cyccnt_read();
+
+	check_known();
+	walk();
+
+	const u32 cycles = dwt_cyccnt_read() - start;
+
+	inventory.stats.polls++;
+	inventory.stats.time_last = cycles;
+
+	if (cycles > inventory.stats.time_max)
+		inventory.stats.time_max = cycles;
+
+	return inventory.card_num;
+}
+
+void inventory_reset(void)
+{
+	inventory.card_num = 0;
+	inventory.branch_num = 0;
+	inventory.event_head = 0;
+	inventory.event_num = 0;
+}
+
+bool inventory_event_pop(struct inventory_event *const event)
+{
+	if (!inventory.event_num)
+		return false;
+
+	*event = inventory.events[inventory.event_head];
+
+	inventory.event_head =
+		(inventory.event_head + 1) % INVENTORY_EVENT_NUM_MAX;
+	inventory.event_num--;
+
+	return true;
+}
+
+const struct iso14443a_card *inventory_cards_get(u32 *const num)
+{
+	*num = inventory.card_num;
+	return inventory.cards;
+}
+
+void inventory_stats_get(struct inventory_stats *const stats)
+{
+	*stats = inventory.stats;
+}
@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "common/types.h"
+#include "iso14443a.h"
+#include "nfc.h"
+
+enum {
+	INVENTORY_CARD_NUM_MAX = 16,
+	INVENTORY_EVENT_NUM_MAX = 32
+};
+
+enum inventory_event_type {
+	INVENTORY_EVENT_ARRIVED,
+	INVENTORY_EVENT_DEPARTED
+};
+
+struct inventory_event {
+	enum inventory_event_type type;
+	struct iso14443a_card card;
+};
+
+struct inventory_stats {
+	u32 polls;
+
+	/** Nodes of the anticollision tree visited to find new cards */
+	u32 branches;
+
+	/** Known cards checked for by selecting them directly */
+	u32 checks;
+
+	u32 arrivals;
+	u32 departures;
+
+	/** Cards found while the inventory was full */
+	u32 cards_dropped;
+
+	/** Events lost because the queue was full */
+	u32 events_dropped;
+
+	/** Duration of a poll, in core cycles */
+	u32 time_last;
+	u32 time_max;
+};
+
+/**
+ * Updates the set of ISO/IEC 14443A cards in the field. The 14443A-106
+ * protocol must be loaded and the field on.
+ *
+ * Every known card is woken with WUPA and selected by its UID; a card which
+ * does not answer has departed. All cards found are left halted, so that only
+ * newly arrived ones answer the REQA with which the anticollision tree is then
+ * walked. Arrivals and departures are queued as events.
+ *
+ * @returns the number of cards in the field.
+ */
+u32 inventory_poll(void);
+
+/** Forgets all cards and pending events. */
+void inventory_reset(void);
+
+/** @returns false if no event is pending. */
+bool inventory_event_pop(struct inventory_event *event);
+
+/**
+ * @returns the cards currently in the field, and their number in @p num. The
+ * list is only valid until the next poll.
+ */
+const struct iso14443a_card *inventory_cards_get(u32 *num);
+
+void inventory_stats_get(struct inventory_stats *stats);
@@ -0,0 +1,622 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <string.h>
+
+#include "common/types.h"
+#include "common/util.h"
+#include "hal/dwt.h"
+#include "hal/gpdma.h"
+#include "hal/sysctl.h"
+
+#include "iso14443_4.h"
+#include "nfc.h"
+
+enum {
+	CMD_RATS = 0xE0,
+	CMD_PPSS = 0xD0,
+
+	// FSDI 9, CID 0
+	RATS_PARAM = 0x90,
+
+	// PPS1 follows PPS0.
+	PPS0_PPS1 = 0x11,
+
+	PCB_BLOCK_NUM = BIT_0,
+	PCB_CHAINING = BIT_4,
+
+	PCB_I = 0x02,
+	PCB_R_ACK = 0xA2,
+	PCB_R_NAK = 0xB2,
+	PCB_S_DESELECT = 0xC2,
+	PCB_S_WTX = 0xF2,
+
+	// The bits telling the block type apart; the CID and NAD bits must be
+	// clear, as neither is used.
+	PCB_MASK_I = 0xEE,
+	PCB_MASK_R = 0xFE,
+
+	T0_FSCI = 0x0F,
+	T0_TA = BIT_4,
+	T0_TB = BIT_5,
+	T0_TC = BIT_6,
+
+	TA_SHIFT_DS = 4,
+	TA_MASK_D = 0x07,
+
+	TB_SHIFT_FWI = 4,
+	TB_MASK_SFGI = 0x0F,
+
+	// Defaults for an ATS without T0 or TB(1)
+	FSCI_DEFAULT = 2,
+	FWI_DEFAULT = 4,
+	SFGI_DEFAULT = 0,
+
+	// Values above are reserved, and taken as the largest one.
+	FSCI_MAX = 0x0C,
+	FWI_MAX = 14,
+
+	WTXM_MASK = 0x3F,
+	WTXM_MAX = 59,
+
+	// FWT for RATS and DESELECT: 65536/fc (4.8 ms), plus the 49152/fc
+	// (3.6 ms) the reader allows on top of any FWT.
+	FWT_ACTIVATION_US = 8459,
+
+	// Per block, before the exchange is given up
+	RETRY_NUM_MAX = 2,
+
+	// Bounds the time a card can keep the reader waiting for one block.
+	WTX_NUM_MAX = 32
+};
+
+static const u16 fsc_tbl[FSCI_MAX + 1] = {
+	16, 24, 32, 40, 48, 64, 96, 128, 256, 512, 1024, 2048, 4096
+};
+
+static const enum nfc_protocol protocol_tbl[ISO14443_4_DIV_NUM] = {
+	// clang-format off
+
+	[ISO14443_4_DIV_1]	= NFC_PROTOCOL_MIFARE_106,
+	[ISO14443_4_DIV_2]	= NFC_PROTOCOL_MIFARE_212,
+	[ISO14443_4_DIV_4]	= NFC_PROTOCOL_MIFARE_424,
+	[ISO14443_4_DIV_8]	= NFC_PROTOCOL_MIFARE_848
+
+	// clang-format on
+};
+
+static struct {
+	bool active;
+	u8 block_num;
+
+	/** The bit rates the card and the reader are at */
+	enum iso14443_4_div ds;
+	enum iso14443_4_div dr;
+
+	/** Largest frame to send, the smaller of FSC and FSD */
+	u32 frame_size_max;
+	u32 fwt_us;
+
+	struct iso14443_4_stats stats;
+} session;
+
+// Blocks without their CRC, which the CLRC663 appends and checks. They are
+// transceived in place, so they are kept where the GPDMA can reach them.
+static GPDMA_MEM struct {
+	u8 tx[ISO14443_4_FSD - 2];
+	u8 rx[ISO14443_4_FSD - 2];
+} block;
+
+/** Frame waiting time for @p fwi: 4096/fc * 2^FWI, plus 49152/fc. */
+static u32 fwt_us(const u8 fwi)
+{
+	const u64 ticks = (UINT64_C(4096) << fwi) + 49152;
+	return ((ticks * 1000) + 13559) / 13560;
+}
+
+static void wait_us(const u32 us)
+{
+	const u32 start = dwt_cyccnt_read();
+	const u32 cycles = us * (SYSCTL_CCLK_HZ / mhz_to_hz(1));
+
+	while ((dwt_cyccnt_read() - start) < cycles)
+		;
+}
+
+static enum nfc_status frame_xfer(const u8 *const tx, const u32 tx_size,
+				  const u32 timeout_us, u32 *const rx_size)
+{
+	const struct nfc_xfer xfer = {
+		// clang-format off
+
+		.tx		= tx,
+		.tx_size	= tx_size,
+		.flags		= NFC_XFER_TX_CRC | NFC_XFER_RX_CRC,
+		.rx		= block.rx,
+		.rx_size_max	= sizeof(block.rx),
+		.timeout_us	= timeout_us
+
+		// clang-format on
+	};
+
+	struct nfc_xfer_result result;
+	const enum nfc_status status = nfc_transceive(&xfer, &result);
+
+	*rx_size = result.rx_size;
+	return status;
+}
+
+static bool block_valid(const u32 size)
+{
+	if (!size)
+		return false;
+
+	const u8 pcb = block.rx[0];
+
+	if ((pcb & PCB_MASK_I) == PCB_I)
+		return true;
+
+	if ((pcb & PCB_MASK_R) == PCB_R_ACK)
+		return size == 1;
+
+	if (pcb == PCB_S_WTX)
+		return (size == 2) && (block.rx[1] & WTXM_MASK);
+
+	return false;
+}
+
+/** Whether the card may still answer, if asked to resend its block. */
+static bool recoverable(const enum nfc_status status)
+{
+	switch (status) {
+	case NFC_STATUS_TIMEOUT:
+	case NFC_STATUS_COLLISION:
+	case NFC_STATUS_INTEGRITY:
+	case NFC_STATUS_PROTOCOL:
+	case NFC_STATUS_MIN_FRAME:
+	case NFC_STATUS_OVERFLOW:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+/**
+ * Sends the block of @p tx_size bytes in the transmit buffer and receives the
+ * card's answer, which is an I-block or R(ACK), into the receive buffer.
+ * Waiting time extensions are granted on the way. Errors are recovered from
+ * by asking the card for its block again: with R(ACK) while it is chaining
+ * (@p rx_chaining), and R(NAK) otherwise.
+ */
+static enum nfc_status block_xfer(const u32 tx_size, const bool rx_chaining,
+				  u32 *const rx_size)
+{
+	const u8 *tx = block.tx;
+	u32 size = tx_size;
+	u32 timeout_us = session.fwt_us;
+
+	u32 retry_num = 0;
+	u32 wtx_num = 0;
+
+	u8 rsp[2];
+
+	for (;;) {
+		session.stats.blocks_tx++;
+
+		enum nfc_status status = frame_xfer(tx, size, timeout_us,
+						    rx_size);
+
+		if ((status == NFC_STATUS_OK) && !block_valid(*rx_size))
+			status = NFC_STATUS_PROTOCOL;
+
+		if (status == NFC_STATUS_OK) {
+			session.stats.blocks_rx++;
+
+			if (block.rx[0] != PCB_S_WTX)
+				return status;
+
+			if (++wtx_num > WTX_NUM_MAX)
+				return NFC_STATUS_TIMEOUT;
+
+			session.stats.wtx++;
+
+			// The card has answered; only errors after its answer
+			// count against the block.
+			retry_num = 0;
+
+			u8 wtxm = block.rx[1] & WTXM_MASK;
+
+			if (wtxm > WTXM_MAX)
+				wtxm = WTXM_MAX;
+
+			// The extension only applies to the block answering
+			// S(WTX).
+			rsp[0] = PCB_S_WTX;
+			rsp[1] = wtxm;
+
+			tx = rsp;
+			size = 2;
+			timeout_us = session.fwt_us * wtxm;
+			continue;
+		}
+
+		if (!recoverable(status) || (++retry_num > RETRY_NUM_MAX))
+			return status;
+
+		session.stats.retransmissions++;
+
+		rsp[0] = (rx_chaining ? PCB_R_ACK : PCB_R_NAK) |
+			 session.block_num;
+
+		tx = rsp;
+		size = 1;
+		timeout_us = session.fwt_us;
+	}
+}
+
+static enum nfc_status exchange(const u8 *const tx, const u32 tx_size,
+				u8 *const rx, const u32 rx_size_max,
+				u32 *const rx_size)
+{
+	const u32 inf_size_max = session.frame_size_max - 3;
+
+	u32 tx_pos = 0;
+	u32 retry_num = 0;
+	u32 size;
+
+	// Send the command, chaining it across blocks of the largest size the
+	// card accepts; the response follows the last one.
+	for (;;) {
+		const u32 left = tx_size - tx_pos;
+		const u32 inf_size = (left < inf_size_max) ? left :
+							      inf_size_max;
+		const bool chaining = (tx_pos + inf_size) < tx_size;
+
+		block.tx[0] = PCB_I | session.block_num;
+
+		if (chaining)
+			block.tx[0] |= PCB_CHAINING;
+
+		memcpy(&block.tx[1], &tx[tx_pos], inf_size);
+
+		const enum nfc_status status =
+			block_xfer(1 + inf_size, false, &size);
+
+		if (status != NFC_STATUS_OK)
+			return status;
+
+		const u8 pcb = block.rx[0];
+
+		if ((pcb & PCB_MASK_I) == PCB_I) {
+			if (chaining)
+				return NFC_STATUS_PROTOCOL;
+
+			session.stats.bytes_tx += inf_size;
+			break;
+		}
+
+		// An R(ACK) for another block number means that the card
+		// missed this block.
+		if ((pcb & PCB_BLOCK_NUM) != session.block_num) {
+			if (++retry_num > RETRY_NUM_MAX)
+				return NFC_STATUS_PROTOCOL;
+
+			session.stats.retransmissions++;
+			continue;
+		}
+
+		if (!chaining)
+			return NFC_STATUS_PROTOCOL;
+
+		session.stats.bytes_tx += inf_size;
+		session.block_num ^= PCB_BLOCK_NUM;
+		tx_pos += inf_size;
+		retry_num = 0;
+	}
+
+	// Receive the response, acknowledging each block the card chains.
+	u32 rx_pos = 0;
+
+	for (;;) {
+		const u8 pcb = block.rx[0];
+
+		if (((pcb & PCB_MASK_I) != PCB_I) ||
+		    ((pcb & PCB_BLOCK_NUM) != session.block_num))
+			return NFC_STATUS_PROTOCOL;
+
+		session.block_num ^= PCB_BLOCK_NUM;
+
+		const u32 inf_size = size - 1;
+
+		if ((rx_pos + inf_size) > rx_size_max)
+			return NFC_STATUS_OVERFLOW;
+
+		memcpy(&rx[rx_pos], &block.rx[1], inf_size);
+		rx_pos += inf_size;
+
+		session.stats.bytes_rx += inf_size;
+
+		if (!(pcb & PCB_CHAINING))
+			break;
+
+		block.tx[0] = PCB_R_ACK | session.block_num;
+
+		const enum nfc_status status = block_xfer(1, true, &size);
+
+		if (status != NFC_STATUS_OK)
+			return status;
+	}
+
+	*rx_size = rx_pos;
+	return NFC_STATUS_OK;
+}
+
+static enum nfc_status ats_parse(const u32 size,
+				 struct iso14443_4_ats *const ats)
+{
+	const u8 *const buf = block.rx;
+	const u8 tl = buf[0];
+
+	if (!size || (tl != size))
+		return NFC_STATUS_PROTOCOL;
+
+	u8 fsci = FSCI_DEFAULT;
+	u8 fwi = FWI_DEFAULT;
+	u8 sfgi = SFGI_DEFAULT;
+
+	ats->ta = 0;
+	ats->tb = (FWI_DEFAULT << TB_SHIFT_FWI) | SFGI_DEFAULT;
+	ats->tc = 0;
+
+	u32 pos = 1;
+
+	if (pos < tl) {
+		const u8 t0 = buf[pos++];
+		const u32 end = pos + !!(t0 & T0_TA) + !!(t0 & T0_TB) +
+				!!(t0 & T0_TC);
+
+		if (end > tl)
+			return NFC_STATUS_PROTOCOL;
+
+		fsci = t0 & T0_FSCI;
+
+		if (t0 & T0_TA)
+			ats->ta = buf[pos++];
+
+		if (t0 & T0_TB) {
+			ats->tb = buf[pos++];
+
+			fwi = ats->tb >> TB_SHIFT_FWI;
+			sfgi = ats->tb & TB_MASK_SFGI;
+		}
+
+		if (t0 & T0_TC)
+			ats->tc = buf[pos++];
+	}
+
+	if (fsci > FSCI_MAX)
+		fsci = FSCI_MAX;
+
+	// FWI and SFGI of 15 are reserved, and stand for the default.
+	if (fwi > FWI_MAX)
+		fwi = FWI_DEFAULT;
+
+	if (sfgi > FWI_MAX)
+		sfgi = SFGI_DEFAULT;
+
+	u32 hist_size = tl - pos;
+
+	if (hist_size > ISO14443_4_HIST_SIZE_MAX)
+		hist_size = ISO14443_4_HIST_SIZE_MAX;
+
+	ats->hist_size = hist_size;
+	memcpy(ats->hist, &buf[pos], hist_size);
+
+	ats->fsc = fsc_tbl[fsci];
+	ats->fwt_us = fwt_us(fwi);
+
+	session.frame_size_max =
+		(ats->fsc < ISO14443_4_FSD) ? ats->fsc : ISO14443_4_FSD;
+	session.fwt_us = ats->fwt_us;
+
+	// The card may not be able to receive anything before SFGT.
+	if (sfgi)
+		wait_us(fwt_us(sfgi));
+
+	return NFC_STATUS_OK;
+}
+
+enum nfc_status iso14443_4_rats(struct iso14443_4_ats *const ats)
+{
+	const u8 tx[] = {
+		[0] = CMD_RATS,
+		[1] = RATS_PARAM,
+	};
+
+	session.active = false;
+
+	u32 size;
+	const enum nfc_status status =
+		frame_xfer(tx, sizeof(tx), FWT_ACTIVATION_US, &size);
+
+	if (status != NFC_STATUS_OK)
+		return status;
+
+	const enum nfc_status parse_status = ats_parse(size, ats);
+
+	if (parse_status != NFC_STATUS_OK)
+		return parse_status;
+
+	session.active = true;
+	session.block_num = 0;
+	session.ds = ISO14443_4_DIV_1;
+	session.dr = ISO14443_4_DIV_1;
+
+	return NFC_STATUS_OK;
+}
+
+enum nfc_status iso14443_4_pps(const enum iso14443_4_div ds,
+			       const enum iso14443_4_div dr)
+{
+	app_assert((ds <= ISO14443_4_DIV_8) && (dr <= ISO14443_4_DIV_8));
+
+	if (!session.active)
+		return NFC_STATUS_PROTOCOL;
+
+	const u8 tx[] = {
+		[0] = CMD_PPSS,
+		[1] = PPS0_PPS1,
+		[2] = (ds << 2) | dr,
+	};
+
+	u32 size;
+	enum nfc_status status =
+		frame_xfer(tx, sizeof(tx), session.fwt_us, &size);
+
+	if ((status == NFC_STATUS_OK) &&
+	    ((size != 1) || (block.rx[0] != CMD_PPSS)))
+		status = NFC_STATUS_PROTOCOL;
+
+	if (status != NFC_STATUS_OK) {
+		session.stats.pps_failures++;
+		return status;
+	}
+
+	session.stats.pps++;
+
+	// The card switches as soon as it has sent its response.
+	if (!nfc_protocol_set_split(protocol_tbl[dr], protocol_tbl[ds]))
+		return NFC_STATUS_CMD;
+
+	session.ds = ds;
+	session.dr = dr;
+
+	return NFC_STATUS_OK;
+}
+
+/** The highest divisor set in @p mask, a TA(1) DS or DR field. */
+static enum iso14443_4_div div_highest(const u8 mask)
+{
+	for (u32 div = ISO14443_4_DIV_8; div > ISO14443_4_DIV_1; div--) {
+		if (mask & (1U << (div - 1)))
+			return div;
+	}
+
+	return ISO14443_4_DIV_1;
+}
+
+enum nfc_status iso14443_4_rate_raise(const struct iso14443_4_ats *const ats,
+				      enum iso14443_4_div *const ds,
+				      enum iso14443_4_div *const dr)
+{
+	const u8 ds_mask = (ats->ta >> TA_SHIFT_DS) & TA_MASK_D;
+	const u8 dr_mask = ats->ta & TA_MASK_D;
+
+	if (ats->ta & ISO14443_4_TA_SAME_D) {
+		*ds = div_highest(ds_mask & dr_mask);
+		*dr = *ds;
+	} else {
+		*ds = div_highest(ds_mask);
+		*dr = div_highest(dr_mask);
+	}
+
+	if ((*ds != ISO14443_4_DIV_1) || (*dr != ISO14443_4_DIV_1)) {
+		const enum nfc_status status = iso14443_4_pps(*ds, *dr);
+
+		if (status == NFC_STATUS_CMD)
+			return status;
+
+		// A card which did not answer the PPS stays at 106 kbit/s.
+		if (status != NFC_STATUS_OK) {
+			*ds = ISO14443_4_DIV_1;
+			*dr = ISO14443_4_DIV_1;
+		}
+	}
+
+	session.stats.sessions_ds[*ds]++;
+	return NFC_STATUS_OK;
+}
+
+enum nfc_status iso14443_4_exchange(const u8 *const tx, const u32 tx_size,
+				    u8 *const rx, const u32 rx_size_max,
+				    u32 *const rx_size)
+{
+	*rx_size = 0;
+
+	if (!session.active)
+		return NFC_STATUS_PROTOCOL;
+
+	const u32 start = dwt_cyccnt_read();
+	const enum nfc_status status =
+		exchange(tx, tx_size, rx, rx_size_max, rx_size);
+	const u32 cycles = dwt_cyccnt_read() - start;
+
+	if (status != NFC_STATUS_OK) {
+		session.stats.failures++;
+		return status;
+	}
+
+	session.stats.exchanges++;
+	session.stats.time_last = cycles;
+
+	if (cycles > session.stats.time_max)
+		session.stats.time_max = cycles;
+
+	return status;
+}
+
+enum nfc_status iso14443_4_deselect(void)
+{
+	const u8 tx = PCB_S_DESELECT;
+
+	if (!session.active)
+		return NFC_STATUS_PROTOCOL;
+
+	session.active = false;
+
+	u32 size;
+	const enum nfc_status status =
+		frame_xfer(&tx, sizeof(tx), FWT_ACTIVATION_US, &size);
+
+	if ((session.ds != ISO14443_4_DIV_1) ||
+	    (session.dr != ISO14443_4_DIV_1)) {
+		session.ds = ISO14443_4_DIV_1;
+		session.dr = ISO14443_4_DIV_1;
+
+		if (!nfc_protocol_set(NFC_PROTOCOL_MIFARE_106))
+			return NFC_STATUS_CMD;
+	}
+
+	if (status != NFC_STATUS_OK)
+		return status;
+
+	if ((size != 1) || (block.rx[0] != PCB_S_DESELECT))
+		return NFC_STATUS_PROTOCOL;
+
+	return NFC_STATUS_OK;
+}
+
+void iso14443_4_stats_get(struct iso14443_4_stats *const out)
+{
+	*out = session.stats;
+}
@@ -0,0 +1,158 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "common/types.h"
+#include "common/util.h"
+#include "nfc.h"
+
+enum {
+	/**
+	 * Largest frame the reader accepts, including PCB and CRC, as
+	 * advertised in RATS (FSDI 9): the size of the CLRC663 FIFO.
+	 */
+	ISO14443_4_FSD = 512,
+
+	ISO14443_4_HIST_SIZE_MAX = 15
+};
+
+/** The bit rates a card supports, as encoded in TA(1) of its ATS */
+enum iso14443_4_ta {
+	/** The bit rate must be the same in both directions */
+	ISO14443_4_TA_SAME_D = BIT_7,
+
+	/** Card to reader: 848, 424 and 212 kbit/s */
+	ISO14443_4_TA_DS_8 = BIT_6,
+	ISO14443_4_TA_DS_4 = BIT_5,
+	ISO14443_4_TA_DS_2 = BIT_4,
+
+	/** Reader to card: 848, 424 and 212 kbit/s */
+	ISO14443_4_TA_DR_8 = BIT_2,
+	ISO14443_4_TA_DR_4 = BIT_1,
+	ISO14443_4_TA_DR_2 = BIT_0
+};
+
+/** Divisors of the bit rate, from 106 kbit/s, for PPS */
+enum iso14443_4_div {
+	ISO14443_4_DIV_1,
+	ISO14443_4_DIV_2,
+	ISO14443_4_DIV_4,
+	ISO14443_4_DIV_8,
+	ISO14443_4_DIV_NUM
+};
+
+struct iso14443_4_ats {
+	/** Largest frame the card accepts, including PCB and CRC */
+	u16 fsc;
+
+	/** Frame waiting time, in microseconds */
+	u32 fwt_us;
+
+	u8 ta;
+	u8 tb;
+	u8 tc;
+
+	u8 hist_size;
+	u8 hist[ISO14443_4_HIST_SIZE_MAX];
+};
+
+struct iso14443_4_stats {
+	u32 exchanges;
+	u32 failures;
+
+	u32 blocks_tx;
+	u32 blocks_rx;
+
+	/** Blocks resent, or R(NAK)s sent, to recover from an error */
+	u32 retransmissions;
+
+	/** Waiting time extensions requested by the card */
+	u32 wtx;
+
+	/** INF bytes carried, excluding PCB and CRC */
+	u32 bytes_tx;
+	u32 bytes_rx;
+
+	/** Time of an exchange, in core cycles */
+	u32 time_last;
+	u32 time_max;
+
+	u32 pps;
+	u32 pps_failures;
+
+	/**
+	 * Bit rates from the card to the reader iso14443_4_rate_raise()
+	 * settled on, indexed by divisor
+	 */
+	u32 sessions_ds[ISO14443_4_DIV_NUM];
+};
+
+/**
+ * Sends RATS to the card just selected with iso14443a_activate() and parses
+ * its ATS. The card is then ready for iso14443_4_exchange() at 106 kbit/s.
+ *
+ * The timers of the CLRC663 cut a frame waiting time above 309 ms, which
+ * only cards with FWI 11 and above ask for, down to that.
+ */
+enum nfc_status iso14443_4_rats(struct iso14443_4_ats *ats);
+
+/**
+ * Asks the card to switch to 106 kbit/s times @p ds from it to the reader
+ * and @p dr the other way, and switches the CLRC663 along with it. On failure
+ * both stay at the bit rates they were at.
+ */
+enum nfc_status iso14443_4_pps(enum iso14443_4_div ds,
+			       enum iso14443_4_div dr);
+
+/**
+ * Switches the card in the session, and the reader, to the highest bit rates
+ * they have in common according to @p ats, which are returned in @p ds and
+ * @p dr. If the card does not take the PPS, the session goes on at 106 kbit/s.
+ *
+ * @returns an error only if the CLRC663 failed to load the protocol, after
+ * which the card should be activated anew.
+ */
+enum nfc_status iso14443_4_rate_raise(const struct iso14443_4_ats *ats,
+				      enum iso14443_4_div *ds,
+				      enum iso14443_4_div *dr);
+
+/**
+ * Sends @p tx to the card and receives its response, chaining both across as
+ * many blocks as the frame sizes require, recovering from lost and corrupted
+ * blocks and granting the card the waiting time extensions it asks for.
+ *
+ * @returns NFC_STATUS_OVERFLOW if the response does not fit into
+ * @p rx_size_max bytes, after which the card should be deselected.
+ */
+enum nfc_status iso14443_4_exchange(const u8 *tx, u32 tx_size, u8 *rx,
+				    u32 rx_size_max, u32 *rx_size);
+
+/**
+ * Sends S(DESELECT), moving the card to the HALT state. The CLRC663 is then
+ * back at 106 kbit/s, ready to activate the next card.
+ */
+enum nfc_status iso14443_4_deselect(void);
+
+void iso14443_4_stats_get(struct iso14443_4_stats *stats);
@@ -0,0 +1,419 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <string.h>
+
+#include "common/types.h"
+#include "common/util.h"
+#include "hal/dwt.h"
+
+#include "iso14443a.h"
+#include "nfc.h"
+
+enum {
+	CMD_REQA = 0x26,
+	CMD_WUPA = 0x52,
+	CMD_HLTA = 0x50,
+
+	CASCADE_TAG = 0x88,
+
+	// NVB of a SELECT, which carries the complete UID CLn
+	NVB_SELECT = 0x70,
+
+	// REQA and WUPA are short frames of 7 bits.
+	SHORT_FRAME_BITS = 7,
+
+	// A card answers 1172/fc (86 us) after the end of the command, or
+	// 1236/fc (91 us) if the command ended with a 1. Waiting any longer
+	// only adds to the time it takes to find out that there is no card.
+	FDT_TIMEOUT_US = 150,
+};
+
+static const u8 sel_tbl[ISO14443A_CASCADE_LEVEL_NUM] = {
+	// clang-format off
+
+	[0] = 0x93,
+	[1] = 0x95,
+	[2] = 0x97
+
+	// clang-format on
+};
+
+static struct iso14443a_stats stats;
+
+static bool bcc_valid(const u8 *const uid_cl)
+{
+	return (uid_cl[0] ^ uid_cl[1] ^ uid_cl[2] ^ uid_cl[3]) == uid_cl[4];
+}
+
+/**
+ * Resolves the rest of the UID CLn at the level of @p path, starting from the
+ * bits already known. On a collision, the branch with a 1 at the colliding bit
+ * is followed, and the cards on the other branch drop out; @p branch is told
+ * about the path to them.
+ */
+static enum nfc_status anticollision(struct iso14443a_path *const path,
+				     const iso14443a_branch_cb branch,
+				     void *const ctx)
+{
+	u8 *const uid_cl = path->uid_cl[path->level];
+
+	// Every round learns at least one more bit, so this ends after at most
+	// ISO14443A_UID_CL_BITS rounds.
+	while (path->known_bits < ISO14443A_UID_CL_BITS) {
+		const u32 known_bytes = path->known_bits / 8;
+		const u8 last_bits = path->known_bits % 8;
+		const u32 tx_uid_size = known_bytes + (last_bits ? 1 : 0);
+
+		u8 tx[2 + ISO14443A_UID_CL_SIZE];
+
+		tx[0] = sel_tbl[path->level];
+		tx[1] = ((2 + known_bytes) << 4) | last_bits;
+		memcpy(&tx[2], uid_cl, tx_uid_size);
+
+		u8 rx[ISO14443A_UID_CL_SIZE];
+
+		// The card continues the UID from the first bit not sent, in
+		// the middle of the last byte sent if that was a partial one.
+		const struct nfc_xfer xfer = {
+			// clang-format off
+
+			.tx		= tx,
+			.tx_size	= 2 + tx_uid_size,
+			.tx_last_bits	= last_bits,
+			.rx		= rx,
+			.rx_size_max	= ISO14443A_UID_CL_SIZE - known_bytes,
+			.rx_align	= last_bits,
+			.timeout_us	= FDT_TIMEOUT_US
+
+			// clang-format on
+		};
+
+		struct nfc_xfer_result result;
+		const enum nfc_status status = nfc_transceive(&xfer, &result);
+
+		if ((status != NFC_STATUS_OK) &&
+		    (status != NFC_STATUS_COLLISION))
+			return status;
+
+		if (!result.rx_size)
+			return NFC_STATUS_PROTOCOL;
+
+		const u8 keep = (1U << last_bits) - 1;
+
+		uid_cl[known_bytes] = (uid_cl[known_bytes] & keep) |
+				      (rx[0] & ~keep);
+
+		memcpy(&uid_cl[known_bytes + 1], &rx[1], result.rx_size - 1);
+
+		if (status == NFC_STATUS_OK) {
+			if (((known_bytes + result.rx_size) !=
+			     ISO14443A_UID_CL_SIZE) ||
+			    result.rx_last_bits)
+				return NFC_STATUS_PROTOCOL;
+
+			path->known_bits = ISO14443A_UID_CL_BITS;
+			break;
+		}
+
+		if (!result.coll_pos_valid)
+			return NFC_STATUS_COLLISION;
+
+		const u32 coll_bit = (known_bytes * 8) + result.coll_pos;
+
+		if ((coll_bit < path->known_bits) ||
+		    (coll_bit >= ISO14443A_UID_CL_BITS))
+			return NFC_STATUS_PROTOCOL;
+
+		const u32 byte = coll_bit / 8;
+		const u8 bit = coll_bit % 8;
+
+		uid_cl[byte] &= (1U << bit) - 1;
+		memset(&uid_cl[byte + 1], 0, ISO14443A_UID_CL_SIZE - byte - 1);
+		path->known_bits = coll_bit + 1;
+
+		if (branch)
+			branch(ctx, path);
+
+		uid_cl[byte] |= 1U << bit;
+		stats.collisions++;
+	}
+
+	return bcc_valid(uid_cl) ? NFC_STATUS_OK : NFC_STATUS_INTEGRITY;
+}
+
+static enum nfc_status select(const u32 level, const u8 *const uid_cl,
+			      u8 *const sak)
+{
+	u8 tx[2 + ISO14443A_UID_CL_SIZE];
+
+	tx[0] = sel_tbl[level];
+	tx[1] = NVB_SELECT;
+	memcpy(&tx[2], uid_cl, ISO14443A_UID_CL_SIZE);
+
+	const struct nfc_xfer xfer = {
+		// clang-format off
+
+		.tx		= tx,
+		.tx_size	= sizeof(tx),
+		.flags		= NFC_XFER_TX_CRC | NFC_XFER_RX_CRC,
+		.rx		= sak,
+		.rx_size_max	= 1,
+		.timeout_us	= FDT_TIMEOUT_US
+
+		// clang-format on
+	};
+
+	struct nfc_xfer_result result;
+	const enum nfc_status status = nfc_transceive(&xfer, &result);
+
+	if (status != NFC_STATUS_OK)
+		return status;
+
+	if ((result.rx_size != 1) || result.rx_last_bits)
+		return NFC_STATUS_PROTOCOL;
+
+	return NFC_STATUS_OK;
+}
+
+enum nfc_status iso14443a_request(const enum iso14443a_req req,
+				  u8 *const atqa)
+{
+	const u8 cmd = (req == ISO14443A_REQ_WUPA) ? CMD_WUPA : CMD_REQA;
+
+	// A MIFARE Classic session left running would encrypt the request.
+	nfc_crypto1_disable();
+
+	const struct nfc_xfer xfer = {
+		// clang-format off
+
+		.tx		= &cmd,
+		.tx_size	= sizeof(cmd),
+		.tx_last_bits	= SHORT_FRAME_BITS,
+		.rx		= atqa,
+		.rx_size_max	= ISO14443A_ATQA_SIZE,
+		.timeout_us	= FDT_TIMEOUT_US
+
+		// clang-format on
+	};
+
+	struct nfc_xfer_result result;
+	const enum nfc_status status = nfc_transceive(&xfer, &result);
+
+	// Several cards answering at once collide in their ATQA, which still
+	// tells that there is at least one card; anticollision sorts them out.
+	if ((status != NFC_STATUS_OK) && (status != NFC_STATUS_COLLISION))
+		return status;
+
+	if ((result.rx_size != ISO14443A_ATQA_SIZE) || result.rx_last_bits)
+		return NFC_STATUS_PROTOCOL;
+
+	return NFC_STATUS_OK;
+}
+
+enum nfc_status iso14443a_select_path(struct iso14443a_path *const path,
+				      const iso14443a_branch_cb branch,
+				      void *const ctx,
+				      struct iso14443a_card *const card)
+{
+	enum nfc_status status;
+
+	// Cards off the path drop out as the levels already known are
+	// selected again.
+	for (u32 level = 0; level < path->level; ++level) {
+		status = select(level, path->uid_cl[level], &card->sak);
+
+		if (status != NFC_STATUS_OK)
+			return status;
+
+		if (!(card->sak & ISO14443A_SAK_CASCADE))
+			return NFC_STATUS_PROTOCOL;
+	}
+
+	for (;;) {
+		status = anticollision(path, branch, ctx);
+
+		if (status != NFC_STATUS_OK)
+			return status;
+
+		status = select(path->level, path->uid_cl[path->level],
+				&card->sak);
+
+		if (status != NFC_STATUS_OK)
+			return status;
+
+		if (!(card->sak & ISO14443A_SAK_CASCADE))
+			break;
+
+		// The UID continues at the next level, and this one only
+		// carries its first three bytes, behind the cascade tag.
+		if ((path->uid_cl[path->level][0] != CASCADE_TAG) ||
+		    (path->level + 1 == ISO14443A_CASCADE_LEVEL_NUM))
+			return NFC_STATUS_PROTOCOL;
+
+		path->level++;
+		path->known_bits = 0;
+		memset(path->uid_cl[path->level], 0, ISO14443A_UID_CL_SIZE);
+	}
+
+	card->uid_size = 0;
+
+	for (u32 level = 0; level < path->level; ++level) {
+		memcpy(&card->uid[card->uid_size], &path->uid_cl[level][1], 3);
+		card->uid_size += 3;
+	}
+
+	memcpy(&card->uid[card->uid_size], path->uid_cl[path->level], 4);
+	card->uid_size += 4;
+
+	return NFC_STATUS_OK;
+}
+
+static void path_from_uid(const struct iso14443a_card *const card,
+			  struct iso14443a_path *const path)
+{
+	const u8 *uid = card->uid;
+	u32 left = card->uid_size;
+
+	path->level = 0;
+
+	// Every level but the last carries the cascade tag and three bytes.
+	while (left > 4) {
+		u8 *const uid_cl = path->uid_cl[path->level++];
+
+		uid_cl[0] = CASCADE_TAG;
+		memcpy(&uid_cl[1], uid, 3);
+
+		uid += 3;
+		left -= 3;
+	}
+
+	u8 *const uid_cl = path->uid_cl[path->level];
+
+	memcpy(uid_cl, uid, 4);
+
+	for (u32 level = 0; level <= path->level; ++level) {
+		u8 *const cl = path->uid_cl[level];
+		cl[4] = cl[0] ^ cl[1] ^ cl[2] ^ cl[3];
+	}
+
+	path->known_bits = ISO14443A_UID_CL_BITS;
+}
+
+enum nfc_status iso14443a_reselect(const enum iso14443a_req req,
+				   struct iso14443a_card *const card)
+{
+	app_assert((card->uid_size == 4) || (card->uid_size == 7) ||
+		   (card->uid_size == 10));
+
+	enum nfc_status status = iso14443a_request(req, card->atqa);
+
+	if (status != NFC_STATUS_OK)
+		return status;
+
+	struct iso14443a_path path;
+	path_from_uid(card, &path);
+
+	// Walking a fully known path does not run any anticollision, only
+	// one SELECT per cascade level.
+	return iso14443a_select_path(&path, NULL, NULL, card);
+}
+
+static enum nfc_status activate(const enum iso14443a_req req,
+				struct iso14443a_card *const card)
+{
+	const enum nfc_status status = iso14443a_request(req, card->atqa);
+
+	if (status != NFC_STATUS_OK)
+		return status;
+
+	struct iso14443a_path path = {
+		// clang-format off
+
+		.level		= 0,
+		.known_bits	= 0
+
+		// clang-format on
+	};
+
+	return iso14443a_select_path(&path, NULL, NULL, card);
+}
+
+enum nfc_status iso14443a_activate(const enum iso14443a_req req,
+				   struct iso14443a_card *const card)
+{
+	const u32 start = dwt_cyccnt_read();
+	const enum nfc_status status = activate(req, card);
+	const u32 cycles = dwt_cyccnt_read() - start;
+
+	if (status == NFC_STATUS_TIMEOUT)
+		return status;
+
+	if (status != NFC_STATUS_OK) {
+		stats.failures++;
+		return status;
+	}
+
+	stats.activations++;
+	stats.time_last = cycles;
+
+	if (cycles > stats.time_max)
+		stats.time_max = cycles;
+
+	return status;
+}
+
+enum nfc_status iso14443a_halt(void)
+{
+	const u8 tx[] = {
+		[0] = CMD_HLTA,
+		[1] = 0x00,
+	};
+
+	u8 rx;
+
+	const struct nfc_xfer xfer = {
+		// clang-format off
+
+		.tx		= tx,
+		.tx_size	= sizeof(tx),
+		.flags		= NFC_XFER_TX_CRC,
+		.rx		= &rx,
+		.rx_size_max	= sizeof(rx),
+		.timeout_us	= FDT_TIMEOUT_US
+
+		// clang-format on
+	};
+
+	struct nfc_xfer_result result;
+	const enum nfc_status status = nfc_transceive(&xfer, &result);
+
+	if (status == NFC_STATUS_TIMEOUT)
+		return NFC_STATUS_OK;
+
+	return (status == NFC_STATUS_OK) ? NFC_STATUS_PROTOCOL : status;
+}
+
+void iso14443a_stats_get(struct iso14443a_stats *const out)
+{
+	*out = stats;
+}
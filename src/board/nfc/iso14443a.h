@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "common/types.h"
+#include "nfc.h"
+
+enum {
+	ISO14443A_ATQA_SIZE = 2,
+	ISO14443A_UID_SIZE_MAX = 10,
+	ISO14443A_CASCADE_LEVEL_NUM = 3,
+
+	/** The UID bytes of one cascade level and their BCC */
+	ISO14443A_UID_CL_SIZE = 5,
+	ISO14443A_UID_CL_BITS = ISO14443A_UID_CL_SIZE * 8
+};
+
+enum iso14443a_req {
+	/** Wakes only cards in the IDLE state */
+	ISO14443A_REQ_REQA,
+
+	/** Also wakes cards which have been halted */
+	ISO14443A_REQ_WUPA
+};
+
+enum iso14443a_sak {
+	/** The UID is not complete; another cascade level follows */
+	ISO14443A_SAK_CASCADE = BIT_2,
+
+	/** The card supports ISO/IEC 14443-4 */
+	ISO14443A_SAK_ISO14443_4 = BIT_5
+};
+
+/** A card which has been selected */
+struct iso14443a_card {
+	u8 atqa[ISO14443A_ATQA_SIZE];
+	u8 sak;
+	u8 uid_size;
+	u8 uid[ISO14443A_UID_SIZE_MAX];
+};
+
+/**
+ * A node in the anticollision tree: the complete UID CLn of every cascade
+ * level before @ref level, and the first @ref known_bits bits of the one at
+ * @ref level.
+ */
+struct iso14443a_path {
+	u8 level;
+	u8 known_bits;
+	u8 uid_cl[ISO14443A_CASCADE_LEVEL_NUM][ISO14443A_UID_CL_SIZE];
+};
+
+/**
+ * Called for every collision during anticollision, with the path to the
+ * cards which are about to drop out of it.
+ */
+typedef void (*iso14443a_branch_cb)(void *ctx,
+				    const struct iso14443a_path *branch);
+
+struct iso14443a_stats {
+	u32 activations;
+	u32 failures;
+
+	/** Collisions resolved during anticollision */
+	u32 collisions;
+
+	/** Time from the request to the SAK, in core cycles */
+	u32 time_last;
+	u32 time_max;
+};
+
+/**
+ * Sends REQA or WUPA, moving the cards which answer to the READY state.
+ *
+ * @returns NFC_STATUS_TIMEOUT if no card answered. A collision of the ATQA
+ * is not an error, as it only means that several cards did.
+ */
+enum nfc_status iso14443a_request(enum iso14443a_req req, u8 *atqa);
+
+/**
+ * Selects a card at or below @p path in the anticollision tree, which is
+ * extended to the selected card. Cards must have been moved to the READY
+ * state with iso14443a_request() just before. @p branch may be NULL.
+ *
+ * Only the card's UID and SAK are filled in.
+ */
+enum nfc_status iso14443a_select_path(struct iso14443a_path *path,
+				      iso14443a_branch_cb branch, void *ctx,
+				      struct iso14443a_card *card);
+
+/**
+ * Selects the card with the UID in @p card directly, without anticollision:
+ * sends @p req, then one SELECT per cascade level. Refreshes the ATQA and SAK.
+ *
+ * @returns NFC_STATUS_TIMEOUT if the card is gone.
+ */
+enum nfc_status iso14443a_reselect(enum iso14443a_req req,
+				   struct iso14443a_card *card);
+
+/**
+ * Activates one card in the field: sends @p req, resolves collisions down to
+ * a single card through the cascade levels and selects it. The card is left
+ * in the ACTIVE state.
+ *
+ * The 14443A-106 protocol must be loaded and the field on.
+ *
+ * @returns NFC_STATUS_TIMEOUT if no card answered.
+ */
+enum nfc_status iso14443a_activate(enum iso14443a_req req,
+				   struct iso14443a_card *card);
+
+/**
+ * Sends HLTA to the selected card, which then only answers WUPA.
+ *
+ * @returns NFC_STATUS_OK if the card did not answer, as the standard
+ * requires; any answer is a NAK. A card answers within the usual frame delay,
+ * so that is all this waits rather than the 1 ms the standard allows.
+ */
+enum nfc_status iso14443a_halt(void);
+
+void iso14443a_stats_get(struct iso14443a_stats *stats);
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "drivers/clrc663/clrc663-lpcd.h"
+
+#include "lpcd.h"
+
+enum {
+	CAL_SAMPLE_NUM = 8,
+
+	// Margin on top of the noise seen during calibration, so that an
+	// empty field does not trigger once in a while.
+	CAL_MARGIN_MIN = 2,
+
+	IQ_MAX = 63
+};
+
+static u8 clamp_sub(const u8 val, const u8 delta)
+{
+	return (val > delta) ? (val - delta) : 0;
+}
+
+static u8 clamp_add(const u8 val, const u8 delta)
+{
+	return ((val + delta) < IQ_MAX) ? (val + delta) : IQ_MAX;
+}
+
+bool nfc_lpcd_calibrate(struct nfc_lpcd_cal *const cal)
+{
+	u32 i_sum = 0;
+	u32 q_sum = 0;
+
+	struct drv_clrc663_lpcd_iq min = { .i = IQ_MAX, .q = IQ_MAX };
+	struct drv_clrc663_lpcd_iq max = { .i = 0, .q = 0 };
+
+	for (u32 n = 0; n < CAL_SAMPLE_NUM; ++n) {
+		struct drv_clrc663_lpcd_iq iq;
+
+		if (!drv_clrc663_lpcd_measure(&iq))
+			return false;
+
+		i_sum += iq.i;
+		q_sum += iq.q;
+
+		if (iq.i < min.i)
+			min.i = iq.i;
+
+		if (iq.q < min.q)
+			min.q = iq.q;
+
+		if (iq.i > max.i)
+			max.i = iq.i;
+
+		if (iq.q > max.q)
+			max.q = iq.q;
+	}
+
+	const u8 spread_i = max.i - min.i;
+	const u8 spread_q = max.q - min.q;
+
+	cal->i = (i_sum + (CAL_SAMPLE_NUM / 2)) / CAL_SAMPLE_NUM;
+	cal->q = (q_sum + (CAL_SAMPLE_NUM / 2)) / CAL_SAMPLE_NUM;
+	cal->margin = CAL_MARGIN_MIN +
+		      ((spread_i > spread_q) ? spread_i : spread_q);
+
+	return true;
+}
+
+void nfc_lpcd_arm(const struct nfc_lpcd_cal *const cal, const u32 period_ms)
+{
+	const struct drv_clrc663_lpcd_window window = {
+		.min = {
+			.i = clamp_sub(cal->i, cal->margin),
+			.q = clamp_sub(cal->q, cal->margin)
+		},
+		.max = {
+			.i = clamp_add(cal->i, cal->margin),
+			.q = clamp_add(cal->q, cal->margin)
+		}
+	};
+
+	drv_clrc663_lpcd_start(&window, period_ms);
+}
+
+bool nfc_lpcd_triggered(void)
+{
+	return drv_clrc663_lpcd_triggered();
+}
+
+void nfc_lpcd_disarm(void)
+{
+	drv_clrc663_lpcd_stop();
+}
@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "common/types.h"
+
+/** The empty-field reference LPCD measurements are compared against */
+struct nfc_lpcd_cal {
+	u8 i;
+	u8 q;
+
+	/** How far a measurement may stray from i and q without triggering */
+	u8 margin;
+};
+
+/**
+ * Measures the empty field several times, and derives the reference and the
+ * margin from the average and the spread of the results. The field must be
+ * free of cards.
+ *
+ * @returns false if a measurement failed.
+ */
+bool nfc_lpcd_calibrate(struct nfc_lpcd_cal *cal);
+
+/**
+ * Hands the field over to the CLRC663, which then measures the antenna load
+ * every @p period_ms on its own and sleeps in between.
+ */
+void nfc_lpcd_arm(const struct nfc_lpcd_cal *cal, u32 period_ms);
+
+/** Whether a card has possibly entered the field since nfc_lpcd_arm(). */
+bool nfc_lpcd_triggered(void);
+
+/** Ends LPCD, so that the CLRC663 can be used again. */
+void nfc_lpcd_disarm(void);
@@ -0,0 +1,485 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <string.h>
+
+#include "common/types.h"
+#include "common/util.h"
+#include "hal/dwt.h"
+
+#include "iso14443a.h"
+#include "mifare-classic.h"
+#include "nfc.h"
+
+enum {
+	CMD_AUTH_A = 0x60,
+	CMD_AUTH_B = 0x61,
+	CMD_READ = 0x30,
+	CMD_WRITE = 0xA0,
+
+	// The card acknowledges with 4 bits.
+	ACK = 0x0A,
+	ACK_MASK = 0x0F,
+	ACK_BITS = 4,
+
+	// Sectors 0 to 31 have 4 blocks, the rest of a 4K 16.
+	SMALL_SECTOR_NUM = 32,
+	SMALL_SECTOR_BLOCK_NUM = 4,
+	LARGE_SECTOR_BLOCK_NUM = 16,
+
+	// Generous bounds for the card's answers, which only matter when it
+	// does not answer at all. A write is acknowledged once the block is
+	// programmed.
+	AUTH_TIMEOUT_US = 2000,
+	READ_TIMEOUT_US = 2000,
+	WRITE_TIMEOUT_US = 10000
+};
+
+static struct {
+	u8 keys[MIFARE_CLASSIC_KEY_RAM_NUM][MIFARE_CLASSIC_KEY_SIZE];
+
+	/** The slot whose key is in the CLRC663's key buffer */
+	u8 key_loaded;
+	bool key_loaded_valid;
+
+	/** The card of the session, and whether it is still selected */
+	u8 uid[ISO14443A_UID_SIZE_MAX];
+	u8 uid_size;
+	bool selected;
+
+	/** The sector open for reading and writing, and the key it took */
+	bool authed;
+	u8 auth_sector;
+	struct mifare_classic_key_ref auth_key;
+
+	u8 sector_buf[MIFARE_CLASSIC_SECTOR_SIZE_MAX];
+
+	struct mifare_classic_stats stats;
+} mfc;
+
+static u32 sector_block_num(const u8 sector)
+{
+	return (sector < SMALL_SECTOR_NUM) ? SMALL_SECTOR_BLOCK_NUM :
+					     LARGE_SECTOR_BLOCK_NUM;
+}
+
+static u8 sector_first_block(const u8 sector)
+{
+	if (sector < SMALL_SECTOR_NUM)
+		return sector * SMALL_SECTOR_BLOCK_NUM;
+
+	return (SMALL_SECTOR_NUM * SMALL_SECTOR_BLOCK_NUM) +
+	       ((sector - SMALL_SECTOR_NUM) * LARGE_SECTOR_BLOCK_NUM);
+}
+
+u32 mifare_classic_sector_size(const u8 sector)
+{
+	return sector_block_num(sector) * MIFARE_CLASSIC_BLOCK_SIZE;
+}
+
+bool mifare_classic_key_valid(const struct mifare_classic_key_ref *const ref)
+{
+	if (ref->type > MIFARE_CLASSIC_KEY_B)
+		return false;
+
+	if (ref->slot & MIFARE_CLASSIC_KEY_E2)
+		return true;
+
+	return ref->slot < MIFARE_CLASSIC_KEY_RAM_NUM;
+}
+
+bool mifare_classic_key_set(const u8 slot, const u8 *const key)
+{
+	if (slot == mfc.key_loaded)
+		mfc.key_loaded_valid = false;
+
+	if (slot & MIFARE_CLASSIC_KEY_E2)
+		return nfc_key_store_e2(slot & ~MIFARE_CLASSIC_KEY_E2, key);
+
+	if (slot >= MIFARE_CLASSIC_KEY_RAM_NUM)
+		return false;
+
+	memcpy(mfc.keys[slot], key, MIFARE_CLASSIC_KEY_SIZE);
+	return true;
+}
+
+static bool key_load(const u8 slot)
+{
+	if (mfc.key_loaded_valid && (mfc.key_loaded == slot))
+		return true;
+
+	const bool loaded =
+		(slot & MIFARE_CLASSIC_KEY_E2) ?
+			nfc_key_load_e2(slot & ~MIFARE_CLASSIC_KEY_E2) :
+			nfc_key_load(mfc.keys[slot]);
+
+	mfc.key_loaded = slot;
+	mfc.key_loaded_valid = loaded;
+
+	return loaded;
+}
+
+/**
+ * Forgets the session after an error, which leaves the card halted, or at
+ * least out of step with Crypto1.
+ */
+static void session_drop(void)
+{
+	nfc_crypto1_disable();
+
+	mfc.selected = false;
+	mfc.authed = false;
+}
+
+/** Starts a new session if @p card is not the card of the current one. */
+static void session_for(const struct iso14443a_card *const card)
+{
+	if ((card->uid_size == mfc.uid_size) &&
+	    !memcmp(card->uid, mfc.uid, card->uid_size))
+		return;
+
+	memcpy(mfc.uid, card->uid, card->uid_size);
+	mfc.uid_size = card->uid_size;
+
+	// The card has just been activated.
+	mfc.selected = true;
+	mfc.authed = false;
+}
+
+void mifare_classic_session_reset(const bool selected)
+{
+	mfc.selected = selected;
+	mfc.authed = false;
+}
+
+/** Selects the card again if a failed authentication has halted it. */
+static enum nfc_status reselect(const struct iso14443a_card *const card)
+{
+	if (mfc.selected)
+		return NFC_STATUS_OK;
+
+	struct iso14443a_card reselected = *card;
+
+	mfc.stats.reselects++;
+
+	const enum nfc_status status =
+		iso14443a_reselect(ISO14443A_REQ_WUPA, &reselected);
+
+	if (status != NFC_STATUS_OK)
+		return status;
+
+	mfc.selected = true;
+	return NFC_STATUS_OK;
+}
+
+/** Authenticates to @p sector with the key in the key buffer. */
+static enum nfc_status authent(const struct iso14443a_card *const card,
+			       const u8 sector, const u8 type)
+{
+	// Cards with a 7 byte UID authenticate with its last 4 bytes.
+	const u8 *const uid = &card->uid[card->uid_size - 4];
+	const u8 cmd = (type == MIFARE_CLASSIC_KEY_B) ? CMD_AUTH_B : CMD_AUTH_A;
+
+	const enum nfc_status status = nfc_mifare_authent(
+		cmd, sector_first_block(sector), uid, AUTH_TIMEOUT_US);
+
+	if (status != NFC_STATUS_OK) {
+		mfc.stats.auth_failures++;
+		session_drop();
+
+		return (status == NFC_STATUS_TIMEOUT) ? NFC_STATUS_AUTH :
+							status;
+	}
+
+	mfc.stats.auths++;
+	return NFC_STATUS_OK;
+}
+
+static enum nfc_status auth(const struct iso14443a_card *const card,
+			    const u8 sector,
+			    const struct mifare_classic_key_ref *const key)
+{
+	session_for(card);
+
+	if (mfc.authed && (mfc.auth_sector == sector) &&
+	    (mfc.auth_key.type == key->type) &&
+	    (mfc.auth_key.slot == key->slot)) {
+		mfc.stats.auths_saved++;
+		return NFC_STATUS_OK;
+	}
+
+	enum nfc_status status = reselect(card);
+
+	if (status != NFC_STATUS_OK)
+		return status;
+
+	if (!key_load(key->slot))
+		return NFC_STATUS_CMD;
+
+	status = authent(card, sector, key->type);
+
+	if (status != NFC_STATUS_OK)
+		return status;
+
+	mfc.authed = true;
+	mfc.auth_sector = sector;
+	mfc.auth_key = *key;
+
+	return NFC_STATUS_OK;
+}
+
+enum nfc_status mifare_classic_key_try(const struct iso14443a_card *const card,
+				       const u8 sector, const u8 type,
+				       const u8 *const key)
+{
+	app_assert(sector < MIFARE_CLASSIC_SECTOR_NUM_MAX);
+
+	session_for(card);
+
+	const enum nfc_status status = reselect(card);
+
+	if (status != NFC_STATUS_OK)
+		return status;
+
+	// The key buffer no longer holds any slot's key.
+	mfc.key_loaded_valid = false;
+	mfc.authed = false;
+
+	if (!nfc_key_load(key))
+		return NFC_STATUS_CMD;
+
+	return authent(card, sector, type);
+}
+
+static bool is_ack(const struct nfc_xfer_result *const result, const u8 rx)
+{
+	return (result->rx_size == 1) && (result->rx_last_bits == ACK_BITS) &&
+	       ((rx & ACK_MASK) == ACK);
+}
+
+static enum nfc_status block_read(const u8 block, u8 *const data)
+{
+	const u8 tx[] = {
+		[0] = CMD_READ,
+		[1] = block,
+	};
+
+	const struct nfc_xfer xfer = {
+		// clang-format off
+
+		.tx		= tx,
+		.tx_size	= sizeof(tx),
+		.flags		= NFC_XFER_TX_CRC | NFC_XFER_RX_CRC,
+		.rx		= data,
+		.rx_size_max	= MIFARE_CLASSIC_BLOCK_SIZE,
+		.timeout_us	= READ_TIMEOUT_US
+
+		// clang-format on
+	};
+
+	struct nfc_xfer_result result;
+	const enum nfc_status status = nfc_transceive(&xfer, &result);
+
+	// A NAK is too short for a CRC, but tells more than its error.
+	if ((result.rx_size == 1) && (result.rx_last_bits == ACK_BITS))
+		return NFC_STATUS_NAK;
+
+	if (status != NFC_STATUS_OK)
+		return status;
+
+	if (result.rx_size != MIFARE_CLASSIC_BLOCK_SIZE)
+		return NFC_STATUS_PROTOCOL;
+
+	mfc.stats.blocks_read++;
+	return NFC_STATUS_OK;
+}
+
+/** Sends one part of a write, which the card acknowledges. */
+static enum nfc_status write_part(const u8 *const tx, const u32 tx_size)
+{
+	u8 rx;
+
+	const struct nfc_xfer xfer = {
+		// clang-format off
+
+		.tx		= tx,
+		.tx_size	= tx_size,
+		.flags		= NFC_XFER_TX_CRC,
+		.rx		= &rx,
+		.rx_size_max	= sizeof(rx),
+		.timeout_us	= WRITE_TIMEOUT_US
+
+		// clang-format on
+	};
+
+	struct nfc_xfer_result result;
+	const enum nfc_status status = nfc_transceive(&xfer, &result);
+
+	if (status != NFC_STATUS_OK)
+		return status;
+
+	return is_ack(&result, rx) ? NFC_STATUS_OK : NFC_STATUS_NAK;
+}
+
+static enum nfc_status block_write(const u8 block, const u8 *const data)
+{
+	const u8 tx[] = {
+		[0] = CMD_WRITE,
+		[1] = block,
+	};
+
+	enum nfc_status status = write_part(tx, sizeof(tx));
+
+	if (status == NFC_STATUS_OK)
+		status = write_part(data, MIFARE_CLASSIC_BLOCK_SIZE);
+
+	if (status == NFC_STATUS_OK)
+		mfc.stats.blocks_written++;
+
+	return status;
+}
+
+enum nfc_status
+mifare_classic_sector_read(const struct iso14443a_card *const card,
+			   const u8 sector,
+			   const struct mifare_classic_key_ref *const key,
+			   u8 *const data)
+{
+	app_assert(sector < MIFARE_CLASSIC_SECTOR_NUM_MAX);
+
+	enum nfc_status status = auth(card, sector, key);
+
+	if (status != NFC_STATUS_OK)
+		return status;
+
+	const u8 first = sector_first_block(sector);
+	const u32 block_num = sector_block_num(sector);
+
+	for (u32 i = 0; i < block_num; i++) {
+		status = block_read(first + i,
+				    &data[i * MIFARE_CLASSIC_BLOCK_SIZE]);
+
+		if (status != NFC_STATUS_OK) {
+			session_drop();
+			return status;
+		}
+	}
+
+	return NFC_STATUS_OK;
+}
+
+enum nfc_status
+mifare_classic_sector_write(const struct iso14443a_card *const card,
+			    const u8 sector,
+			    const struct mifare_classic_key_ref *const key,
+			    const u8 *const data)
+{
+	app_assert(sector < MIFARE_CLASSIC_SECTOR_NUM_MAX);
+
+	enum nfc_status status = auth(card, sector, key);
+
+	if (status != NFC_STATUS_OK)
+		return status;
+
+	const u8 first = sector_first_block(sector);
+	const u32 block_num = sector_block_num(sector) - 1;
+
+	for (u32 i = (sector == 0) ? 1 : 0; i < block_num; i++) {
+		status = block_write(first + i,
+				     &data[i * MIFARE_CLASSIC_BLOCK_SIZE]);
+
+		if (status != NFC_STATUS_OK) {
+			session_drop();
+			return status;
+		}
+	}
+
+	return NFC_STATUS_OK;
+}
+
+/** Reads @p sector with the first of @p keys the card takes, from @p start. */
+static enum nfc_status
+sector_read_any(const struct iso14443a_card *const card, const u8 sector,
+		const struct mifare_classic_key_ref *const keys,
+		const u32 key_num, const u32 start, u32 *const key_index)
+{
+	enum nfc_status status = NFC_STATUS_AUTH;
+
+	for (u32 i = 0; i < key_num; i++) {
+		*key_index = (start + i) % key_num;
+
+		status = mifare_classic_sector_read(
+			card, sector, &keys[*key_index], mfc.sector_buf);
+
+		if (status != NFC_STATUS_AUTH)
+			break;
+	}
+
+	return status;
+}
+
+enum nfc_status mifare_classic_dump(
+	const struct iso14443a_card *const card, const u8 first,
+	const u8 sector_num, const struct mifare_classic_key_ref *const keys,
+	const u32 key_num, const mifare_classic_sector_cb cb, void *const ctx)
+{
+	app_assert((first + sector_num) <= MIFARE_CLASSIC_SECTOR_NUM_MAX);
+	app_assert(key_num);
+
+	const u32 start = dwt_cyccnt_read();
+
+	enum nfc_status status = NFC_STATUS_OK;
+	u32 key_last = 0;
+
+	for (u32 sector = first; sector < (first + sector_num); sector++) {
+		u32 key_index;
+
+		status = sector_read_any(card, sector, keys, key_num, key_last,
+					 &key_index);
+
+		if (status == NFC_STATUS_OK)
+			key_last = key_index;
+
+		if (!cb(ctx, sector, status, key_index, mfc.sector_buf,
+			mifare_classic_sector_size(sector)))
+			break;
+
+		// The card is gone, or the CLRC663 failed.
+		if ((status != NFC_STATUS_OK) && (status != NFC_STATUS_AUTH) &&
+		    (status != NFC_STATUS_NAK))
+			break;
+	}
+
+	const u32 cycles = dwt_cyccnt_read() - start;
+
+	mfc.stats.dump_time_last = cycles;
+
+	if (cycles > mfc.stats.dump_time_max)
+		mfc.stats.dump_time_max = cycles;
+
+	return status;
+}
+
+void mifare_classic_stats_get(struct mifare_classic_stats *const out)
+{
+	*out = mfc.stats;
+}
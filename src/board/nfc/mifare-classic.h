@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "common/types.h"
+#include "common/util.h"
+#include "iso14443a.h"
+#include "nfc.h"
+
+enum {
+	MIFARE_CLASSIC_KEY_SIZE = 6,
+	MIFARE_CLASSIC_BLOCK_SIZE = 16,
+
+	/** Sectors of a MIFARE Classic 4K; the 1K has the first 16 */
+	MIFARE_CLASSIC_SECTOR_NUM_MAX = 40,
+	MIFARE_CLASSIC_SECTOR_SIZE_MAX = 16 * MIFARE_CLASSIC_BLOCK_SIZE,
+
+	/** Key slots held in RAM, numbered from 0 */
+	MIFARE_CLASSIC_KEY_RAM_NUM = 32,
+
+	/** Marks a key slot as one of the 128 in the CLRC663's EEPROM */
+	MIFARE_CLASSIC_KEY_E2 = BIT_7
+};
+
+enum mifare_classic_key_type {
+	MIFARE_CLASSIC_KEY_A,
+	MIFARE_CLASSIC_KEY_B
+};
+
+/** A key in the key slot table */
+struct mifare_classic_key_ref {
+	u8 type;
+	u8 slot;
+};
+
+/**
+ * Called for every sector of a dump with its outcome, the index of the key
+ * which opened it and its @p size bytes, trailer included; @p data is only
+ * valid if @p status is NFC_STATUS_OK.
+ *
+ * @returns false to end the dump, e.g. once there is no room for the next
+ * sector.
+ */
+typedef bool (*mifare_classic_sector_cb)(void *ctx, u8 sector,
+					 enum nfc_status status, u8 key_index,
+					 const u8 *data, u32 size);
+
+struct mifare_classic_stats {
+	u32 auths;
+	u32 auth_failures;
+
+	/** Authentications skipped, as the sector was open already */
+	u32 auths_saved;
+
+	/** Reselections of a card halted by a failed authentication */
+	u32 reselects;
+
+	u32 blocks_read;
+	u32 blocks_written;
+
+	/** Time of a whole dump, in core cycles */
+	u32 dump_time_last;
+	u32 dump_time_max;
+};
+
+/**
+ * Puts @p key into @p slot, a RAM slot or one of the EEPROM marked with
+ * MIFARE_CLASSIC_KEY_E2. EEPROM keys survive a power cycle, and never cross
+ * the SPI bus again.
+ */
+bool mifare_classic_key_set(u8 slot, const u8 *key);
+
+/** Whether @p ref names a key type and slot which exist */
+bool mifare_classic_key_valid(const struct mifare_classic_key_ref *ref);
+
+/**
+ * Authenticates to @p sector with key A or B given in full, rather than from
+ * a key slot, for trying out candidate keys. A rejected key halts the card,
+ * which the next attempt selects again.
+ *
+ * @returns NFC_STATUS_AUTH if the card rejected the key.
+ */
+enum nfc_status mifare_classic_key_try(const struct iso14443a_card *card,
+				       u8 sector, u8 type, const u8 *key);
+
+/** Size of @p sector in bytes, trailer included */
+u32 mifare_classic_sector_size(u8 sector);
+
+/**
+ * Reads all blocks of @p sector from @p card, which must have been activated
+ * last, into @p data. The sector is only authenticated to if it is not open
+ * with the same key already; a card halted by a failed authentication is
+ * selected again first.
+ *
+ * @returns NFC_STATUS_AUTH if the card rejected the key.
+ */
+enum nfc_status mifare_classic_sector_read(
+	const struct iso14443a_card *card, u8 sector,
+	const struct mifare_classic_key_ref *key, u8 *data);
+
+/**
+ * Writes the data blocks of @p sector, all but the trailer, from @p data.
+ * Block 0 of sector 0 holds the UID and is skipped.
+ */
+enum nfc_status mifare_classic_sector_write(
+	const struct iso14443a_card *card, u8 sector,
+	const struct mifare_classic_key_ref *key, const u8 *data);
+
+/**
+ * Reads @p sector_num sectors from @p first on, trying @p keys on each. The
+ * key which opened the previous sector is tried first, as cards tend to use
+ * one key throughout, which keeps failed authentications, and the
+ * reselections they cost, to a minimum.
+ *
+ * @returns the status of the last sector read.
+ */
+enum nfc_status mifare_classic_dump(const struct iso14443a_card *card,
+				    u8 first, u8 sector_num,
+				    const struct mifare_classic_key_ref *keys,
+				    u32 key_num, mifare_classic_sector_cb cb,
+				    void *ctx);
+
+/**
+ * Tells the session that the card was handled elsewhere: activated, which
+ * leaves it @p selected, or halted, reset by the field or left without
+ * Crypto1, which leaves it to be selected again. Either way, no sector is open
+ * any more.
+ */
+void mifare_classic_session_reset(bool selected);
+
+void mifare_classic_stats_get(struct mifare_classic_stats *stats);
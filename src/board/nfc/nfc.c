@@ -20,9 +20,14 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <string.h>
+
 #include "drivers/clrc663/clrc663.h"
+#include "hal/dwt.h"
+#include "hal/gpdma.h"
 
 #include "gpio.h"
+#include "irq.h"
 #include "nfc.h"
 #include "spi.h"
 
@@ -35,15 +40,105 @@ static struct protocol_pair {
 	[NFC_PROTOCOL_MIFARE_106] = {
 		.tx	= DRV_CLRC663_PROTOCOL_TX_ISO_IEC_14443A_106_MILLER,
 		.rx	= DRV_CLRC663_PROTOCOL_RX_ISO_IEC_14443A_106_MANCHESTER_SUBC
+	},
+
+	[NFC_PROTOCOL_MIFARE_212] = {
+		.tx	= DRV_CLRC663_PROTOCOL_TX_ISO_IEC_14443A_212_MILLER,
+		.rx	= DRV_CLRC663_PROTOCOL_RX_ISO_IEC_14443A_212_BPSK
+	},
+
+	[NFC_PROTOCOL_MIFARE_424] = {
+		.tx	= DRV_CLRC663_PROTOCOL_TX_ISO_IEC_14443A_424_MILLER,
+		.rx	= DRV_CLRC663_PROTOCOL_RX_ISO_IEC_14443A_424_BPSK
+	},
+
+	[NFC_PROTOCOL_MIFARE_848] = {
+		.tx	= DRV_CLRC663_PROTOCOL_TX_ISO_IEC_14443A_848_MILLER,
+		.rx	= DRV_CLRC663_PROTOCOL_RX_ISO_IEC_14443A_848_BPSK
+	},
+
+	[NFC_PROTOCOL_ISO14443B_106] = {
+		.tx	= DRV_CLRC663_PROTOCOL_TX_ISO_IEC_14443B_106_NRZ,
+		.rx	= DRV_CLRC663_PROTOCOL_RX_ISO_IEC_14443B_106_BPSK
+	},
+
+	[NFC_PROTOCOL_ISO14443B_212] = {
+		.tx	= DRV_CLRC663_PROTOCOL_TX_ISO_IEC_14443B_212_NRZ,
+		.rx	= DRV_CLRC663_PROTOCOL_RX_ISO_IEC_14443B_212_BPSK
+	},
+
+	[NFC_PROTOCOL_ISO14443B_424] = {
+		.tx	= DRV_CLRC663_PROTOCOL_TX_ISO_IEC_14443B_424_NRZ,
+		.rx	= DRV_CLRC663_PROTOCOL_RX_ISO_IEC_14443B_424_BPSK
+	},
+
+	[NFC_PROTOCOL_ISO14443B_848] = {
+		.tx	= DRV_CLRC663_PROTOCOL_TX_ISO_IEC_14443B_848_NRZ,
+		.rx	= DRV_CLRC663_PROTOCOL_RX_ISO_IEC_14443B_848_BPSK
+	},
+
+	[NFC_PROTOCOL_FELICA_212] = {
+		.tx	= DRV_CLRC663_PROTOCOL_TX_FELICA_212_MANCHESTER,
+		.rx	= DRV_CLRC663_PROTOCOL_RX_FELICA_212_MANCHESTER
+	},
+
+	[NFC_PROTOCOL_FELICA_424] = {
+		.tx	= DRV_CLRC663_PROTOCOL_TX_FELICA_424_MANCHESTER,
+		.rx	= DRV_CLRC663_PROTOCOL_RX_FELICA_424_MANCHESTER
+	},
+
+	[NFC_PROTOCOL_ISO15693_1_OF_4_SSC] = {
+		.tx	= DRV_CLRC663_PROTOCOL_TX_ISO_IEC_15693_1_OF_4_SSC,
+		.rx	= DRV_CLRC663_PROTOCOL_RX_ISO_IEC_15693_1_OF_4_SSC
+	},
+
+	[NFC_PROTOCOL_ISO15693_1_OF_4_DSC] = {
+		.tx	= DRV_CLRC663_PROTOCOL_TX_ISO_IEC_15693_1_OF_4_DSC,
+		.rx	= DRV_CLRC663_PROTOCOL_RX_ISO_IEC_15693_1_OF_4_DSC
+	},
+
+	[NFC_PROTOCOL_ISO15693_1_OF_256_SSC] = {
+		.tx	= DRV_CLRC663_PROTOCOL_TX_ISO_IEC_15693_1_OF_256_SSC,
+		.rx	= DRV_CLRC663_PROTOCOL_RX_ISO_IEC_15693_1_OF_256_SSC
+	},
+
+	[NFC_PROTOCOL_EPC_UID] = {
+		.tx	= DRV_CLRC663_PROTOCOL_TX_EPC_UID_UNITARY_SSC,
+		.rx	= DRV_CLRC663_PROTOCOL_RX_EPC_UID_UNITARY_SSC
+	},
+
+	[NFC_PROTOCOL_ISO18000_3M3] = {
+		.tx	= DRV_CLRC663_PROTOCOL_TX_ISO_IEC_18000_3_MODE_3,
+		.rx	= DRV_CLRC663_PROTOCOL_RX_ISO_IEC_18000_3_MODE_3
 	}
 
 	// clang-format on
 };
 
+static const enum nfc_status status_tbl[] = {
+	// clang-format off
+
+	[DRV_CLRC663_EXEC_OK]		= NFC_STATUS_OK,
+	[DRV_CLRC663_EXEC_TIMEOUT]	= NFC_STATUS_TIMEOUT,
+	[DRV_CLRC663_EXEC_NO_IRQ]	= NFC_STATUS_NO_IRQ,
+	[DRV_CLRC663_EXEC_COLLISION]	= NFC_STATUS_COLLISION,
+	[DRV_CLRC663_EXEC_INTEGRITY]	= NFC_STATUS_INTEGRITY,
+	[DRV_CLRC663_EXEC_PROTOCOL]	= NFC_STATUS_PROTOCOL,
+	[DRV_CLRC663_EXEC_MIN_FRAME]	= NFC_STATUS_MIN_FRAME,
+	[DRV_CLRC663_EXEC_FIFO]		= NFC_STATUS_FIFO,
+	[DRV_CLRC663_EXEC_CMD]		= NFC_STATUS_CMD,
+	[DRV_CLRC663_EXEC_OVERFLOW]	= NFC_STATUS_OVERFLOW
+
+	// clang-format on
+};
+
+static struct nfc_xfer_stats xfer_stats;
+
 void nfc_init(void)
 {
 	nfc_gpio_init();
 	nfc_spi_init();
+	nfc_irq_init();
 
 	nfc_enable();
 }
@@ -58,10 +153,17 @@ void nfc_disable(void)
 	gpio_pin_set_high(GPIO_PIN_CLRC_RST);
 }
 
-void nfc_protocol_set(const enum nfc_protocol protocol)
+bool nfc_protocol_set(const enum nfc_protocol protocol)
 {
 	const struct protocol_pair *const proto = &protocol_tbl[protocol];
-	drv_clrc663_cmd_LoadProtocol(proto->rx, proto->tx);
+	return drv_clrc663_cmd_LoadProtocol(proto->rx, proto->tx);
+}
+
+bool nfc_protocol_set_split(const enum nfc_protocol tx,
+			    const enum nfc_protocol rx)
+{
+	return drv_clrc663_cmd_LoadProtocol(protocol_tbl[rx].rx,
+					    protocol_tbl[tx].tx);
 }
 
 void nfc_rf_field_enable(void)
@@ -83,3 +185,148 @@ u8 nfc_read_reg(const u8 byte)
 {
 	return drv_clrc663_reg_read(byte);
 }
+
+void nfc_write_reg(const u8 reg, const u8 val)
+{
+	drv_clrc663_reg_write(reg, val);
+}
+
+void nfc_fifo_flush(void)
+{
+	drv_clrc663_fifo_flush();
+}
+
+u32 nfc_fifo_length(void)
+{
+	return drv_clrc663_fifo_size();
+}
+
+void nfc_fifo_read(u8 *const dst, const u32 size)
+{
+	drv_clrc663_fifo_read(dst, size);
+}
+
+void nfc_fifo_write(const u8 *const src, const u32 size)
+{
+	drv_clrc663_fifo_write(src, size);
+}
+
+enum nfc_status nfc_transceive(const struct nfc_xfer *const xfer,
+			       struct nfc_xfer_result *const result)
+{
+	const struct drv_clrc663_transceive drv_xfer = {
+		// clang-format off
+
+		.tx		= xfer->tx,
+		.tx_size	= xfer->tx_size,
+		.tx_last_bits	= xfer->tx_last_bits,
+		.tx_crc		= xfer->flags & NFC_XFER_TX_CRC,
+		.rx_crc		= xfer->flags & NFC_XFER_RX_CRC,
+		.rx		= xfer->rx,
+		.rx_size_max	= xfer->rx_size_max,
+		.rx_align	= xfer->rx_align,
+		.timeout_us	= xfer->timeout_us
+
+		// clang-format on
+	};
+
+	struct drv_clrc663_transceive_result drv_result;
+
+	const u32 start = dwt_cyccnt_read();
+	const enum drv_clrc663_exec_status status =
+		drv_clrc663_transceive(&drv_xfer, &drv_result);
+	const u32 cycles = dwt_cyccnt_read() - start;
+
+	app_assert(status != DRV_CLRC663_EXEC_PENDING);
+
+	result->status = status_tbl[status];
+	result->rx_size = drv_result.rx_size;
+	result->rx_last_bits = drv_result.rx_last_bits;
+	result->coll_pos_valid = drv_result.coll_pos_valid;
+	result->coll_pos = drv_result.coll_pos;
+	result->latency_cycles = cycles;
+
+	xfer_stats.frames++;
+	xfer_stats.latency_last = cycles;
+
+	if (cycles > xfer_stats.latency_max)
+		xfer_stats.latency_max = cycles;
+
+	if (result->status == NFC_STATUS_TIMEOUT)
+		xfer_stats.timeouts++;
+	else if (result->status != NFC_STATUS_OK)
+		xfer_stats.errors++;
+
+	return result->status;
+}
+
+void nfc_xfer_stats_get(struct nfc_xfer_stats *const stats)
+{
+	*stats = xfer_stats;
+}
+
+bool nfc_key_load(const u8 *const key)
+{
+	return drv_clrc663_cmd_LoadKey(key);
+}
+
+bool nfc_key_load_e2(const u8 key_num)
+{
+	return drv_clrc663_cmd_LoadKeyE2(key_num);
+}
+
+bool nfc_key_store_e2(const u8 key_num, const u8 *const key)
+{
+	return drv_clrc663_cmd_StoreKeyE2(key_num, key);
+}
+
+enum nfc_status nfc_mifare_authent(const u8 auth, const u8 block,
+				   const u8 *const uid, const u32 timeout_us)
+{
+	const enum drv_clrc663_exec_status status =
+		drv_clrc663_cmd_MFAuthent(auth, block, uid, timeout_us);
+
+	app_assert(status != DRV_CLRC663_EXEC_PENDING);
+	return status_tbl[status];
+}
+
+void nfc_crypto1_disable(void)
+{
+	drv_clrc663_crypto1_off();
+}
+
+static u32 bytes_per_sec(const u32 size, const u32 cycles)
+{
+	if (!cycles)
+		return 0;
+
+	return ((u64)size * SYSCTL_CCLK_HZ) / cycles;
+}
+
+bool nfc_fifo_bench(const u32 size, struct nfc_fifo_bench *const result)
+{
+	// Kept in GPDMA_MEM, so that only the SPI transfer itself is measured.
+	static GPDMA_MEM u8 tx[DRV_CLRC663_FIFO_NUM_BYTES_MAX];
+	static GPDMA_MEM u8 rx[DRV_CLRC663_FIFO_NUM_BYTES_MAX];
+
+	if (!size || (size > sizeof(tx)))
+		return false;
+
+	for (u32 i = 0; i < size; ++i)
+		tx[i] = i;
+
+	drv_clrc663_cmd_Idle();
+	drv_clrc663_fifo_mode_set(DRV_CLRC663_FIFO_MODE_512);
+
+	const u32 start = dwt_cyccnt_read();
+	drv_clrc663_fifo_write(tx, size);
+	const u32 written = dwt_cyccnt_read();
+	drv_clrc663_fifo_read(rx, size);
+	const u32 read = dwt_cyccnt_read();
+
+	result->write_bps = bytes_per_sec(size, written - start);
+	result->read_bps = bytes_per_sec(size, read - written);
+
+	return !memcmp(tx, rx, size);
+}
+
@@ -22,26 +22,196 @@
 
 #pragma once
 
+#include <stdbool.h>
+
 #include "common/types.h"
+#include "common/util.h"
 
+/** Air interfaces, with their bit rates in kbit/s */
 enum nfc_protocol {
+	/** ISO/IEC 14443A */
 	NFC_PROTOCOL_MIFARE_106,
 	NFC_PROTOCOL_MIFARE_212,
 	NFC_PROTOCOL_MIFARE_424,
 	NFC_PROTOCOL_MIFARE_848,
+
+	NFC_PROTOCOL_ISO14443B_106,
+	NFC_PROTOCOL_ISO14443B_212,
+	NFC_PROTOCOL_ISO14443B_424,
+	NFC_PROTOCOL_ISO14443B_848,
+
+	NFC_PROTOCOL_FELICA_212,
+	NFC_PROTOCOL_FELICA_424,
+
+	/** ISO/IEC 15693 at 26 kbit/s, with one or two subcarriers */
+	NFC_PROTOCOL_ISO15693_1_OF_4_SSC,
+	NFC_PROTOCOL_ISO15693_1_OF_4_DSC,
+	NFC_PROTOCOL_ISO15693_1_OF_256_SSC,
+
+	NFC_PROTOCOL_EPC_UID,
+
+	/** ISO/IEC 18000-3 mode 3, also known as EPC HF Gen2 */
+	NFC_PROTOCOL_ISO18000_3M3,
+
 	NFC_PROTOCOL_NUM
 };
 
+enum nfc_status {
+	NFC_STATUS_OK,
+
+	/** The card did not respond in time */
+	NFC_STATUS_TIMEOUT,
+
+	/** The CLRC663 never signalled completion */
+	NFC_STATUS_NO_IRQ,
+
+	NFC_STATUS_COLLISION,
+
+	/** CRC or parity error */
+	NFC_STATUS_INTEGRITY,
+
+	/** Malformed start or end of frame */
+	NFC_STATUS_PROTOCOL,
+
+	NFC_STATUS_MIN_FRAME,
+	NFC_STATUS_FIFO,
+	NFC_STATUS_CMD,
+
+	/** The response did not fit the receive buffer */
+	NFC_STATUS_OVERFLOW,
+
+	/** The card rejected the key */
+	NFC_STATUS_AUTH,
+
+	/** The card refused the command */
+	NFC_STATUS_NAK,
+
+	/** The tag holds no NDEF message */
+	NFC_STATUS_NO_NDEF
+};
+
+enum nfc_xfer_flags {
+	/** Appends a CRC to the frame sent */
+	NFC_XFER_TX_CRC = BIT_0,
+
+	/** Checks and strips the CRC of the response */
+	NFC_XFER_RX_CRC = BIT_1
+};
+
+/** A frame exchange; both buffers are accessed in place. */
+struct nfc_xfer {
+	const u8 *tx;
+	u32 tx_size;
+
+	/** Valid bits in the last byte sent, 1 to 7; 0 sends all 8 */
+	u8 tx_last_bits;
+	u8 flags;
+
+	u8 *rx;
+	u32 rx_size_max;
+
+	/** Bit position of the first bit received in rx[0], 0 to 7 */
+	u8 rx_align;
+
+	/** Time the card has to start responding, in microseconds */
+	u32 timeout_us;
+};
+
+struct nfc_xfer_result {
+	enum nfc_status status;
+	u32 rx_size;
+
+	/** Valid bits in the last byte received, 1 to 7; 0 if all 8 are */
+	u8 rx_last_bits;
+
+	/**
+	 * Position of the first colliding bit, counted from bit 0 of rx[0];
+	 * valid if coll_pos_valid is set and the status is a collision.
+	 */
+	bool coll_pos_valid;
+	u8 coll_pos;
+
+	/** Round trip from starting to send to having read the response */
+	u32 latency_cycles;
+};
+
+struct nfc_xfer_stats {
+	u32 frames;
+	u32 errors;
+	u32 timeouts;
+
+	/** Round-trip latencies, in core cycles */
+	u32 latency_last;
+	u32 latency_max;
+};
+
+struct nfc_fifo_bench {
+	/** Throughput of writing the FIFO, in bytes per second. */
+	u32 write_bps;
+
+	/** Throughput of reading the FIFO back, in bytes per second. */
+	u32 read_bps;
+};
+
 void nfc_init(void);
 
 void nfc_enable(void);
 void nfc_disable(void);
 
-void nfc_protocol_set(enum nfc_protocol protocol);
+bool nfc_protocol_set(enum nfc_protocol protocol);
+
+/**
+ * Loads the transmitter settings of @p tx and the receiver settings of @p rx,
+ * for a link with a different bit rate in each direction.
+ */
+bool nfc_protocol_set_split(enum nfc_protocol tx, enum nfc_protocol rx);
 
 void nfc_rf_field_enable(void);
 void nfc_rf_field_disable(void);
 
 u8 nfc_read_reg(u8 reg);
+void nfc_write_reg(u8 reg, u8 val);
+
+void nfc_fifo_flush(void);
+u32 nfc_fifo_length(void);
+void nfc_fifo_read(u8 *dst, u32 size);
+void nfc_fifo_write(const u8 *src, u32 size);
+
+u8 nfc_get_device_version(void);
+
+/**
+ * Sends @p xfer->tx to the card in the field and receives its response into
+ * @p xfer->rx. A protocol must have been loaded and the field enabled.
+ *
+ * @returns the outcome, which is also stored in @p result.
+ */
+enum nfc_status nfc_transceive(const struct nfc_xfer *xfer,
+			       struct nfc_xfer_result *result);
+
+void nfc_xfer_stats_get(struct nfc_xfer_stats *stats);
+
+/** Loads a MIFARE Classic key into the CLRC663's key buffer. */
+bool nfc_key_load(const u8 *key);
+bool nfc_key_load_e2(u8 key_num);
+
+/** Stores a MIFARE Classic key in the CLRC663's EEPROM, as @p key_num. */
+bool nfc_key_store_e2(u8 key_num, const u8 *key);
+
+/**
+ * Authenticates to @p block of a MIFARE Classic card with the key in the key
+ * buffer, after which nfc_transceive() encrypts and decrypts. @p auth is the
+ * card command for key A or B, @p uid the 4 UID bytes the card uses.
+ */
+enum nfc_status nfc_mifare_authent(u8 auth, u8 block, const u8 *uid,
+				   u32 timeout_us);
+
+/** Ends any MIFARE Classic session, so that frames go out in plain again. */
+void nfc_crypto1_disable(void);
 
-u8 nfc_get_device_version(void);
\ No newline at end of file
+/**
+ * Measures FIFO throughput by writing @p size bytes to the CLRC663 FIFO and
+ * reading them back.
+ *
+ * @returns false if @p size is out of range or the data read back differs.
+ */
+bool nfc_fifo_bench(u32 size, struct nfc_fifo_bench *result);
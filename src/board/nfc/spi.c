@@ -37,4 +37,5 @@ void nfc_spi_init(void)
 		// clang-format on
 	};
 	spi_init_moto_master(SPI_INST, &cfg);
+	spi_dma_init(SPI_INST);
 }
\ No newline at end of file
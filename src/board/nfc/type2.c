@@ -0,0 +1,426 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <string.h>
+
+#include "common/types.h"
+#include "common/util.h"
+#include "drivers/clrc663/clrc663.h"
+#include "hal/dwt.h"
+
+#include "iso14443a.h"
+#include "nfc.h"
+#include "type2.h"
+
+enum {
+	CMD_READ = 0x30,
+	CMD_FAST_READ = 0x3A,
+
+	// The tag refuses with 4 bits.
+	NAK_BITS = 4,
+
+	// The response of a FAST_READ fits into the FIFO as a whole, as its CRC
+	// is stripped on the way in.
+	FAST_READ_PAGE_NUM_MAX =
+		DRV_CLRC663_FIFO_NUM_BYTES_MAX / TYPE2_PAGE_SIZE,
+
+	READ_TIMEOUT_US = 5000,
+
+	// The timeout also bounds each wait for a FIFO interrupt, and at
+	// 106 kbit/s the 384 bytes until the first HiAlert take 33 ms.
+	FAST_READ_TIMEOUT_US = 40000,
+
+	CC_MAGIC = 0xE1,
+	CC_VERSION_MAJOR = 1,
+	CC_SIZE_UNIT = 8,
+
+	// Read access is granted without any security if the upper nibble is 0.
+	CC_ACCESS_READ_MASK = 0xF0,
+
+	TLV_NULL = 0x00,
+	TLV_NDEF = 0x03,
+	TLV_TERMINATOR = 0xFE,
+
+	// Lengths of 255 and more follow in two bytes, most significant first.
+	TLV_LEN_LONG = 0xFF
+};
+
+static struct {
+	/** The tag of the session, and whether it is still selected */
+	u8 uid[ISO14443A_UID_SIZE_MAX];
+	u8 uid_size;
+	bool selected;
+
+	/** Whether the tag refused FAST_READ, and is read with READ */
+	bool fast_read_refused;
+
+	/** The data area as announced by the CC, and as far as it was read */
+	u8 data[TYPE2_DATA_SIZE_MAX];
+	u32 data_size;
+	u32 data_read;
+
+	struct type2_stats stats;
+} t2;
+
+/** Starts a new session if @p card is not the tag of the current one. */
+static void session_for(const struct iso14443a_card *const card)
+{
+	if ((card->uid_size == t2.uid_size) &&
+	    !memcmp(card->uid, t2.uid, card->uid_size))
+		return;
+
+	memcpy(t2.uid, card->uid, card->uid_size);
+	t2.uid_size = card->uid_size;
+
+	// The tag has just been activated.
+	t2.selected = true;
+	t2.fast_read_refused = false;
+}
+
+void type2_session_reset(const bool selected)
+{
+	t2.selected = selected;
+}
+
+/** Selects the tag again if an error has sent it back to IDLE. */
+static enum nfc_status reselect(const struct iso14443a_card *const card)
+{
+	if (t2.selected)
+		return NFC_STATUS_OK;
+
+	struct iso14443a_card reselected = *card;
+
+	const enum nfc_status status =
+		iso14443a_reselect(ISO14443A_REQ_WUPA, &reselected);
+
+	if (status != NFC_STATUS_OK)
+		return status;
+
+	t2.selected = true;
+	return NFC_STATUS_OK;
+}
+
+static enum nfc_status pages_xfer(const u8 *const tx, const u32 tx_size,
+				  u8 *const rx, const u32 rx_size,
+				  const u32 timeout_us)
+{
+	const struct nfc_xfer xfer = {
+		// clang-format off
+
+		.tx		= tx,
+		.tx_size	= tx_size,
+		.flags		= NFC_XFER_TX_CRC | NFC_XFER_RX_CRC,
+		.rx		= rx,
+		.rx_size_max	= rx_size,
+		.timeout_us	= timeout_us
+
+		// clang-format on
+	};
+
+	struct nfc_xfer_result result;
+	enum nfc_status status = nfc_transceive(&xfer, &result);
+
+	// A NAK is too short for a CRC, but tells more than its error.
+	if ((result.rx_size == 1) && (result.rx_last_bits == NAK_BITS))
+		status = NFC_STATUS_NAK;
+	else if ((status == NFC_STATUS_OK) && (result.rx_size != rx_size))
+		status = NFC_STATUS_PROTOCOL;
+
+	// Any error leaves the tag in IDLE, or at least in doubt.
+	if (status != NFC_STATUS_OK)
+		t2.selected = false;
+
+	return status;
+}
+
+static enum nfc_status fast_read(const u8 page, const u32 page_num,
+				 u8 *const data)
+{
+	const u8 tx[] = {
+		[0] = CMD_FAST_READ,
+		[1] = page,
+		[2] = page + page_num - 1
+	};
+
+	t2.stats.fast_reads++;
+
+	const enum nfc_status status =
+		pages_xfer(tx, sizeof(tx), data, page_num * TYPE2_PAGE_SIZE,
+			   FAST_READ_TIMEOUT_US);
+
+	if (status == NFC_STATUS_OK)
+		t2.stats.pages_read += page_num;
+
+	return status;
+}
+
+/** Reads up to TYPE2_READ_PAGE_NUM pages, the rest of the frame unused. */
+static enum nfc_status read_pages(const u8 page, const u32 page_num,
+				  u8 *const data)
+{
+	const u8 tx[] = {
+		[0] = CMD_READ,
+		[1] = page
+	};
+
+	u8 rx[TYPE2_READ_PAGE_NUM * TYPE2_PAGE_SIZE];
+
+	t2.stats.reads++;
+
+	const enum nfc_status status =
+		pages_xfer(tx, sizeof(tx), rx, sizeof(rx), READ_TIMEOUT_US);
+
+	if (status != NFC_STATUS_OK)
+		return status;
+
+	memcpy(data, rx, page_num * TYPE2_PAGE_SIZE);
+	t2.stats.pages_read += page_num;
+
+	return NFC_STATUS_OK;
+}
+
+/**
+ * Reads as many of @p page_num pages from @p page on as one frame carries;
+ * @p page_num is updated to the pages read.
+ */
+static enum nfc_status frame_read(const struct iso14443a_card *const card,
+				  const u8 page, u32 *const page_num,
+				  u8 *const data)
+{
+	enum nfc_status status = reselect(card);
+
+	if (status != NFC_STATUS_OK)
+		return status;
+
+	if (!t2.fast_read_refused) {
+		if (*page_num > FAST_READ_PAGE_NUM_MAX)
+			*page_num = FAST_READ_PAGE_NUM_MAX;
+
+		status = fast_read(page, *page_num, data);
+
+		// A tag without FAST_READ either refuses it or keeps silent,
+		// and drops back to IDLE in both cases.
+		if ((status != NFC_STATUS_NAK) &&
+		    (status != NFC_STATUS_TIMEOUT))
+			return status;
+
+		status = reselect(card);
+
+		if (status != NFC_STATUS_OK)
+			return status;
+	}
+
+	if (*page_num > TYPE2_READ_PAGE_NUM)
+		*page_num = TYPE2_READ_PAGE_NUM;
+
+	status = read_pages(page, *page_num, data);
+
+	if ((status == NFC_STATUS_OK) && !t2.fast_read_refused) {
+		t2.fast_read_refused = true;
+		t2.stats.fast_read_fallbacks++;
+	}
+
+	return status;
+}
+
+enum nfc_status type2_read(const struct iso14443a_card *const card,
+			   const u8 first, const u32 page_num, u8 *const data)
+{
+	app_assert(page_num && ((first + page_num) <= 256));
+
+	session_for(card);
+
+	for (u32 pos = 0; pos < page_num;) {
+		u32 num = page_num - pos;
+
+		const enum nfc_status status = frame_read(
+			card, first + pos, &num, &data[pos * TYPE2_PAGE_SIZE]);
+
+		if (status != NFC_STATUS_OK)
+			return status;
+
+		pos += num;
+	}
+
+	return NFC_STATUS_OK;
+}
+
+/**
+ * Makes sure that the data area has been read up to @p end, reading ahead as
+ * far as a frame reaches.
+ */
+static enum nfc_status data_need(const struct iso14443a_card *const card,
+				 const u32 end)
+{
+	// A TLV which runs past the data area is malformed.
+	if (end > t2.data_size)
+		return NFC_STATUS_NO_NDEF;
+
+	while (t2.data_read < end) {
+		const u32 pos = t2.data_read;
+		const u8 page = TYPE2_PAGE_DATA + (pos / TYPE2_PAGE_SIZE);
+		u32 page_num = (t2.data_size - pos) / TYPE2_PAGE_SIZE;
+
+		const enum nfc_status status =
+			frame_read(card, page, &page_num, &t2.data[pos]);
+
+		if (status != NFC_STATUS_OK)
+			return status;
+
+		t2.data_read += page_num * TYPE2_PAGE_SIZE;
+	}
+
+	return NFC_STATUS_OK;
+}
+
+static enum nfc_status cc_read(const struct iso14443a_card *const card,
+			       struct type2_cc *const cc)
+{
+	// READ returns the 3 pages after the CC too, which are kept, as short
+	// messages fit into them.
+	u8 pages[TYPE2_READ_PAGE_NUM * TYPE2_PAGE_SIZE];
+
+	enum nfc_status status = reselect(card);
+
+	if (status == NFC_STATUS_OK)
+		status = read_pages(TYPE2_PAGE_CC, TYPE2_READ_PAGE_NUM, pages);
+
+	if (status != NFC_STATUS_OK)
+		return status;
+
+	cc->magic = pages[0];
+	cc->version = pages[1];
+	cc->size = pages[2];
+	cc->access = pages[3];
+
+	if ((cc->magic != CC_MAGIC) ||
+	    ((cc->version >> 4) != CC_VERSION_MAJOR) ||
+	    (cc->access & CC_ACCESS_READ_MASK))
+		return NFC_STATUS_NO_NDEF;
+
+	t2.data_size = cc->size * CC_SIZE_UNIT;
+
+	if (t2.data_size > TYPE2_DATA_SIZE_MAX)
+		t2.data_size = TYPE2_DATA_SIZE_MAX;
+
+	t2.data_read = sizeof(pages) - TYPE2_PAGE_SIZE;
+
+	if (t2.data_read > t2.data_size)
+		t2.data_read = t2.data_size;
+
+	memcpy(t2.data, &pages[TYPE2_PAGE_SIZE], t2.data_read);
+	return NFC_STATUS_OK;
+}
+
+static enum nfc_status ndef_read(const struct iso14443a_card *const card,
+				 struct type2_cc *const cc, u8 *const ndef,
+				 const u32 ndef_size_max, u32 *const ndef_size)
+{
+	enum nfc_status status = cc_read(card, cc);
+
+	if (status != NFC_STATUS_OK)
+		return status;
+
+	u32 pos = 0;
+
+	for (;;) {
+		status = data_need(card, pos + 1);
+
+		if (status != NFC_STATUS_OK)
+			return status;
+
+		const u8 tag = t2.data[pos++];
+
+		if (tag == TLV_NULL)
+			continue;
+
+		if (tag == TLV_TERMINATOR)
+			return NFC_STATUS_NO_NDEF;
+
+		status = data_need(card, pos + 1);
+
+		if (status != NFC_STATUS_OK)
+			return status;
+
+		u32 len = t2.data[pos++];
+
+		if (len == TLV_LEN_LONG) {
+			status = data_need(card, pos + 2);
+
+			if (status != NFC_STATUS_OK)
+				return status;
+
+			len = (t2.data[pos] << 8) | t2.data[pos + 1];
+			pos += 2;
+		}
+
+		// Lock and memory control TLVs, and proprietary ones, are
+		// skipped; the data area is read as a whole regardless.
+		if (tag != TLV_NDEF) {
+			pos += len;
+			continue;
+		}
+
+		if (len > ndef_size_max)
+			return NFC_STATUS_OVERFLOW;
+
+		status = data_need(card, pos + len);
+
+		if (status != NFC_STATUS_OK)
+			return status;
+
+		memcpy(ndef, &t2.data[pos], len);
+		*ndef_size = len;
+
+		return NFC_STATUS_OK;
+	}
+}
+
+enum nfc_status type2_ndef_read(const struct iso14443a_card *const card,
+				struct type2_cc *const cc, u8 *const ndef,
+				const u32 ndef_size_max, u32 *const ndef_size)
+{
+	const u32 start = dwt_cyccnt_read();
+
+	session_for(card);
+
+	*cc = (struct type2_cc){ 0 };
+	*ndef_size = 0;
+
+	const enum nfc_status status =
+		ndef_read(card, cc, ndef, ndef_size_max, ndef_size);
+
+	const u32 cycles = dwt_cyccnt_read() - start;
+
+	t2.stats.ndef_reads++;
+	t2.stats.ndef_time_last = cycles;
+
+	if (cycles > t2.stats.ndef_time_max)
+		t2.stats.ndef_time_max = cycles;
+
+	return status;
+}
+
+void type2_stats_get(struct type2_stats *const stats)
+{
+	*stats = t2.stats;
+}
@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "common/types.h"
+#include "iso14443a.h"
+#include "nfc.h"
+
+enum {
+	TYPE2_PAGE_SIZE = 4,
+
+	/** Pages a READ returns */
+	TYPE2_READ_PAGE_NUM = 4,
+
+	/** The capability container, followed by the data area */
+	TYPE2_PAGE_CC = 3,
+	TYPE2_PAGE_DATA = 4,
+
+	/**
+	 * Largest data area which READ and FAST_READ reach, as they address
+	 * pages with one byte. Larger tags would need SECTOR_SELECT.
+	 */
+	TYPE2_DATA_SIZE_MAX = (256 - TYPE2_PAGE_DATA) * TYPE2_PAGE_SIZE
+};
+
+/** The capability container of an NFC Forum Type 2 Tag */
+struct type2_cc {
+	u8 magic;
+	u8 version;
+
+	/** Size of the data area, in units of 8 bytes */
+	u8 size;
+	u8 access;
+};
+
+struct type2_stats {
+	u32 fast_reads;
+
+	/** Frames of 4 pages, for tags without FAST_READ */
+	u32 reads;
+
+	/** Tags which refused FAST_READ */
+	u32 fast_read_fallbacks;
+
+	u32 pages_read;
+	u32 ndef_reads;
+
+	/** Time of a whole NDEF read, in core cycles */
+	u32 ndef_time_last;
+	u32 ndef_time_max;
+};
+
+/**
+ * Reads @p page_num pages from @p first on of @p card, which must have been
+ * activated last, into @p data. FAST_READ fetches as many pages per frame as
+ * the CLRC663's FIFO holds; a tag which refuses it, such as the original
+ * MIFARE Ultralight, is selected again and read with READ instead.
+ */
+enum nfc_status type2_read(const struct iso14443a_card *card, u8 first,
+			   u32 page_num, u8 *data);
+
+/**
+ * Reads the NDEF message of @p card: checks the capability container, walks
+ * the TLVs of the data area and copies the value of the first NDEF TLV to
+ * @p ndef. Only the pages up to the end of the message are read.
+ *
+ * @returns NFC_STATUS_NO_NDEF if the tag is not formatted for NDEF, grants no
+ * read access or holds no NDEF message, and NFC_STATUS_OVERFLOW if the
+ * message is larger than @p ndef_size_max.
+ */
+enum nfc_status type2_ndef_read(const struct iso14443a_card *card,
+				struct type2_cc *cc, u8 *ndef,
+				u32 ndef_size_max, u32 *ndef_size);
+
+/**
+ * Tells the session that the tag was handled elsewhere: activated, which
+ * leaves it @p selected, or halted or reset by the field, which leaves it to
+ * be selected again with WUPA.
+ */
+void type2_session_reset(bool selected);
+
+void type2_stats_get(struct type2_stats *stats);
@@ -24,6 +24,9 @@
 
 #include <stdint.h>
 
+typedef uint64_t u64;
 typedef uint32_t u32;
 typedef uint16_t u16;
-typedef uint8_t u8;
\ No newline at end of file
+typedef uint8_t u8;
+
+typedef int32_t s32;
\ No newline at end of file
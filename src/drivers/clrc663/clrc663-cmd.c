@@ -22,6 +22,406 @@
 
 #include "clrc663.h"
 #include "clrc663-cmd.h"
+#include "clrc663-irq.h"
+
+enum {
+	TIMER_CLK_HZ = 211875,
+	TIMER_TICKS_MAX = UINT16_MAX,
+
+	// Offsets of a timer's registers from its TxControl register.
+	TIMER_REG_OFFSET_RELOAD_HI = 1,
+	TIMER_REG_OFFSET_RELOAD_LO = 2,
+	TIMER_REG_STRIDE =
+		DRV_CLRC663_REG_T1Control - DRV_CLRC663_REG_T0Control,
+
+	// The host only gives up on the IRQ pin well after the timer should
+	// have expired. A timer started at the end of a transmission needs the
+	// transmission time on top, which is close to 50 ms for a full FIFO at
+	// 106 kbit/s.
+	HOST_TIMEOUT_MARGIN_US = 100000,
+
+	// In 512 byte mode, LoAlert is raised once the FIFO holds no more than
+	// this, and HiAlert once it has no more than this left free.
+	FIFO_WATER_LEVEL = 128,
+
+	RX_ERRORS = DRV_CLRC663_Error_CollDet | DRV_CLRC663_Error_IntegErr |
+		    DRV_CLRC663_Error_ProtErr | DRV_CLRC663_Error_MinFrameErr
+};
+
+static struct {
+	enum drv_clrc663_timer timer;
+	bool timer_armed;
+	uint8_t irq0_en;
+	uint32_t host_timeout_us;
+} exec_state;
+
+static enum drv_clrc663_reg timer_ctrl_reg(const enum drv_clrc663_timer timer)
+{
+	return DRV_CLRC663_REG_T0Control + (timer * TIMER_REG_STRIDE);
+}
+
+static void timer_stop(const enum drv_clrc663_timer timer)
+{
+	drv_clrc663_reg_write(DRV_CLRC663_REG_TControl,
+			      DRV_CLRC663_TControl_TxStartStopNow << timer);
+}
+
+static void timer_arm(const enum drv_clrc663_timer timer,
+		      const enum drv_clrc663_timer_start start,
+		      const uint32_t timeout_us)
+{
+	const enum drv_clrc663_reg ctrl = timer_ctrl_reg(timer);
+
+	uint32_t ticks =
+		(((uint64_t)timeout_us * TIMER_CLK_HZ) + 999999) / 1000000;
+
+	if (ticks > TIMER_TICKS_MAX)
+		ticks = TIMER_TICKS_MAX;
+
+	uint8_t TxControl = 0;
+
+	TxControl = drv_clrc663_field_set(TxControl,
+					  DRV_CLRC663_TxControl_MASK_TStart,
+					  DRV_CLRC663_TxControl_SHIFT_TStart,
+					  start);
+
+	TxControl = drv_clrc663_field_set(TxControl,
+					  DRV_CLRC663_TxControl_MASK_TClk,
+					  DRV_CLRC663_TxControl_SHIFT_TClk,
+					  DRV_CLRC663_TIMER_CLK_211_875_KHZ);
+
+	// A response arriving in time must not be cut short by the timer.
+	if (start == DRV_CLRC663_TIMER_START_TX_END)
+		TxControl |= DRV_CLRC663_TxControl_TStopRx;
+
+	timer_stop(timer);
+
+	drv_clrc663_reg_write(ctrl, TxControl);
+	drv_clrc663_reg_write(ctrl + TIMER_REG_OFFSET_RELOAD_HI, ticks >> 8);
+	drv_clrc663_reg_write(ctrl + TIMER_REG_OFFSET_RELOAD_LO, ticks & 0xFF);
+}
+
+static void timer_start(const enum drv_clrc663_timer timer)
+{
+	drv_clrc663_reg_write(DRV_CLRC663_REG_TControl,
+			      (DRV_CLRC663_TControl_TxStartStopNow |
+			       DRV_CLRC663_TControl_TxRunning)
+				      << timer);
+}
+
+static enum drv_clrc663_exec_status
+decode(const struct drv_clrc663_exec_result *const result)
+{
+	const uint8_t error = result->error;
+
+	if (error & DRV_CLRC663_Error_CmdErr)
+		return DRV_CLRC663_EXEC_CMD;
+
+	if (error & (DRV_CLRC663_Error_FIFOWrErr | DRV_CLRC663_Error_FIFOOvl |
+		     DRV_CLRC663_Error_NoDataErr))
+		return DRV_CLRC663_EXEC_FIFO;
+
+	if (error & DRV_CLRC663_Error_CollDet)
+		return DRV_CLRC663_EXEC_COLLISION;
+
+	if (error & DRV_CLRC663_Error_IntegErr)
+		return DRV_CLRC663_EXEC_INTEGRITY;
+
+	if (error & DRV_CLRC663_Error_ProtErr)
+		return DRV_CLRC663_EXEC_PROTOCOL;
+
+	if (error & DRV_CLRC663_Error_MinFrameErr)
+		return DRV_CLRC663_EXEC_MIN_FRAME;
+
+	// Only the timer went off, not any of the sources the caller is
+	// waiting for. FIFO alerts only ever ask for data to be moved.
+	const uint8_t done = result->irq0 & exec_state.irq0_en &
+			     ~(DRV_CLRC663_IRQ0_ErrIRQ |
+			       DRV_CLRC663_IRQ0_HiAlertIRQ |
+			       DRV_CLRC663_IRQ0_LoAlertIRQ);
+
+	if (exec_state.timer_armed && !done &&
+	    (result->irq1 & (DRV_CLRC663_IRQ1_Timer0IRQ << exec_state.timer)))
+		return DRV_CLRC663_EXEC_TIMEOUT;
+
+	return DRV_CLRC663_EXEC_OK;
+}
+
+static enum drv_clrc663_exec_status
+finish(const bool asserted, struct drv_clrc663_exec_result *const result)
+{
+	result->irq0 = drv_clrc663_reg_read(DRV_CLRC663_REG_IRQ0);
+	result->irq1 = drv_clrc663_reg_read(DRV_CLRC663_REG_IRQ1);
+	result->error = drv_clrc663_reg_read(DRV_CLRC663_REG_Error);
+
+	if (exec_state.timer_armed)
+		timer_stop(exec_state.timer);
+
+	result->status = asserted ? decode(result) : DRV_CLRC663_EXEC_NO_IRQ;
+
+	// The command is still running if it timed out; cancel it so that the
+	// next one starts from a clean state.
+	if ((result->status == DRV_CLRC663_EXEC_TIMEOUT) ||
+	    (result->status == DRV_CLRC663_EXEC_NO_IRQ))
+		drv_clrc663_cmd_Idle();
+
+	return result->status;
+}
+
+void drv_clrc663_exec_start(const struct drv_clrc663_exec *const exec)
+{
+	exec_state.timer = exec->timer;
+	exec_state.timer_armed = exec->timeout_us != 0;
+	exec_state.irq0_en = exec->irq0_en | DRV_CLRC663_IRQ0_ErrIRQ;
+	exec_state.host_timeout_us =
+		exec->timeout_us ? (exec->timeout_us + HOST_TIMEOUT_MARGIN_US) :
+				   DRV_CLRC663_CMD_TIMEOUT_US;
+
+	uint8_t irq1_en = exec->irq1_en;
+
+	if (exec_state.timer_armed) {
+		timer_arm(exec->timer, exec->timer_start, exec->timeout_us);
+		irq1_en |= DRV_CLRC663_IRQ1_Timer0IRQ << exec->timer;
+	}
+
+	drv_clrc663_irq_arm(exec_state.irq0_en, irq1_en);
+
+	if (exec_state.timer_armed &&
+	    (exec->timer_start == DRV_CLRC663_TIMER_START_HOST))
+		timer_start(exec->timer);
+
+	drv_clrc663_reg_write(DRV_CLRC663_REG_Command, exec->cmd);
+}
+
+enum drv_clrc663_exec_status
+drv_clrc663_exec_poll(struct drv_clrc663_exec_result *const result)
+{
+	if (!drv_clrc663_irq_pin_asserted())
+		return DRV_CLRC663_EXEC_PENDING;
+
+	return finish(true, result);
+}
+
+enum drv_clrc663_exec_status
+drv_clrc663_exec(const struct drv_clrc663_exec *const exec,
+		 struct drv_clrc663_exec_result *const result)
+{
+	drv_clrc663_exec_start(exec);
+
+	const bool asserted =
+		drv_clrc663_irq_pin_wait(exec_state.host_timeout_us);
+
+	return finish(asserted, result);
+}
+
+static void irq0_clear(const uint8_t irq0)
+{
+	drv_clrc663_reg_write(DRV_CLRC663_REG_IRQ0, irq0);
+}
+
+static void crc_enable(const enum drv_clrc663_reg reg, const uint8_t en,
+		       const bool enable)
+{
+	uint8_t val = drv_clrc663_reg_read(reg);
+
+	if (enable)
+		val |= en;
+	else
+		val &= ~en;
+
+	drv_clrc663_reg_write(reg, val);
+}
+
+static size_t tx_fill(const struct drv_clrc663_transceive *const xfer,
+		      size_t tx_pos)
+{
+	const size_t room =
+		DRV_CLRC663_FIFO_NUM_BYTES_MAX - drv_clrc663_fifo_size();
+
+	size_t size = xfer->tx_size - tx_pos;
+
+	if (size > room)
+		size = room;
+
+	drv_clrc663_fifo_write(&xfer->tx[tx_pos], size);
+	return tx_pos + size;
+}
+
+static bool rx_drain(const struct drv_clrc663_transceive *const xfer,
+		     struct drv_clrc663_transceive_result *const result)
+{
+	const size_t size = drv_clrc663_fifo_size();
+
+	if (size > (xfer->rx_size_max - result->rx_size))
+		return false;
+
+	drv_clrc663_fifo_read(&xfer->rx[result->rx_size], size);
+	result->rx_size += size;
+
+	return true;
+}
+
+enum drv_clrc663_exec_status
+drv_clrc663_transceive(const struct drv_clrc663_transceive *const xfer,
+		       struct drv_clrc663_transceive_result *const result)
+{
+	drv_clrc663_cmd_Idle();
+	drv_clrc663_fifo_mode_set(DRV_CLRC663_FIFO_MODE_512);
+	drv_clrc663_reg_write(DRV_CLRC663_REG_WaterLevel, FIFO_WATER_LEVEL);
+
+	crc_enable(DRV_CLRC663_REG_TxCrcPreset, DRV_CLRC663_TxCrcPreset_TxCRCEn,
+		   xfer->tx_crc);
+
+	crc_enable(DRV_CLRC663_REG_RxCrcPreset, DRV_CLRC663_RxCrcPreset_RxCRCEn,
+		   xfer->rx_crc);
+
+	drv_clrc663_reg_write(
+		DRV_CLRC663_REG_TxDataNum,
+		drv_clrc663_field_set(DRV_CLRC663_TxDataNum_DataEn,
+				      DRV_CLRC663_TxDataNum_MASK_TxLastBits,
+				      DRV_CLRC663_TxDataNum_SHIFT_TxLastBits,
+				      xfer->tx_last_bits));
+
+	uint8_t RxBitCtrl = drv_clrc663_reg_read(DRV_CLRC663_REG_RxBitCtrl);
+
+	RxBitCtrl = drv_clrc663_field_set(RxBitCtrl,
+					  DRV_CLRC663_RxBitCtrl_MASK_RxAlign,
+					  DRV_CLRC663_RxBitCtrl_SHIFT_RxAlign,
+					  xfer->rx_align);
+
+	drv_clrc663_reg_write(DRV_CLRC663_REG_RxBitCtrl, RxBitCtrl);
+
+	result->rx_size = 0;
+	result->rx_last_bits = 0;
+	result->coll_pos_valid = false;
+	result->coll_pos = 0;
+
+	size_t tx_pos = tx_fill(xfer, 0);
+
+	// While transmitting, the FIFO is topped up on LoAlert. HiAlert only
+	// means something once the transmission is over, so it is enabled on
+	// TxIRQ; before that, it would fire on the data still to be sent.
+	uint8_t irq0_en = DRV_CLRC663_IRQ0_TxIRQ | DRV_CLRC663_IRQ0_RxIRQ;
+
+	if (tx_pos < xfer->tx_size)
+		irq0_en |= DRV_CLRC663_IRQ0_LoAlertIRQ;
+
+	const struct drv_clrc663_exec exec = {
+		// clang-format off
+
+		.cmd		= DRV_CLRC663_CMD_Transceive,
+		.irq0_en	= irq0_en,
+		.irq1_en	= 0,
+		.timeout_us	= xfer->timeout_us,
+		.timer		= DRV_CLRC663_TIMER_0,
+		.timer_start	= DRV_CLRC663_TIMER_START_TX_END
+
+		// clang-format on
+	};
+
+	drv_clrc663_exec_start(&exec);
+	irq0_en = exec_state.irq0_en;
+
+	for (;;) {
+		if (!drv_clrc663_irq_pin_wait(exec_state.host_timeout_us))
+			return finish(false, &result->exec);
+
+		const uint8_t irq0 =
+			drv_clrc663_reg_read(DRV_CLRC663_REG_IRQ0) & irq0_en;
+
+		const uint8_t service = irq0 & (DRV_CLRC663_IRQ0_LoAlertIRQ |
+						DRV_CLRC663_IRQ0_HiAlertIRQ |
+						DRV_CLRC663_IRQ0_TxIRQ);
+
+		// A reception error is flagged as soon as it is detected, while
+		// the rest of the frame is still coming in. Wait for RxIRQ, so
+		// that the data after e.g. a collision is not lost.
+		const bool rx_error =
+			(irq0 & DRV_CLRC663_IRQ0_ErrIRQ) &&
+			!(irq0 & DRV_CLRC663_IRQ0_RxIRQ) &&
+			(drv_clrc663_reg_read(DRV_CLRC663_REG_Error) &
+			 RX_ERRORS);
+
+		if (!service && rx_error) {
+			irq0_en &= ~DRV_CLRC663_IRQ0_ErrIRQ;
+
+			irq0_clear(DRV_CLRC663_IRQ0_ErrIRQ);
+			drv_clrc663_irq_pin_arm();
+			drv_clrc663_reg_write(DRV_CLRC663_REG_IRQ0En, irq0_en);
+			continue;
+		}
+
+		// Anything else is the end of the command: reception, an error
+		// or the timer.
+		if (!service)
+			break;
+
+		// Clear before serving, so that a source raised again while
+		// serving it keeps the pin asserted.
+		irq0_clear(service | ((service & DRV_CLRC663_IRQ0_TxIRQ) ?
+					      DRV_CLRC663_IRQ0_HiAlertIRQ :
+					      0));
+
+		drv_clrc663_irq_pin_arm();
+
+		if (service & DRV_CLRC663_IRQ0_LoAlertIRQ) {
+			tx_pos = tx_fill(xfer, tx_pos);
+
+			if (tx_pos == xfer->tx_size)
+				irq0_en &= ~DRV_CLRC663_IRQ0_LoAlertIRQ;
+		}
+
+		if (service & DRV_CLRC663_IRQ0_TxIRQ) {
+			irq0_en &= ~(DRV_CLRC663_IRQ0_TxIRQ |
+				     DRV_CLRC663_IRQ0_LoAlertIRQ);
+			irq0_en |= DRV_CLRC663_IRQ0_HiAlertIRQ;
+		}
+
+		drv_clrc663_reg_write(DRV_CLRC663_REG_IRQ0En, irq0_en);
+
+		if ((service & DRV_CLRC663_IRQ0_HiAlertIRQ) &&
+		    !rx_drain(xfer, result)) {
+			drv_clrc663_cmd_Idle();
+			finish(true, &result->exec);
+
+			result->exec.status = DRV_CLRC663_EXEC_OVERFLOW;
+			return result->exec.status;
+		}
+	}
+
+	exec_state.irq0_en = irq0_en;
+	finish(true, &result->exec);
+
+	if (result->exec.status == DRV_CLRC663_EXEC_COLLISION) {
+		const uint8_t RxColl =
+			drv_clrc663_reg_read(DRV_CLRC663_REG_RxColl);
+
+		result->coll_pos_valid = RxColl &
+					 DRV_CLRC663_RxColl_CollPosValid;
+
+		result->coll_pos =
+			drv_clrc663_field_get(RxColl,
+					      DRV_CLRC663_RxColl_MASK_CollPos,
+					      DRV_CLRC663_RxColl_SHIFT_CollPos);
+	}
+
+	if (!(result->exec.irq0 & DRV_CLRC663_IRQ0_RxIRQ))
+		return result->exec.status;
+
+	if (!rx_drain(xfer, result)) {
+		drv_clrc663_fifo_flush();
+
+		result->exec.status = DRV_CLRC663_EXEC_OVERFLOW;
+		return result->exec.status;
+	}
+
+	result->rx_last_bits = drv_clrc663_field_get(
+		drv_clrc663_reg_read(DRV_CLRC663_REG_RxBitCtrl),
+		DRV_CLRC663_RxBitCtrl_MASK_RxLastBits,
+		DRV_CLRC663_RxBitCtrl_SHIFT_RxLastBits);
+
+	return result->exec.status;
+}
 
 void drv_clrc663_cmd_Idle(void)
 {
@@ -34,15 +434,54 @@ void drv_clrc663_cmd_LPCD(void)
 	drv_clrc663_reg_write(DRV_CLRC663_REG_Command, DRV_CLRC663_CMD_LPCD);
 }
 
-void drv_clrc663_cmd_LoadKey(const uint8_t *const key)
+/** Executes @p cmd, which ends by going idle, on whatever is in the FIFO. */
+static bool exec_until_idle(const enum drv_clrc663_cmd cmd)
+{
+	const struct drv_clrc663_exec exec = {
+		// clang-format off
+
+		.cmd		= cmd,
+		.irq0_en	= DRV_CLRC663_IRQ0_IdleIRQ,
+		.irq1_en	= 0,
+		.timeout_us	= 0
+
+		// clang-format on
+	};
+
+	struct drv_clrc663_exec_result result;
+	return drv_clrc663_exec(&exec, &result) == DRV_CLRC663_EXEC_OK;
+}
+
+bool drv_clrc663_cmd_LoadKey(const uint8_t *const key)
 {
 	drv_clrc663_cmd_Idle();
 	drv_clrc663_fifo_flush();
 	drv_clrc663_fifo_write(key, DRV_CLRC663_MIFARE_CLASSIC_KEY_NUM_BYTES);
-	drv_clrc663_reg_write(DRV_CLRC663_REG_Command, DRV_CLRC663_CMD_LoadKey);
+
+	return exec_until_idle(DRV_CLRC663_CMD_LoadKey);
 }
 
-void drv_clrc663_cmd_LoadProtocol(const enum drv_clrc663_protocol_rx rx,
+bool drv_clrc663_cmd_LoadKeyE2(const uint8_t key_num)
+{
+	drv_clrc663_cmd_Idle();
+	drv_clrc663_fifo_flush();
+	drv_clrc663_fifo_write(&key_num, sizeof(key_num));
+
+	return exec_until_idle(DRV_CLRC663_CMD_LoadKeyE2);
+}
+
+bool drv_clrc663_cmd_StoreKeyE2(const uint8_t key_num,
+				const uint8_t *const key)
+{
+	drv_clrc663_cmd_Idle();
+	drv_clrc663_fifo_flush();
+	drv_clrc663_fifo_write(&key_num, sizeof(key_num));
+	drv_clrc663_fifo_write(key, DRV_CLRC663_MIFARE_CLASSIC_KEY_NUM_BYTES);
+
+	return exec_until_idle(DRV_CLRC663_CMD_StoreKeyE2);
+}
+
+bool drv_clrc663_cmd_LoadProtocol(const enum drv_clrc663_protocol_rx rx,
 				  const enum drv_clrc663_protocol_tx tx)
 {
 	drv_clrc663_cmd_Idle();
@@ -55,6 +494,54 @@ void drv_clrc663_cmd_LoadProtocol(const enum drv_clrc663_protocol_rx rx,
 
 	drv_clrc663_fifo_write(tx_buf, sizeof(tx_buf));
 
-	drv_clrc663_reg_write(DRV_CLRC663_REG_Command,
-			      DRV_CLRC663_CMD_LoadProtocol);
-}
\ No newline at end of file
+	return exec_until_idle(DRV_CLRC663_CMD_LoadProtocol);
+}
+
+enum drv_clrc663_exec_status drv_clrc663_cmd_MFAuthent(
+	const uint8_t auth, const uint8_t block, const uint8_t *const uid,
+	const uint32_t timeout_us)
+{
+	drv_clrc663_cmd_Idle();
+	drv_clrc663_fifo_flush();
+
+	const uint8_t tx_buf[] = {
+		[0] = auth,
+		[1] = block,
+		[2] = uid[0],
+		[3] = uid[1],
+		[4] = uid[2],
+		[5] = uid[3],
+	};
+
+	drv_clrc663_fifo_write(tx_buf, sizeof(tx_buf));
+
+	// The timer restarts at the end of each of the two frames sent.
+	const struct drv_clrc663_exec exec = {
+		// clang-format off
+
+		.cmd		= DRV_CLRC663_CMD_MFAuthent,
+		.irq0_en	= DRV_CLRC663_IRQ0_IdleIRQ,
+		.irq1_en	= 0,
+		.timeout_us	= timeout_us,
+		.timer		= DRV_CLRC663_TIMER_0,
+		.timer_start	= DRV_CLRC663_TIMER_START_TX_END
+
+		// clang-format on
+	};
+
+	struct drv_clrc663_exec_result result;
+
+	if (drv_clrc663_exec(&exec, &result) != DRV_CLRC663_EXEC_OK)
+		return result.status;
+
+	if (!(drv_clrc663_reg_read(DRV_CLRC663_REG_Status) &
+	      DRV_CLRC663_Status_Crypto1On))
+		return DRV_CLRC663_EXEC_PROTOCOL;
+
+	return DRV_CLRC663_EXEC_OK;
+}
+
+void drv_clrc663_crypto1_off(void)
+{
+	drv_clrc663_reg_write(DRV_CLRC663_REG_Status, 0);
+}
@@ -23,6 +23,10 @@
 #ifndef DRV_CLRC663_CMD_H
 #define DRV_CLRC663_CMD_H
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
 enum drv_clrc663_cmd {
 	/** no action, cancels current command execution */
 	DRV_CLRC663_CMD_Idle = UINT8_C(0x00),
@@ -99,18 +103,261 @@ enum drv_clrc663_cmd {
 	DRV_CLRC663_CMD_SoftReset = UINT8_C(0x1F)
 };
 
+/**
+ * Receiver settings stored in the EEPROM for LoadProtocol. Those of the
+ * ISO/IEC 15693 and EPC modes go with the transmitter settings of the same
+ * number, and are named after the mode.
+ */
 enum drv_clrc663_protocol_rx {
-	DRV_CLRC663_PROTOCOL_RX_ISO_IEC_14443A_106_MANCHESTER_SUBC
+	DRV_CLRC663_PROTOCOL_RX_ISO_IEC_14443A_106_MANCHESTER_SUBC = 0x00,
+	DRV_CLRC663_PROTOCOL_RX_ISO_IEC_14443A_212_BPSK = 0x01,
+	DRV_CLRC663_PROTOCOL_RX_ISO_IEC_14443A_424_BPSK = 0x02,
+	DRV_CLRC663_PROTOCOL_RX_ISO_IEC_14443A_848_BPSK = 0x03,
+	DRV_CLRC663_PROTOCOL_RX_ISO_IEC_14443B_106_BPSK = 0x04,
+	DRV_CLRC663_PROTOCOL_RX_ISO_IEC_14443B_212_BPSK = 0x05,
+	DRV_CLRC663_PROTOCOL_RX_ISO_IEC_14443B_424_BPSK = 0x06,
+	DRV_CLRC663_PROTOCOL_RX_ISO_IEC_14443B_848_BPSK = 0x07,
+	DRV_CLRC663_PROTOCOL_RX_FELICA_212_MANCHESTER = 0x08,
+	DRV_CLRC663_PROTOCOL_RX_FELICA_424_MANCHESTER = 0x09,
+	DRV_CLRC663_PROTOCOL_RX_ISO_IEC_15693_1_OF_4_SSC = 0x0A,
+	DRV_CLRC663_PROTOCOL_RX_ISO_IEC_15693_1_OF_4_DSC = 0x0B,
+	DRV_CLRC663_PROTOCOL_RX_ISO_IEC_15693_1_OF_256_SSC = 0x0C,
+	DRV_CLRC663_PROTOCOL_RX_EPC_UID_UNITARY_SSC = 0x0D,
+	DRV_CLRC663_PROTOCOL_RX_ISO_IEC_18000_3_MODE_3 = 0x0E
 };
 
+/** Transmitter settings stored in the EEPROM for LoadProtocol */
 enum drv_clrc663_protocol_tx {
-	DRV_CLRC663_PROTOCOL_TX_ISO_IEC_14443A_106_MILLER
+	DRV_CLRC663_PROTOCOL_TX_ISO_IEC_14443A_106_MILLER = 0x00,
+	DRV_CLRC663_PROTOCOL_TX_ISO_IEC_14443A_212_MILLER = 0x01,
+	DRV_CLRC663_PROTOCOL_TX_ISO_IEC_14443A_424_MILLER = 0x02,
+	DRV_CLRC663_PROTOCOL_TX_ISO_IEC_14443A_848_MILLER = 0x03,
+	DRV_CLRC663_PROTOCOL_TX_ISO_IEC_14443B_106_NRZ = 0x04,
+	DRV_CLRC663_PROTOCOL_TX_ISO_IEC_14443B_212_NRZ = 0x05,
+	DRV_CLRC663_PROTOCOL_TX_ISO_IEC_14443B_424_NRZ = 0x06,
+	DRV_CLRC663_PROTOCOL_TX_ISO_IEC_14443B_848_NRZ = 0x07,
+	DRV_CLRC663_PROTOCOL_TX_FELICA_212_MANCHESTER = 0x08,
+	DRV_CLRC663_PROTOCOL_TX_FELICA_424_MANCHESTER = 0x09,
+	DRV_CLRC663_PROTOCOL_TX_ISO_IEC_15693_1_OF_4_SSC = 0x0A,
+	DRV_CLRC663_PROTOCOL_TX_ISO_IEC_15693_1_OF_4_DSC = 0x0B,
+	DRV_CLRC663_PROTOCOL_TX_ISO_IEC_15693_1_OF_256_SSC = 0x0C,
+	DRV_CLRC663_PROTOCOL_TX_EPC_UID_UNITARY_SSC = 0x0D,
+	DRV_CLRC663_PROTOCOL_TX_ISO_IEC_18000_3_MODE_3 = 0x0E
+};
+
+enum {
+	/** Upper bound for commands which do not involve the RF interface */
+	DRV_CLRC663_CMD_TIMEOUT_US = 10000
+};
+
+/**
+ * Timers usable as a command timeout. Timer4 is left out, as it runs from the
+ * low-power oscillator and is reserved for LPCD wake-ups.
+ */
+enum drv_clrc663_timer {
+	DRV_CLRC663_TIMER_0,
+	DRV_CLRC663_TIMER_1,
+	DRV_CLRC663_TIMER_2,
+	DRV_CLRC663_TIMER_3
+};
+
+enum drv_clrc663_timer_start {
+	/** Started by the host through TControl */
+	DRV_CLRC663_TIMER_START_HOST = 0,
+
+	/** Started by the end of a transmission */
+	DRV_CLRC663_TIMER_START_TX_END = 1
+};
+
+/** Describes a command to execute; see drv_clrc663_exec(). */
+struct drv_clrc663_exec {
+	enum drv_clrc663_cmd cmd;
+
+	/**
+	 * The IRQ0 sources which end the command, e.g. IdleIRQ or RxIRQ.
+	 * ErrIRQ is always added.
+	 */
+	uint8_t irq0_en;
+
+	/** As above, for IRQ1. The interrupt of @ref timer is always added. */
+	uint8_t irq1_en;
+
+	/**
+	 * The time after which the command is considered to have failed, in
+	 * microseconds; at most 309 ms. 0 leaves the timer alone and only
+	 * applies DRV_CLRC663_CMD_TIMEOUT_US on the host side.
+	 */
+	uint32_t timeout_us;
+	enum drv_clrc663_timer timer;
+	enum drv_clrc663_timer_start timer_start;
 };
 
+enum drv_clrc663_exec_status {
+	DRV_CLRC663_EXEC_OK,
+
+	/** The command has not completed yet */
+	DRV_CLRC663_EXEC_PENDING,
+
+	/** The timer expired before the command completed */
+	DRV_CLRC663_EXEC_TIMEOUT,
+
+	/** The IRQ pin was never asserted; the host gave up */
+	DRV_CLRC663_EXEC_NO_IRQ,
+
+	/** A bit collision was detected */
+	DRV_CLRC663_EXEC_COLLISION,
+
+	/** A CRC or parity error was detected */
+	DRV_CLRC663_EXEC_INTEGRITY,
+
+	/** Start or end of frame were not as expected */
+	DRV_CLRC663_EXEC_PROTOCOL,
+
+	/** A frame shorter than the minimum length was received */
+	DRV_CLRC663_EXEC_MIN_FRAME,
+
+	/** Data was missing from the FIFO, or too much was written to it */
+	DRV_CLRC663_EXEC_FIFO,
+
+	/** The command was invalid or missing parameters */
+	DRV_CLRC663_EXEC_CMD,
+
+	/** The received data did not fit the caller's buffer */
+	DRV_CLRC663_EXEC_OVERFLOW
+};
+
+struct drv_clrc663_exec_result {
+	enum drv_clrc663_exec_status status;
+
+	/** The interrupt and Error registers as read at completion */
+	uint8_t irq0;
+	uint8_t irq1;
+	uint8_t error;
+};
+
+/**
+ * Starts the command described by @p exec: programs the interrupt enables,
+ * arms the timeout timer and writes the Command register. Any data the
+ * command needs must already be in the FIFO.
+ */
+void drv_clrc663_exec_start(const struct drv_clrc663_exec *exec);
+
+/**
+ * Checks on the command started by drv_clrc663_exec_start() without blocking.
+ *
+ * @returns DRV_CLRC663_EXEC_PENDING while the command is still running,
+ * otherwise its outcome, which is also stored in @p result.
+ */
+enum drv_clrc663_exec_status
+drv_clrc663_exec_poll(struct drv_clrc663_exec_result *result);
+
+/**
+ * Executes the command described by @p exec and waits for it to complete.
+ *
+ * @returns the outcome, which is also stored in @p result.
+ */
+enum drv_clrc663_exec_status
+drv_clrc663_exec(const struct drv_clrc663_exec *exec,
+		 struct drv_clrc663_exec_result *result);
+
+/**
+ * Describes a frame exchange; see drv_clrc663_transceive(). Both buffers are
+ * owned by the caller and accessed in place.
+ */
+struct drv_clrc663_transceive {
+	const uint8_t *tx;
+	size_t tx_size;
+
+	/** Valid bits in the last byte of @ref tx, 1 to 7; 0 sends all 8 */
+	uint8_t tx_last_bits;
+
+	/** Appends a CRC to the frame sent */
+	bool tx_crc;
+
+	/** Checks and strips the CRC of the frame received */
+	bool rx_crc;
+
+	uint8_t *rx;
+	size_t rx_size_max;
+
+	/**
+	 * Bit position at which the first bit received is stored in the first
+	 * byte of @ref rx, 0 to 7. The bits below it are not valid; the caller
+	 * merges them with what it sent. Used for anticollision, together with
+	 * @ref tx_last_bits.
+	 */
+	uint8_t rx_align;
+
+	/**
+	 * The time the card has to start responding after the end of the
+	 * transmission, in microseconds; at most 309 ms.
+	 */
+	uint32_t timeout_us;
+};
+
+struct drv_clrc663_transceive_result {
+	struct drv_clrc663_exec_result exec;
+
+	/** Bytes stored in the receive buffer, including a partial last one */
+	size_t rx_size;
+
+	/** Valid bits in the last byte received, 1 to 7; 0 if all 8 are */
+	uint8_t rx_last_bits;
+
+	/** Whether @ref coll_pos holds the position of a bit collision */
+	bool coll_pos_valid;
+
+	/**
+	 * Position of the first colliding bit, counted from bit 0 of the first
+	 * byte of the receive buffer, i.e. including @ref
+	 * drv_clrc663_transceive.rx_align.
+	 */
+	uint8_t coll_pos;
+};
+
+/**
+ * Sends the frame in @p xfer->tx and receives the response straight into
+ * @p xfer->rx, using Timer0 for the response timeout. Frames of any size are
+ * streamed through the FIFO, which is switched to 512 byte mode.
+ *
+ * Data received before a collision or integrity error is kept.
+ *
+ * @returns the outcome, which is also stored in @p result.
+ */
+enum drv_clrc663_exec_status
+drv_clrc663_transceive(const struct drv_clrc663_transceive *xfer,
+		       struct drv_clrc663_transceive_result *result);
+
 void drv_clrc663_cmd_Idle(void);
 void drv_clrc663_cmd_LPCD(void);
-void drv_clrc663_cmd_LoadKey(const uint8_t *key);
-void drv_clrc663_cmd_LoadProtocol(enum drv_clrc663_protocol_rx rx,
+
+/**
+ * The following commands wait for the CLRC663 to return to idle, signalled
+ * through the IRQ pin.
+ *
+ * @returns false if the command did not complete in time.
+ */
+bool drv_clrc663_cmd_LoadKey(const uint8_t *key);
+bool drv_clrc663_cmd_LoadKeyE2(uint8_t key_num);
+bool drv_clrc663_cmd_StoreKeyE2(uint8_t key_num, const uint8_t *key);
+bool drv_clrc663_cmd_LoadProtocol(enum drv_clrc663_protocol_rx rx,
 				  enum drv_clrc663_protocol_tx tx);
 
+/**
+ * Authenticates to @p block of a MIFARE Classic card with the key in the key
+ * buffer. @p auth is the card command telling key A from key B, and @p uid
+ * the 4 UID bytes the card authenticates with. Timer0 times each of the
+ * card's responses out after @p timeout_us.
+ *
+ * @returns DRV_CLRC663_EXEC_OK if Crypto1 is on afterwards; a rejected key
+ * shows as a timeout, as the card stops answering.
+ */
+enum drv_clrc663_exec_status drv_clrc663_cmd_MFAuthent(uint8_t auth,
+						       uint8_t block,
+						       const uint8_t *uid,
+						       uint32_t timeout_us);
+
+/** Ends the MIFARE Classic session, so that frames go out in plain again. */
+void drv_clrc663_crypto1_off(void);
+
 #endif // DRV_CLRC663_CMD_H
\ No newline at end of file
@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef CLRC663_IRQ_H
+#define CLRC663_IRQ_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Discards any IRQ pin activity seen so far. The pin is considered asserted
+ * right away if it already is.
+ */
+extern void drv_clrc663_irq_pin_arm(void);
+
+/**
+ * Waits for the IRQ pin to be asserted since the last
+ * drv_clrc663_irq_pin_arm().
+ *
+ * @returns false if this did not happen within @p timeout_us.
+ */
+extern bool drv_clrc663_irq_pin_wait(uint32_t timeout_us);
+
+/**
+ * Whether the IRQ pin has been asserted since the last
+ * drv_clrc663_irq_pin_arm(), without waiting for it.
+ */
+extern bool drv_clrc663_irq_pin_asserted(void);
+
+#endif // CLRC663_IRQ_H
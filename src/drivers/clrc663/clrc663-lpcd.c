@@ -0,0 +1,196 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "clrc663.h"
+#include "clrc663-cmd.h"
+#include "clrc663-irq.h"
+#include "clrc663-lpcd.h"
+
+enum {
+	LFO_HZ = 16000,
+	T4_TICKS_MAX = UINT16_MAX,
+
+	// Field-on time of a measurement, counted by T3 at 13.56 MHz. Long
+	// enough for the antenna to settle, short enough to keep the average
+	// current low.
+	T3_FIELD_ON_TICKS = 0x0100,
+
+	// T4 reload of a one-off measurement, which starts right away
+	MEASURE_T4_TICKS = 1,
+
+	// Receiver settings for LPCD recommended by NXP in AN11145: the ADC
+	// is used directly, at the highest gain.
+	LPCD_Rcv = UINT8_C(0x52),
+	LPCD_RxAna = UINT8_C(0x03),
+
+	// The field is driven with the transmitter clock for a measurement.
+	LPCD_DrvMode = UINT8_C(0x89)
+};
+
+static void window_set(const struct drv_clrc663_lpcd_window *const window)
+{
+	const uint8_t i_max = window->max.i & DRV_CLRC663_LPCD_MASK_Value;
+
+	const uint8_t QMin = drv_clrc663_field_set(
+		window->min.q & DRV_CLRC663_LPCD_MASK_Value,
+		DRV_CLRC663_LPCD_MASK_IMaxPart,
+		DRV_CLRC663_LPCD_SHIFT_IMaxPart, i_max >> 4);
+
+	const uint8_t QMax = drv_clrc663_field_set(
+		window->max.q & DRV_CLRC663_LPCD_MASK_Value,
+		DRV_CLRC663_LPCD_MASK_IMaxPart,
+		DRV_CLRC663_LPCD_SHIFT_IMaxPart, i_max >> 2);
+
+	const uint8_t IMin = drv_clrc663_field_set(
+		window->min.i & DRV_CLRC663_LPCD_MASK_Value,
+		DRV_CLRC663_LPCD_MASK_IMaxPart,
+		DRV_CLRC663_LPCD_SHIFT_IMaxPart, i_max >> 0);
+
+	drv_clrc663_reg_write(DRV_CLRC663_REG_LPCD_QMin, QMin);
+	drv_clrc663_reg_write(DRV_CLRC663_REG_LPCD_QMax, QMax);
+	drv_clrc663_reg_write(DRV_CLRC663_REG_LPCD_IMin, IMin);
+}
+
+static void prepare(const struct drv_clrc663_lpcd_window *const window,
+		    const uint32_t t4_ticks, const uint8_t t4_mode)
+{
+	drv_clrc663_cmd_Idle();
+
+	window_set(window);
+
+	drv_clrc663_reg_write(DRV_CLRC663_REG_T3Control,
+			      drv_clrc663_field_set(
+				      0, DRV_CLRC663_TxControl_MASK_TClk,
+				      DRV_CLRC663_TxControl_SHIFT_TClk,
+				      DRV_CLRC663_TIMER_CLK_13_56_MHZ));
+
+	drv_clrc663_reg_write(DRV_CLRC663_REG_T3ReloadHi,
+			      T3_FIELD_ON_TICKS >> 8);
+	drv_clrc663_reg_write(DRV_CLRC663_REG_T3ReloadLo,
+			      T3_FIELD_ON_TICKS & 0xFF);
+
+	drv_clrc663_reg_write(DRV_CLRC663_REG_T4ReloadHi, t4_ticks >> 8);
+	drv_clrc663_reg_write(DRV_CLRC663_REG_T4ReloadLo, t4_ticks & 0xFF);
+
+	drv_clrc663_reg_write(DRV_CLRC663_REG_Rcv, LPCD_Rcv);
+	drv_clrc663_reg_write(DRV_CLRC663_REG_RxAna, LPCD_RxAna);
+	drv_clrc663_reg_write(DRV_CLRC663_REG_DrvMode, LPCD_DrvMode);
+
+	drv_clrc663_reg_write(DRV_CLRC663_REG_LPCD_Q_Result,
+			      DRV_CLRC663_LPCD_Q_Result_LPCDIrqClr);
+
+	const uint8_t mode = t4_mode | DRV_CLRC663_T4Control_T4AutoTrimm |
+			     DRV_CLRC663_T4Control_T4AutoLPCD |
+			     DRV_CLRC663_T4Control_T4StartStopNow |
+			     DRV_CLRC663_T4Control_T4Running;
+
+	const uint8_t T4Control = drv_clrc663_field_set(
+		mode, DRV_CLRC663_T4Control_MASK_T4Clk,
+		DRV_CLRC663_T4Control_SHIFT_T4Clk, DRV_CLRC663_T4_CLK_LFO);
+
+	drv_clrc663_reg_write(DRV_CLRC663_REG_T4Control, T4Control);
+}
+
+static void t4_stop(void)
+{
+	drv_clrc663_reg_write(DRV_CLRC663_REG_T4Control,
+			      DRV_CLRC663_T4Control_T4StartStopNow);
+}
+
+bool drv_clrc663_lpcd_measure(struct drv_clrc663_lpcd_iq *const iq)
+{
+	// A window spanning every possible value never triggers, so the
+	// command simply ends after one measurement.
+	const struct drv_clrc663_lpcd_window open = {
+		.min = { .i = 0, .q = 0 },
+		.max = { .i = DRV_CLRC663_LPCD_MASK_Value,
+			 .q = DRV_CLRC663_LPCD_MASK_Value }
+	};
+
+	prepare(&open, MEASURE_T4_TICKS, 0);
+
+	const struct drv_clrc663_exec exec = {
+		// clang-format off
+
+		.cmd		= DRV_CLRC663_CMD_LPCD,
+		.irq0_en	= DRV_CLRC663_IRQ0_IdleIRQ,
+		.irq1_en	= DRV_CLRC663_IRQ1_LPCD_IRQ,
+		.timeout_us	= 0
+
+		// clang-format on
+	};
+
+	struct drv_clrc663_exec_result result;
+	const enum drv_clrc663_exec_status status =
+		drv_clrc663_exec(&exec, &result);
+
+	t4_stop();
+
+	iq->i = drv_clrc663_reg_read(DRV_CLRC663_REG_LPCD_I_Result) &
+		DRV_CLRC663_LPCD_MASK_Value;
+	iq->q = drv_clrc663_reg_read(DRV_CLRC663_REG_LPCD_Q_Result) &
+		DRV_CLRC663_LPCD_MASK_Value;
+
+	drv_clrc663_reg_write(DRV_CLRC663_REG_DrvMode, 0);
+
+	return status == DRV_CLRC663_EXEC_OK;
+}
+
+void drv_clrc663_lpcd_start(const struct drv_clrc663_lpcd_window *const window,
+			    const uint32_t period_ms)
+{
+	uint32_t ticks = (period_ms * LFO_HZ) / 1000;
+
+	if (ticks > T4_TICKS_MAX)
+		ticks = T4_TICKS_MAX;
+
+	prepare(window, ticks,
+		DRV_CLRC663_T4Control_T4AutoRestart |
+			DRV_CLRC663_T4Control_T4AutoWakeUp);
+
+	drv_clrc663_irq_arm(0, DRV_CLRC663_IRQ1_LPCD_IRQ);
+
+	drv_clrc663_reg_write(DRV_CLRC663_REG_Command,
+			      DRV_CLRC663_Command_Standby |
+				      DRV_CLRC663_CMD_LPCD);
+}
+
+bool drv_clrc663_lpcd_triggered(void)
+{
+	if (!drv_clrc663_irq_pin_asserted())
+		return false;
+
+	return drv_clrc663_reg_read(DRV_CLRC663_REG_IRQ1) &
+	       DRV_CLRC663_IRQ1_LPCD_IRQ;
+}
+
+void drv_clrc663_lpcd_stop(void)
+{
+	// Any register access wakes the CLRC663 from standby; Idle without
+	// the Standby bit keeps it awake.
+	drv_clrc663_cmd_Idle();
+	t4_stop();
+
+	drv_clrc663_reg_write(DRV_CLRC663_REG_LPCD_Q_Result,
+			      DRV_CLRC663_LPCD_Q_Result_LPCDIrqClr);
+	drv_clrc663_reg_write(DRV_CLRC663_REG_DrvMode, 0);
+}
@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef CLRC663_LPCD_H
+#define CLRC663_LPCD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** I and Q channel values of an LPCD measurement, 0 to 63 each */
+struct drv_clrc663_lpcd_iq {
+	uint8_t i;
+	uint8_t q;
+};
+
+/**
+ * The range of I and Q values considered an empty field; a measurement
+ * outside of it raises the LPCD interrupt.
+ */
+struct drv_clrc663_lpcd_window {
+	struct drv_clrc663_lpcd_iq min;
+	struct drv_clrc663_lpcd_iq max;
+};
+
+/**
+ * Runs a single LPCD measurement, switching the field on for a few
+ * microseconds, and returns its result in @p iq.
+ *
+ * @returns false if the measurement did not complete.
+ */
+bool drv_clrc663_lpcd_measure(struct drv_clrc663_lpcd_iq *iq);
+
+/**
+ * Puts the CLRC663 into standby, from which T4 wakes it every @p period_ms to
+ * measure. The IRQ pin is asserted once a measurement falls outside of
+ * @p window; see drv_clrc663_lpcd_triggered().
+ */
+void drv_clrc663_lpcd_start(const struct drv_clrc663_lpcd_window *window,
+			    uint32_t period_ms);
+
+/**
+ * Whether LPCD started by drv_clrc663_lpcd_start() has detected a change of
+ * the antenna load. Only accesses the CLRC663 once the IRQ pin has been
+ * asserted, so that it can be called as often as needed.
+ */
+bool drv_clrc663_lpcd_triggered(void);
+
+/** Stops LPCD and wakes the CLRC663 from standby. */
+void drv_clrc663_lpcd_stop(void);
+
+#endif // CLRC663_LPCD_H
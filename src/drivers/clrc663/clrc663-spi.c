@@ -24,15 +24,16 @@
 #include "clrc663-spi.h"
 
 enum {
-	REG_WRITE,
-	REG_READ,
 	DUMMY_BYTE = UINT8_C(0xDB),
+
+	// Terminates a read sequence; any address byte would start a new read.
+	READ_END_BYTE = UINT8_C(0x00)
 };
 
 uint8_t drv_clrc663_reg_read(const enum drv_clrc663_reg reg)
 {
 	const uint8_t tx[] = {
-		[0] = (reg << 1) | REG_READ,
+		[0] = drv_clrc663_spi_addr_read(reg),
 		[1] = DUMMY_BYTE,
 	};
 
@@ -48,11 +49,49 @@ uint8_t drv_clrc663_reg_read(const enum drv_clrc663_reg reg)
 void drv_clrc663_reg_write(const enum drv_clrc663_reg reg, const uint8_t val)
 {
 	const uint8_t tx[] = {
-		[0] = (reg << 1) | REG_WRITE,
+		[0] = drv_clrc663_spi_addr_write(reg),
 		[1] = val,
 	};
 
 	drv_clrc663_nss_pin_set_low();
 	drv_clrc663_spi_tx_blocking(tx, 2);
 	drv_clrc663_nss_pin_set_high();
-}
\ No newline at end of file
+}
+
+void drv_clrc663_reg_read_burst(const enum drv_clrc663_reg reg,
+				uint8_t *const dst, const size_t size)
+{
+	if (!size)
+		return;
+
+	// As long as NSS stays low, the CLRC663 answers every address byte
+	// with the contents of the register addressed by the previous one.
+	// Repeating the address of FIFOData therefore streams it out at one
+	// byte per frame rather than two, plus a framing NSS toggle per byte.
+	const uint8_t addr = drv_clrc663_spi_addr_read(reg);
+	uint8_t discard;
+
+	drv_clrc663_nss_pin_set_low();
+	drv_clrc663_spi_tx_rx_blocking(&addr, &discard, 1);
+	drv_clrc663_spi_rx_fill_blocking(addr, dst, size - 1);
+
+	const uint8_t end = READ_END_BYTE;
+	drv_clrc663_spi_tx_rx_blocking(&end, &dst[size - 1], 1);
+	drv_clrc663_nss_pin_set_high();
+}
+
+void drv_clrc663_reg_write_burst(const enum drv_clrc663_reg reg,
+				 const uint8_t *const src, const size_t size)
+{
+	if (!size)
+		return;
+
+	// Every byte following the address byte within one NSS frame is written
+	// to the same register.
+	const uint8_t addr = drv_clrc663_spi_addr_write(reg);
+
+	drv_clrc663_nss_pin_set_low();
+	drv_clrc663_spi_tx_blocking(&addr, 1);
+	drv_clrc663_spi_tx_blocking(src, size);
+	drv_clrc663_nss_pin_set_high();
+}
@@ -31,4 +31,10 @@ extern void drv_clrc663_spi_tx_blocking(const uint8_t *src, size_t src_size);
 extern void drv_clrc663_spi_tx_rx_blocking(const uint8_t *src, uint8_t *dst,
 					   size_t size);
 
+/**
+ * Receives @p size bytes into @p dst, transmitting @p fill for every byte.
+ */
+extern void drv_clrc663_spi_rx_fill_blocking(uint8_t fill, uint8_t *dst,
+					     size_t size);
+
 #endif // CLRC663_SPI_H
\ No newline at end of file
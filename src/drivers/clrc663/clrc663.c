@@ -21,6 +21,26 @@
 // SOFTWARE.
 
 #include "clrc663.h"
+#include "clrc663-irq.h"
+
+enum {
+	// Writing a 0 to the Set bit together with a source bit clears that
+	// source.
+	IRQ_CLEAR_ALL = UINT8_C(0x7F)
+};
+
+void drv_clrc663_irq_arm(const uint8_t irq0_en, const uint8_t irq1_en)
+{
+	drv_clrc663_reg_write(DRV_CLRC663_REG_IRQ0En, irq0_en);
+	drv_clrc663_reg_write(DRV_CLRC663_REG_IRQ1En,
+			      irq1_en | DRV_CLRC663_IRQ1En_IRQ_PushPull |
+				      DRV_CLRC663_IRQ1En_IRQ_PINEN);
+
+	drv_clrc663_reg_write(DRV_CLRC663_REG_IRQ0, IRQ_CLEAR_ALL);
+	drv_clrc663_reg_write(DRV_CLRC663_REG_IRQ1, IRQ_CLEAR_ALL);
+
+	drv_clrc663_irq_pin_arm();
+}
 
 void drv_clrc663_fifo_flush(void)
 {
@@ -47,14 +67,12 @@ void drv_clrc663_fifo_mode_set(const enum drv_clrc663_fifo_mode fifo_mode)
 
 void drv_clrc663_fifo_write(const uint8_t *const src, const size_t size)
 {
-	for (size_t i = 0; i < size; ++i)
-		drv_clrc663_reg_write(DRV_CLRC663_REG_FIFOData, src[i]);
+	drv_clrc663_reg_write_burst(DRV_CLRC663_REG_FIFOData, src, size);
 }
 
 void drv_clrc663_fifo_read(uint8_t *const dst, const size_t size)
 {
-	for (size_t i = 0; i < size; ++i)
-		dst[i] = drv_clrc663_reg_read(DRV_CLRC663_REG_FIFOData);
+	drv_clrc663_reg_read_burst(DRV_CLRC663_REG_FIFOData, dst, size);
 }
 
 size_t drv_clrc663_fifo_size(void)
@@ -23,6 +23,7 @@
 #ifndef DRV_CLRC663_H
 #define DRV_CLRC663_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -37,9 +38,156 @@ enum {
 	DRV_CLRC663_FIFOControl_SHIFT_FIFOLengthExtBits = 0
 };
 
+enum {
+	DRV_CLRC663_IRQ0_Set = UINT8_C(1) << 7,
+	DRV_CLRC663_IRQ0_HiAlertIRQ = UINT8_C(1) << 6,
+	DRV_CLRC663_IRQ0_LoAlertIRQ = UINT8_C(1) << 5,
+	DRV_CLRC663_IRQ0_IdleIRQ = UINT8_C(1) << 4,
+	DRV_CLRC663_IRQ0_TxIRQ = UINT8_C(1) << 3,
+	DRV_CLRC663_IRQ0_RxIRQ = UINT8_C(1) << 2,
+	DRV_CLRC663_IRQ0_ErrIRQ = UINT8_C(1) << 1,
+	DRV_CLRC663_IRQ0_RxSOFIRQ = UINT8_C(1) << 0,
+
+	DRV_CLRC663_IRQ1_Set = UINT8_C(1) << 7,
+	DRV_CLRC663_IRQ1_GlobalIRQ = UINT8_C(1) << 6,
+	DRV_CLRC663_IRQ1_LPCD_IRQ = UINT8_C(1) << 5,
+	DRV_CLRC663_IRQ1_Timer4IRQ = UINT8_C(1) << 4,
+	DRV_CLRC663_IRQ1_Timer3IRQ = UINT8_C(1) << 3,
+	DRV_CLRC663_IRQ1_Timer2IRQ = UINT8_C(1) << 2,
+	DRV_CLRC663_IRQ1_Timer1IRQ = UINT8_C(1) << 1,
+	DRV_CLRC663_IRQ1_Timer0IRQ = UINT8_C(1) << 0,
+
+	/** Inverts the IRQ pin, making it active low */
+	DRV_CLRC663_IRQ0En_IRQ_Inv = UINT8_C(1) << 7,
+
+	/** Drives the IRQ pin push-pull instead of open drain */
+	DRV_CLRC663_IRQ1En_IRQ_PushPull = UINT8_C(1) << 7,
+
+	/** Routes the global interrupt to the IRQ pin */
+	DRV_CLRC663_IRQ1En_IRQ_PINEN = UINT8_C(1) << 6
+};
+
+enum {
+	DRV_CLRC663_Error_CmdErr = UINT8_C(1) << 7,
+	DRV_CLRC663_Error_FIFOWrErr = UINT8_C(1) << 6,
+	DRV_CLRC663_Error_FIFOOvl = UINT8_C(1) << 5,
+	DRV_CLRC663_Error_MinFrameErr = UINT8_C(1) << 4,
+	DRV_CLRC663_Error_NoDataErr = UINT8_C(1) << 3,
+	DRV_CLRC663_Error_CollDet = UINT8_C(1) << 2,
+	DRV_CLRC663_Error_ProtErr = UINT8_C(1) << 1,
+	DRV_CLRC663_Error_IntegErr = UINT8_C(1) << 0
+};
+
+enum {
+	/** Starts (with TxRunning) or stops (without) timer x, T0 at bit 4 */
+	DRV_CLRC663_TControl_TxStartStopNow = UINT8_C(1) << 4,
+
+	/** Set while timer x is running, T0 at bit 0 */
+	DRV_CLRC663_TControl_TxRunning = UINT8_C(1) << 0,
+
+	/** Stops the timer when the receiver detects the start of a frame */
+	DRV_CLRC663_TxControl_TStopRx = UINT8_C(1) << 7,
+	DRV_CLRC663_TxControl_MASK_TStart = (UINT8_C(1) << 5) |
+					    (UINT8_C(1) << 4),
+	DRV_CLRC663_TxControl_TAutoRestart = UINT8_C(1) << 3,
+	DRV_CLRC663_TxControl_MASK_TClk = (UINT8_C(1) << 1) | (UINT8_C(1) << 0),
+
+	DRV_CLRC663_TxControl_SHIFT_TStart = 4,
+	DRV_CLRC663_TxControl_SHIFT_TClk = 0
+};
+
+enum {
+	DRV_CLRC663_TxCrcPreset_TxCRCEn = UINT8_C(1) << 0,
+	DRV_CLRC663_RxCrcPreset_RxCRCEn = UINT8_C(1) << 0,
+
+	/** Enables transmission of the FIFO data; cleared, only EOF is sent */
+	DRV_CLRC663_TxDataNum_DataEn = UINT8_C(1) << 3,
+	DRV_CLRC663_TxDataNum_MASK_TxLastBits = (UINT8_C(1) << 2) |
+						(UINT8_C(1) << 1) |
+						(UINT8_C(1) << 0),
+
+	DRV_CLRC663_TxDataNum_SHIFT_TxLastBits = 0,
+
+	DRV_CLRC663_RxBitCtrl_ValuesAfterColl = UINT8_C(1) << 7,
+	DRV_CLRC663_RxBitCtrl_MASK_RxAlign = (UINT8_C(1) << 6) |
+					     (UINT8_C(1) << 5) |
+					     (UINT8_C(1) << 4),
+	DRV_CLRC663_RxBitCtrl_NoColl = UINT8_C(1) << 3,
+	DRV_CLRC663_RxBitCtrl_MASK_RxLastBits = (UINT8_C(1) << 2) |
+						(UINT8_C(1) << 1) |
+						(UINT8_C(1) << 0),
+
+	DRV_CLRC663_RxBitCtrl_SHIFT_RxAlign = 4,
+	DRV_CLRC663_RxBitCtrl_SHIFT_RxLastBits = 0,
+
+	DRV_CLRC663_RxColl_CollPosValid = UINT8_C(1) << 7,
+	DRV_CLRC663_RxColl_MASK_CollPos = UINT8_C(0x7F),
+
+	DRV_CLRC663_RxColl_SHIFT_CollPos = 0
+};
+
+enum {
+	/**
+	 * Set by a successful MFAuthent, after which all frames are encrypted;
+	 * cleared by the host to end the MIFARE Classic session
+	 */
+	DRV_CLRC663_Status_Crypto1On = UINT8_C(1) << 5
+};
+
+enum {
+	/** Puts the CLRC663 into standby along with the command written */
+	DRV_CLRC663_Command_Standby = UINT8_C(1) << 7,
+
+	DRV_CLRC663_T4Control_T4Running = UINT8_C(1) << 7,
+	DRV_CLRC663_T4Control_T4StartStopNow = UINT8_C(1) << 6,
+
+	/** Trims the LFO against the crystal before every LPCD run */
+	DRV_CLRC663_T4Control_T4AutoTrimm = UINT8_C(1) << 5,
+
+	/** Starts an LPCD measurement whenever T4 underflows */
+	DRV_CLRC663_T4Control_T4AutoLPCD = UINT8_C(1) << 4,
+	DRV_CLRC663_T4Control_T4AutoRestart = UINT8_C(1) << 3,
+
+	/** Wakes the CLRC663 from standby when T4 underflows */
+	DRV_CLRC663_T4Control_T4AutoWakeUp = UINT8_C(1) << 2,
+	DRV_CLRC663_T4Control_MASK_T4Clk = (UINT8_C(1) << 1) |
+					   (UINT8_C(1) << 0),
+
+	DRV_CLRC663_T4Control_SHIFT_T4Clk = 0,
+
+	/** I and Q thresholds and results are 6 bits wide */
+	DRV_CLRC663_LPCD_MASK_Value = UINT8_C(0x3F),
+
+	/**
+	 * The IMax threshold is spread over the top two bits of QMin (bits
+	 * 5:4), QMax (bits 3:2) and IMin (bits 1:0).
+	 */
+	DRV_CLRC663_LPCD_MASK_IMaxPart = (UINT8_C(1) << 7) | (UINT8_C(1) << 6),
+	DRV_CLRC663_LPCD_SHIFT_IMaxPart = 6,
+
+	/** Clears the LPCD interrupt */
+	DRV_CLRC663_LPCD_Q_Result_LPCDIrqClr = UINT8_C(1) << 6
+};
+
+enum drv_clrc663_t4_clk {
+	/** The low-frequency oscillator, nominally 16 kHz */
+	DRV_CLRC663_T4_CLK_LFO = 0
+};
+
+enum drv_clrc663_timer_clk {
+	DRV_CLRC663_TIMER_CLK_13_56_MHZ = 0,
+	DRV_CLRC663_TIMER_CLK_211_875_KHZ = 1
+};
+
 enum {
 	DRV_CLRC663_FIFO_NUM_BYTES_MAX = 512,
-	DRV_CLRC663_MIFARE_CLASSIC_KEY_NUM_BYTES = 6
+	DRV_CLRC663_MIFARE_CLASSIC_KEY_NUM_BYTES = 6,
+
+	/** The UID bytes MFAuthent takes */
+	DRV_CLRC663_MIFARE_CLASSIC_UID_NUM_BYTES = 4,
+
+	/** MIFARE Classic keys the EEPROM has room for */
+	DRV_CLRC663_KEY_E2_NUM = 128
 };
 
 enum drv_clrc663_fifo_mode {
@@ -354,6 +502,13 @@ enum drv_clrc663_reg {
 	DRV_CLRC663_REG_Version = UINT8_C(0x7F)
 };
 
+/**
+ * Routes the interrupt sources in @p irq0_en and @p irq1_en to the IRQ pin,
+ * clears all pending interrupts and arms the host side of the pin. Call this
+ * before starting the command to wait for.
+ */
+void drv_clrc663_irq_arm(uint8_t irq0_en, uint8_t irq1_en);
+
 void drv_clrc663_fifo_flush(void);
 void drv_clrc663_fifo_mode_set(enum drv_clrc663_fifo_mode fifo_mode);
 void drv_clrc663_fifo_write(const uint8_t *src, size_t size);
@@ -375,7 +530,32 @@ static inline uint8_t drv_clrc663_field_set(const uint8_t dst,
 	return (dst & ~mask) | ((val << shift) & mask);
 }
 
+/** Returns the SPI address byte which starts a read of @p reg. */
+static inline uint8_t drv_clrc663_spi_addr_read(const enum drv_clrc663_reg reg)
+{
+	return (reg << 1) | UINT8_C(1);
+}
+
+/** Returns the SPI address byte which starts a write to @p reg. */
+static inline uint8_t drv_clrc663_spi_addr_write(const enum drv_clrc663_reg reg)
+{
+	return reg << 1;
+}
+
 extern uint8_t drv_clrc663_reg_read(enum drv_clrc663_reg reg);
 extern void drv_clrc663_reg_write(enum drv_clrc663_reg reg, uint8_t val);
 
+/**
+ * Reads @p size consecutive values of the same register within one NSS frame.
+ */
+extern void drv_clrc663_reg_read_burst(enum drv_clrc663_reg reg, uint8_t *dst,
+				       size_t size);
+
+/**
+ * Writes @p size consecutive values to the same register within one NSS
+ * frame.
+ */
+extern void drv_clrc663_reg_write_burst(enum drv_clrc663_reg reg,
+					const uint8_t *src, size_t size);
+
 #endif // DRV_CLRC663_H
\ No newline at end of file
@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "common/compiler.h"
+#include "common/types.h"
+#include "sysctl.h"
+#include "util.h"
+
+enum dwt_reg {
+	DWT_REG_DEMCR = 0xE000EDFC,
+	DWT_REG_CTRL = 0xE0001000,
+	DWT_REG_CYCCNT = 0xE0001004
+};
+
+enum {
+	DEMCR_TRCENA = BIT_24,
+	DWT_CTRL_CYCCNTENA = BIT_0
+};
+
+/** Starts the free-running core cycle counter of the data watchpoint unit. */
+ALWAYS_INLINE void dwt_cyccnt_init(void)
+{
+	mmio_set32(DWT_REG_DEMCR, DEMCR_TRCENA);
+	mmio_write32(DWT_REG_CYCCNT, 0);
+	mmio_set32(DWT_REG_CTRL, DWT_CTRL_CYCCNTENA);
+}
+
+ALWAYS_INLINE u32 dwt_cyccnt_read(void)
+{
+	return mmio_read32(DWT_REG_CYCCNT);
+}
+
+ALWAYS_INLINE u32 dwt_cycles_to_us(const u32 cycles)
+{
+	return cycles / (SYSCTL_CCLK_HZ / mhz_to_hz(1));
+}
@@ -0,0 +1,192 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stddef.h>
+
+#include "gpdma.h"
+#include "nvic.h"
+#include "sysctl.h"
+#include "util.h"
+
+enum gpdma_reg {
+	GPDMA_REG_DMACIntStat = 0x50004000,
+	GPDMA_REG_DMACIntTCStat = 0x50004004,
+	GPDMA_REG_DMACIntTCClear = 0x50004008,
+	GPDMA_REG_DMACIntErrStat = 0x5000400C,
+	GPDMA_REG_DMACIntErrClr = 0x50004010,
+	GPDMA_REG_DMACEnbldChns = 0x5000401C,
+	GPDMA_REG_DMACConfig = 0x50004030
+};
+
+enum {
+	GPDMA_CH_BASE_ADDR = 0x50004100,
+	GPDMA_CH_STRIDE = 0x20
+};
+
+enum gpdma_ch_reg {
+	GPDMA_CH_REG_SrcAddr = 0x0,
+	GPDMA_CH_REG_DestAddr = 0x4,
+	GPDMA_CH_REG_LLI = 0x8,
+	GPDMA_CH_REG_Control = 0xC,
+	GPDMA_CH_REG_Config = 0x10
+};
+
+enum {
+	DMACConfig_E = BIT_0,
+};
+
+enum {
+	Control_MASK_TransferSize = BITMASK_FROM_RANGE(0, 11),
+	Control_MASK_SBSize = BITMASK_FROM_RANGE(12, 14),
+	Control_MASK_DBSize = BITMASK_FROM_RANGE(15, 17),
+	Control_MASK_SWidth = BITMASK_FROM_RANGE(18, 20),
+	Control_MASK_DWidth = BITMASK_FROM_RANGE(21, 23),
+	Control_SI = BIT_26,
+	Control_DI = BIT_27,
+	Control_I = BIT_31
+};
+
+enum {
+	Config_E = BIT_0,
+	Config_MASK_SrcPeripheral = BITMASK_FROM_RANGE(1, 5),
+	Config_MASK_DestPeripheral = BITMASK_FROM_RANGE(6, 10),
+	Config_MASK_TransferType = BITMASK_FROM_RANGE(11, 13),
+	Config_IE = BIT_14,
+	Config_ITC = BIT_15,
+	Config_A = BIT_17,
+	Config_H = BIT_18
+};
+
+static struct {
+	gpdma_done_cb cb;
+	void *ctx;
+} gpdma_ch[GPDMA_CHANNEL_NUM];
+
+ALWAYS_INLINE uintptr_t ch_reg(const enum gpdma_channel ch,
+			       const enum gpdma_ch_reg reg)
+{
+	return GPDMA_CH_BASE_ADDR + (ch * GPDMA_CH_STRIDE) + reg;
+}
+
+void isr_GPDMA(void)
+{
+	const u32 DMACIntTCStat = mmio_read32(GPDMA_REG_DMACIntTCStat);
+	const u32 DMACIntErrStat = mmio_read32(GPDMA_REG_DMACIntErrStat);
+
+	mmio_write32(GPDMA_REG_DMACIntTCClear, DMACIntTCStat);
+	mmio_write32(GPDMA_REG_DMACIntErrClr, DMACIntErrStat);
+
+	for (u32 ch = 0; ch < GPDMA_CHANNEL_NUM; ++ch) {
+		const u32 bit = UINT32_C(1) << ch;
+
+		if (!((DMACIntTCStat | DMACIntErrStat) & bit))
+			continue;
+
+		if (gpdma_ch[ch].cb)
+			gpdma_ch[ch].cb(ch, DMACIntErrStat & bit,
+					gpdma_ch[ch].ctx);
+	}
+}
+
+void gpdma_init(void)
+{
+	sysctl_peripheral_power_enable(SYSCTL_PCONP_BIT_PCGPDMA);
+
+	mmio_write32(GPDMA_REG_DMACIntTCClear, 0xFF);
+	mmio_write32(GPDMA_REG_DMACIntErrClr, 0xFF);
+
+	// Little-endian AHB master, request synchronization left enabled.
+	mmio_write32(GPDMA_REG_DMACConfig, DMACConfig_E);
+
+	while (!(mmio_read32(GPDMA_REG_DMACConfig) & DMACConfig_E))
+		nop();
+
+	nvic_irq_enable(NVIC_IRQ_GPDMA);
+}
+
+u32 gpdma_lli_ctrl(const struct gpdma_xfer_cfg *const cfg, const u32 size,
+		   const bool src_inc, const bool dst_inc, const bool irq)
+{
+	app_assert(size <= GPDMA_XFER_SIZE_MAX);
+
+	u32 Control = 0;
+	set_val_by_mask(Control, Control_MASK_TransferSize, size);
+	set_val_by_mask(Control, Control_MASK_SBSize, cfg->burst);
+	set_val_by_mask(Control, Control_MASK_DBSize, cfg->burst);
+	set_val_by_mask(Control, Control_MASK_SWidth, cfg->width);
+	set_val_by_mask(Control, Control_MASK_DWidth, cfg->width);
+
+	if (src_inc)
+		Control |= Control_SI;
+
+	if (dst_inc)
+		Control |= Control_DI;
+
+	if (irq)
+		Control |= Control_I;
+
+	return Control;
+}
+
+void gpdma_channel_start(const enum gpdma_channel ch,
+			 const struct gpdma_xfer_cfg *const cfg,
+			 const struct gpdma_lli *const lli,
+			 const gpdma_done_cb cb, void *const ctx)
+{
+	app_assert(!gpdma_channel_busy(ch));
+
+	gpdma_ch[ch].cb = cb;
+	gpdma_ch[ch].ctx = ctx;
+
+	const u32 bit = UINT32_C(1) << ch;
+	mmio_write32(GPDMA_REG_DMACIntTCClear, bit);
+	mmio_write32(GPDMA_REG_DMACIntErrClr, bit);
+
+	mmio_write32(ch_reg(ch, GPDMA_CH_REG_SrcAddr), lli->src);
+	mmio_write32(ch_reg(ch, GPDMA_CH_REG_DestAddr), lli->dst);
+	mmio_write32(ch_reg(ch, GPDMA_CH_REG_LLI), lli->next);
+	mmio_write32(ch_reg(ch, GPDMA_CH_REG_Control), lli->ctrl);
+
+	u32 Config = Config_E | Config_IE | Config_ITC;
+	set_val_by_mask(Config, Config_MASK_SrcPeripheral, cfg->src_periph);
+	set_val_by_mask(Config, Config_MASK_DestPeripheral, cfg->dst_periph);
+	set_val_by_mask(Config, Config_MASK_TransferType, cfg->type);
+	mmio_write32(ch_reg(ch, GPDMA_CH_REG_Config), Config);
+}
+
+void gpdma_channel_stop(const enum gpdma_channel ch)
+{
+	// Halt the channel first so that any data still in the channel FIFO is
+	// not lost, then wait for it to drain before disabling it.
+	mmio_set32(ch_reg(ch, GPDMA_CH_REG_Config), Config_H);
+
+	while (gpdma_channel_busy(ch) &&
+	       (mmio_read32(ch_reg(ch, GPDMA_CH_REG_Config)) & Config_A))
+		nop();
+
+	mmio_clr32(ch_reg(ch, GPDMA_CH_REG_Config), Config_E);
+}
+
+bool gpdma_channel_busy(const enum gpdma_channel ch)
+{
+	return mmio_read32(GPDMA_REG_DMACEnbldChns) & (UINT32_C(1) << ch);
+}
@@ -0,0 +1,147 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "common/compiler.h"
+#include "common/types.h"
+
+// The GPDMA can only reach the AHB SRAM banks and the peripherals; it has no
+// access to the local SRAM at 0x10000000. Anything the controller reads or
+// writes (buffers and linked list items alike) must be placed in this section.
+#define GPDMA_MEM PLACE_IN_SECTION(".dma_ram")
+
+enum {
+	GPDMA_AHB_SRAM_BASE_ADDR = 0x2007C000,
+	GPDMA_AHB_SRAM_SIZE = 0x8000,
+	GPDMA_FLASH_SIZE = 0x80000
+};
+
+enum gpdma_channel {
+	GPDMA_CHANNEL_0,
+	GPDMA_CHANNEL_1,
+	GPDMA_CHANNEL_2,
+	GPDMA_CHANNEL_3,
+	GPDMA_CHANNEL_4,
+	GPDMA_CHANNEL_5,
+	GPDMA_CHANNEL_6,
+	GPDMA_CHANNEL_7,
+	GPDMA_CHANNEL_NUM
+};
+
+enum gpdma_periph {
+	GPDMA_PERIPH_SSP0_TX = 0,
+	GPDMA_PERIPH_SSP0_RX = 1,
+	GPDMA_PERIPH_SSP1_TX = 2,
+	GPDMA_PERIPH_SSP1_RX = 3
+};
+
+enum gpdma_xfer_type {
+	GPDMA_XFER_TYPE_M2M,
+	GPDMA_XFER_TYPE_M2P,
+	GPDMA_XFER_TYPE_P2M
+};
+
+enum gpdma_burst {
+	GPDMA_BURST_1,
+	GPDMA_BURST_4,
+	GPDMA_BURST_8,
+	GPDMA_BURST_16,
+	GPDMA_BURST_32,
+	GPDMA_BURST_64,
+	GPDMA_BURST_128,
+	GPDMA_BURST_256
+};
+
+enum gpdma_width {
+	GPDMA_WIDTH_8BIT,
+	GPDMA_WIDTH_16BIT,
+	GPDMA_WIDTH_32BIT
+};
+
+enum {
+	/** Largest transfer size a single channel programming can describe. */
+	GPDMA_XFER_SIZE_MAX = 4095
+};
+
+/** A GPDMA linked list item, laid out exactly as the controller expects. */
+struct gpdma_lli {
+	u32 src;
+	u32 dst;
+	u32 next;
+	u32 ctrl;
+};
+
+struct gpdma_xfer_cfg {
+	enum gpdma_xfer_type type;
+	enum gpdma_periph src_periph;
+	enum gpdma_periph dst_periph;
+	enum gpdma_burst burst;
+	enum gpdma_width width;
+};
+
+/**
+ * Called from isr_GPDMA when a channel has raised its terminal count or error
+ * interrupt.
+ */
+typedef void (*gpdma_done_cb)(enum gpdma_channel ch, bool err, void *ctx);
+
+void gpdma_init(void);
+
+/** Returns whether the controller is able to access the given address. */
+ALWAYS_INLINE bool gpdma_addr_reachable(const void *const ptr)
+{
+	const uintptr_t addr = (uintptr_t)ptr;
+
+	return (addr < GPDMA_FLASH_SIZE) ||
+	       ((addr >= GPDMA_AHB_SRAM_BASE_ADDR) &&
+		(addr < GPDMA_AHB_SRAM_BASE_ADDR + GPDMA_AHB_SRAM_SIZE));
+}
+
+/**
+ * Builds the control word for a linked list item.
+ *
+ * @param cfg The transfer configuration.
+ * @param size The number of transfers; must not exceed GPDMA_XFER_SIZE_MAX.
+ * @param src_inc Whether the source address increments after each transfer.
+ * @param dst_inc Whether the destination address increments after each
+ * transfer.
+ * @param irq Whether the terminal count interrupt is raised once this item
+ * completes.
+ */
+u32 gpdma_lli_ctrl(const struct gpdma_xfer_cfg *cfg, u32 size, bool src_inc,
+		   bool dst_inc, bool irq);
+
+/**
+ * Programs and enables a channel with the first item of a linked list. The
+ * remaining items, if any, are fetched by the controller itself.
+ */
+void gpdma_channel_start(enum gpdma_channel ch,
+			 const struct gpdma_xfer_cfg *cfg,
+			 const struct gpdma_lli *lli, gpdma_done_cb cb,
+			 void *ctx);
+
+void gpdma_channel_stop(enum gpdma_channel ch);
+
+bool gpdma_channel_busy(enum gpdma_channel ch);
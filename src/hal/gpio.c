@@ -26,9 +26,11 @@
 // clang-format off
 
 const struct gpio_pin GPIO_PIN_P_0_15 = {
+	.port			= GPIO_PORT_0,
 	.pinsel_reg		= PINSEL_REG_PINSEL0,
 	.pinmode_reg		= PINMODE_REG_PINMODE0,
 	.fiodir_reg		= GPIO_REG_FIO0DIR,
+	.fiopin_reg		= GPIO_REG_FIO0PIN,
 	.fioset_reg		= GPIO_REG_FIO0SET,
 	.fioclr_reg		= GPIO_REG_FIO0CLR,
 	.fio_bit		= BIT_15,
@@ -36,9 +38,11 @@ const struct gpio_pin GPIO_PIN_P_0_15 = {
 };
 
 const struct gpio_pin GPIO_PIN_P_0_16 = {
+	.port			= GPIO_PORT_0,
 	.pinsel_reg		= PINSEL_REG_PINSEL1,
 	.pinmode_reg		= PINMODE_REG_PINMODE1,
 	.fiodir_reg		= GPIO_REG_FIO0DIR,
+	.fiopin_reg		= GPIO_REG_FIO0PIN,
 	.fioset_reg		= GPIO_REG_FIO0SET,
 	.fioclr_reg		= GPIO_REG_FIO0CLR,
 	.fio_bit		= BIT_16,
@@ -46,9 +50,11 @@ const struct gpio_pin GPIO_PIN_P_0_16 = {
 };
 
 const struct gpio_pin GPIO_PIN_P_0_17 = {
+	.port			= GPIO_PORT_0,
 	.pinsel_reg		= PINSEL_REG_PINSEL1,
 	.pinmode_reg		= PINMODE_REG_PINMODE1,
 	.fiodir_reg		= GPIO_REG_FIO0DIR,
+	.fiopin_reg		= GPIO_REG_FIO0PIN,
 	.fioset_reg		= GPIO_REG_FIO0SET,
 	.fioclr_reg		= GPIO_REG_FIO0CLR,
 	.fio_bit		= BIT_17,
@@ -56,9 +62,11 @@ const struct gpio_pin GPIO_PIN_P_0_17 = {
 };
 
 const struct gpio_pin GPIO_PIN_P_0_18 = {
+	.port			= GPIO_PORT_0,
 	.pinsel_reg		= PINSEL_REG_PINSEL1,
 	.pinmode_reg		= PINMODE_REG_PINMODE1,
 	.fiodir_reg		= GPIO_REG_FIO0DIR,
+	.fiopin_reg		= GPIO_REG_FIO0PIN,
 	.fioset_reg		= GPIO_REG_FIO0SET,
 	.fioclr_reg		= GPIO_REG_FIO0CLR,
 	.fio_bit		= BIT_18,
@@ -66,9 +74,11 @@ const struct gpio_pin GPIO_PIN_P_0_18 = {
 };
 
 const struct gpio_pin GPIO_PIN_P_0_29 = {
+	.port			= GPIO_PORT_0,
 	.pinsel_reg		= PINSEL_REG_PINSEL1,
 	.pinmode_reg		= PINMODE_REG_PINMODE1,
 	.fiodir_reg		= GPIO_REG_FIO0DIR,
+	.fiopin_reg		= GPIO_REG_FIO0PIN,
 	.fioset_reg		= GPIO_REG_FIO0SET,
 	.fioclr_reg		= GPIO_REG_FIO0CLR,
 	.fio_bit		= BIT_29,
@@ -76,9 +86,11 @@ const struct gpio_pin GPIO_PIN_P_0_29 = {
 };
 
 const struct gpio_pin GPIO_PIN_P_0_30 = {
+	.port			= GPIO_PORT_0,
 	.pinsel_reg		= PINSEL_REG_PINSEL1,
 	.pinmode_reg		= PINMODE_REG_PINMODE1,
 	.fiodir_reg		= GPIO_REG_FIO0DIR,
+	.fiopin_reg		= GPIO_REG_FIO0PIN,
 	.fioset_reg		= GPIO_REG_FIO0SET,
 	.fioclr_reg		= GPIO_REG_FIO0CLR,
 	.fio_bit		= BIT_30,
@@ -86,9 +98,11 @@ const struct gpio_pin GPIO_PIN_P_0_30 = {
 };
 
 const struct gpio_pin GPIO_PIN_P_1_27 = {
+	.port			= GPIO_PORT_1,
 	.pinsel_reg		= PINSEL_REG_PINSEL3,
 	.pinmode_reg		= PINMODE_REG_PINMODE3,
 	.fiodir_reg		= GPIO_REG_FIO1DIR,
+	.fiopin_reg		= GPIO_REG_FIO1PIN,
 	.fioset_reg		= GPIO_REG_FIO1SET,
 	.fioclr_reg		= GPIO_REG_FIO1CLR,
 	.fio_bit		= BIT_27,
@@ -96,9 +110,11 @@ const struct gpio_pin GPIO_PIN_P_1_27 = {
 };
 
 const struct gpio_pin GPIO_PIN_P_2_5 = {
+	.port			= GPIO_PORT_2,
 	.pinsel_reg		= PINSEL_REG_PINSEL4,
 	.pinmode_reg		= PINMODE_REG_PINMODE4,
 	.fiodir_reg		= GPIO_REG_FIO2DIR,
+	.fiopin_reg		= GPIO_REG_FIO2PIN,
 	.fioset_reg		= GPIO_REG_FIO2SET,
 	.fioclr_reg		= GPIO_REG_FIO2CLR,
 	.fio_bit		= BIT_5,
@@ -106,15 +122,29 @@ const struct gpio_pin GPIO_PIN_P_2_5 = {
 };
 
 const struct gpio_pin GPIO_PIN_P_2_9 = {
+	.port			= GPIO_PORT_2,
 	.pinsel_reg		= PINSEL_REG_PINSEL4,
 	.pinmode_reg		= PINMODE_REG_PINMODE4,
 	.fiodir_reg		= GPIO_REG_FIO2DIR,
+	.fiopin_reg		= GPIO_REG_FIO2PIN,
 	.fioset_reg		= GPIO_REG_FIO2SET,
 	.fioclr_reg		= GPIO_REG_FIO2CLR,
 	.fio_bit		= BIT_9,
 	.pinsel_pinmode_mask	= BIT_19 | BIT_18
 };
 
+const struct gpio_pin GPIO_PIN_P_2_12 = {
+	.port			= GPIO_PORT_2,
+	.pinsel_reg		= PINSEL_REG_PINSEL4,
+	.pinmode_reg		= PINMODE_REG_PINMODE4,
+	.fiodir_reg		= GPIO_REG_FIO2DIR,
+	.fiopin_reg		= GPIO_REG_FIO2PIN,
+	.fioset_reg		= GPIO_REG_FIO2SET,
+	.fioclr_reg		= GPIO_REG_FIO2CLR,
+	.fio_bit		= BIT_12,
+	.pinsel_pinmode_mask	= BIT_25 | BIT_24
+};
+
 // clang-format on
 
 static void clear_pin_fiomask(void)
@@ -163,4 +193,68 @@ void gpio_pin_init(const struct gpio_pin *const pin,
 
 	pincm_set_resistor(pin->pinmode_reg, pin->pinsel_pinmode_mask,
 			   cfg->resistor);
-}
\ No newline at end of file
+}
+
+static const struct {
+	enum gpio_reg_int stat_r;
+	enum gpio_reg_int stat_f;
+	enum gpio_reg_int clr;
+	enum gpio_reg_int en_r;
+	enum gpio_reg_int en_f;
+} gpio_int_regs[] = {
+	// clang-format off
+
+	[GPIO_PORT_0] = {
+		.stat_r	= GPIO_REG_IO0IntStatR,
+		.stat_f	= GPIO_REG_IO0IntStatF,
+		.clr	= GPIO_REG_IO0IntClr,
+		.en_r	= GPIO_REG_IO0IntEnR,
+		.en_f	= GPIO_REG_IO0IntEnF
+	},
+
+	[GPIO_PORT_2] = {
+		.stat_r	= GPIO_REG_IO2IntStatR,
+		.stat_f	= GPIO_REG_IO2IntStatF,
+		.clr	= GPIO_REG_IO2IntClr,
+		.en_r	= GPIO_REG_IO2IntEnR,
+		.en_f	= GPIO_REG_IO2IntEnF
+	}
+
+	// clang-format on
+};
+
+void gpio_pin_int_enable(const struct gpio_pin *const pin, const u32 edges)
+{
+	app_assert((pin->port == GPIO_PORT_0) || (pin->port == GPIO_PORT_2));
+
+	if (edges & GPIO_INT_EDGE_RISING)
+		mmio_set32(gpio_int_regs[pin->port].en_r, pin->fio_bit);
+	else
+		mmio_clr32(gpio_int_regs[pin->port].en_r, pin->fio_bit);
+
+	if (edges & GPIO_INT_EDGE_FALLING)
+		mmio_set32(gpio_int_regs[pin->port].en_f, pin->fio_bit);
+	else
+		mmio_clr32(gpio_int_regs[pin->port].en_f, pin->fio_bit);
+}
+
+void gpio_pin_int_disable(const struct gpio_pin *const pin)
+{
+	gpio_pin_int_enable(pin, 0);
+}
+
+bool gpio_pin_int_pending(const struct gpio_pin *const pin)
+{
+	app_assert((pin->port == GPIO_PORT_0) || (pin->port == GPIO_PORT_2));
+
+	const u32 stat = mmio_read32(gpio_int_regs[pin->port].stat_r) |
+			 mmio_read32(gpio_int_regs[pin->port].stat_f);
+
+	return stat & pin->fio_bit;
+}
+
+void gpio_pin_int_clear(const struct gpio_pin *const pin)
+{
+	app_assert((pin->port == GPIO_PORT_0) || (pin->port == GPIO_PORT_2));
+	mmio_write32(gpio_int_regs[pin->port].clr, pin->fio_bit);
+}
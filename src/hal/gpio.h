@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include <stdbool.h>
+
 #include "common/compiler.h"
 
 #include "pincm.h"
@@ -55,6 +57,14 @@ enum gpio_reg_fiodir {
 	GPIO_REG_FIO4DIR = 0x2009C080
 };
 
+enum gpio_reg_fiopin {
+	GPIO_REG_FIO0PIN = 0x2009C014,
+	GPIO_REG_FIO1PIN = 0x2009C034,
+	GPIO_REG_FIO2PIN = 0x2009C054,
+	GPIO_REG_FIO3PIN = 0x2009C074,
+	GPIO_REG_FIO4PIN = 0x2009C094
+};
+
 enum gpio_reg_fioset {
 	GPIO_REG_FIO0SET = 0x2009C018,
 	GPIO_REG_FIO1SET = 0x2009C038,
@@ -71,10 +81,43 @@ enum gpio_reg_fioclr {
 	GPIO_REG_FIO4CLR = 0x2009C09C
 };
 
+// Only ports 0 and 2 are capable of raising interrupts; they share the EINT3
+// vector with external interrupt 3.
+enum gpio_reg_int {
+	GPIO_REG_IOIntStatus = 0x40028080,
+
+	GPIO_REG_IO0IntStatR = 0x40028084,
+	GPIO_REG_IO0IntStatF = 0x40028088,
+	GPIO_REG_IO0IntClr = 0x4002808C,
+	GPIO_REG_IO0IntEnR = 0x40028090,
+	GPIO_REG_IO0IntEnF = 0x40028094,
+
+	GPIO_REG_IO2IntStatR = 0x400280A4,
+	GPIO_REG_IO2IntStatF = 0x400280A8,
+	GPIO_REG_IO2IntClr = 0x400280AC,
+	GPIO_REG_IO2IntEnR = 0x400280B0,
+	GPIO_REG_IO2IntEnF = 0x400280B4
+};
+
+enum gpio_port {
+	GPIO_PORT_0,
+	GPIO_PORT_1,
+	GPIO_PORT_2,
+	GPIO_PORT_3,
+	GPIO_PORT_4
+};
+
+enum gpio_int_edge {
+	GPIO_INT_EDGE_RISING = BIT_0,
+	GPIO_INT_EDGE_FALLING = BIT_1
+};
+
 struct gpio_pin {
+	const enum gpio_port port;
 	const enum pinsel_reg pinsel_reg;
 	const enum pinmode_reg pinmode_reg;
 	const enum gpio_reg_fiodir fiodir_reg;
+	const enum gpio_reg_fiopin fiopin_reg;
 	const enum gpio_reg_fioset fioset_reg;
 	const enum gpio_reg_fioclr fioclr_reg;
 	const u32 fio_bit;
@@ -92,6 +135,22 @@ void gpio_init(void);
 
 void gpio_pin_init(const struct gpio_pin *pin, const struct gpio_pin_cfg *cfg);
 
+/**
+ * Enables the interrupt of @p pin on the given combination of @p edges. Only
+ * pins on ports 0 and 2 support this.
+ */
+void gpio_pin_int_enable(const struct gpio_pin *pin, u32 edges);
+void gpio_pin_int_disable(const struct gpio_pin *pin);
+
+/** Whether an enabled edge has been detected on @p pin since last cleared. */
+bool gpio_pin_int_pending(const struct gpio_pin *pin);
+void gpio_pin_int_clear(const struct gpio_pin *pin);
+
+ALWAYS_INLINE bool gpio_pin_read(const struct gpio_pin *const pin)
+{
+	return mmio_read32(pin->fiopin_reg) & pin->fio_bit;
+}
+
 ALWAYS_INLINE void gpio_pin_set_low(const struct gpio_pin *const pin)
 {
 	mmio_write32(pin->fioclr_reg, pin->fio_bit);
@@ -124,4 +183,5 @@ extern const struct gpio_pin GPIO_PIN_P_0_29;
 extern const struct gpio_pin GPIO_PIN_P_0_30;
 extern const struct gpio_pin GPIO_PIN_P_1_27;
 extern const struct gpio_pin GPIO_PIN_P_2_5;
-extern const struct gpio_pin GPIO_PIN_P_2_9;
\ No newline at end of file
+extern const struct gpio_pin GPIO_PIN_P_2_9;
+extern const struct gpio_pin GPIO_PIN_P_2_12;
\ No newline at end of file
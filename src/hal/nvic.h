@@ -64,6 +64,18 @@ enum nvic_irq {
 	NVIC_IRQ_CANACT
 };
 
+enum {
+	/** The LPC17xx implements the upper five bits of each priority. */
+	NVIC_PRIO_BITS = 5,
+
+	NVIC_PRIO_HIGHEST = 0,
+	NVIC_PRIO_LOWEST = (1 << NVIC_PRIO_BITS) - 1
+};
+
+enum {
+	NVIC_IPR0 = 0xE000E400
+};
+
 enum nvic_iser {
 	NVIC_ISER0 = 0xE000E100,
 	NVIC_ISER1 = 0xE000E104,
@@ -143,4 +155,22 @@ ALWAYS_INLINE void nvic_irq_clr_pending(const enum nvic_irq irq)
 		NVIC_ICPR0 + ((irq >> 5) * sizeof(u32));
 
 	mmio_set32(icpr_addr, UINT32_C(1) << (irq & 0x1F));
+}
+
+/** Converts a priority to its encoding in the priority registers. */
+ALWAYS_INLINE u32 nvic_prio_to_reg(const u32 prio)
+{
+	return prio << (8 - NVIC_PRIO_BITS);
+}
+
+/**
+ * Sets the priority of @p irq, from NVIC_PRIO_HIGHEST to NVIC_PRIO_LOWEST.
+ */
+ALWAYS_INLINE void nvic_irq_priority_set(const enum nvic_irq irq,
+					 const u32 prio)
+{
+	const uintptr_t ipr_addr = NVIC_IPR0 + (irq & ~0x3U);
+	const u32 mask = UINT32_C(0xFF) << ((irq & 0x3) * 8);
+
+	mmio_rmw_mask32(ipr_addr, mask, nvic_prio_to_reg(prio));
 }
\ No newline at end of file
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "common/compiler.h"
+#include "common/util.h"
+#include "nvic.h"
+#include "util.h"
+
+enum scb_reg {
+	SCB_REG_ICSR = 0xE000ED04,
+	SCB_REG_SHPR3 = 0xE000ED20
+};
+
+enum {
+	ICSR_PENDSTSET = BIT_26,
+	ICSR_PENDSVCLR = BIT_27,
+	ICSR_PENDSVSET = BIT_28
+};
+
+enum {
+	SHPR3_PRI_14 = BITMASK_FROM_RANGE(16, 23)
+};
+
+/**
+ * Sets the priority of the PendSV exception; the same scale as
+ * nvic_irq_priority_set() applies.
+ */
+ALWAYS_INLINE void scb_pendsv_priority_set(const u32 prio)
+{
+	mmio_rmw_mask32(SCB_REG_SHPR3, SHPR3_PRI_14, nvic_prio_to_reg(prio));
+}
+
+/** Requests the PendSV exception, which is taken once priorities allow it. */
+ALWAYS_INLINE void scb_pendsv_set(void)
+{
+	mmio_write32(SCB_REG_ICSR, ICSR_PENDSVSET);
+}
+
+ALWAYS_INLINE bool scb_systick_pending(void)
+{
+	return mmio_read32(SCB_REG_ICSR) & ICSR_PENDSTSET;
+}
@@ -21,7 +21,9 @@
 // SOFTWARE.
 
 #include <stdbool.h>
+#include <stddef.h>
 
+#include "gpdma.h"
 #include "nvic.h"
 #include "spi.h"
 #include "sysctl.h"
@@ -81,12 +83,26 @@ enum {
 	CPSR_CPSDVSR_MASK = BITMASK_FROM_RANGE(0, 7),
 };
 
+enum {
+	/** Depth of both the TX and RX FIFO, in frames. */
+	SSP_FIFO_DEPTH = 8
+};
+
+enum {
+	DMACR_RXDMAE = BIT_0,
+	DMACR_TXDMAE = BIT_1
+};
+
 static struct {
 	const enum ssp_base_addr base_addr;
 	const enum sysctl_pconp_bit pconp_bit;
 	const enum sysctl_reg pclksel_reg;
 	const enum sysctl_pclksel_mask pclksel_mask;
 	const enum nvic_irq irq;
+	const enum gpdma_channel dma_rx_ch;
+	const enum gpdma_channel dma_tx_ch;
+	const enum gpdma_periph dma_rx_periph;
+	const enum gpdma_periph dma_tx_periph;
 } spi_inst[] = {
 	// clang-format off
 
@@ -95,7 +111,11 @@ static struct {
 		.pconp_bit	= SYSCTL_PCONP_BIT_PCSSP0,
 		.pclksel_reg	= SYSCTL_REG_PCLKSEL1,
 		.pclksel_mask	= SYSCTL_PCLKSEL1_MASK_PCLK_SSP0,
-		.irq		= NVIC_IRQ_SSP0
+		.irq		= NVIC_IRQ_SSP0,
+		.dma_rx_ch	= GPDMA_CHANNEL_0,
+		.dma_tx_ch	= GPDMA_CHANNEL_1,
+		.dma_rx_periph	= GPDMA_PERIPH_SSP0_RX,
+		.dma_tx_periph	= GPDMA_PERIPH_SSP0_TX
 	},
 
 	[SPI_INSTANCE_SPI1] = {
@@ -103,12 +123,32 @@ static struct {
 		.pconp_bit	= SYSCTL_PCONP_BIT_PCSSP1,
 		.pclksel_reg	= SYSCTL_REG_PCLKSEL0,
 		.pclksel_mask	= SYSCTL_PCLKSEL0_MASK_PCLK_SSP1,
-		.irq		= NVIC_IRQ_SSP1
+		.irq		= NVIC_IRQ_SSP1,
+		.dma_rx_ch	= GPDMA_CHANNEL_2,
+		.dma_tx_ch	= GPDMA_CHANNEL_3,
+		.dma_rx_periph	= GPDMA_PERIPH_SSP1_RX,
+		.dma_tx_periph	= GPDMA_PERIPH_SSP1_TX
 	}
 
 	// clang-format on
 };
 
+// Linked list items and scratch bytes used by the DMA engine. The RX channel
+// of each instance is given the lower (higher priority) channel number, so that
+// the RX FIFO is always drained before the TX FIFO is refilled.
+static GPDMA_MEM struct {
+	struct gpdma_lli rx_lli[SPI_DMA_DESC_NUM_MAX];
+	struct gpdma_lli tx_lli[SPI_DMA_DESC_NUM_MAX];
+	u8 tx_fill[SPI_DMA_DESC_NUM_MAX];
+	u8 rx_sink;
+} spi_dma_mem[ARRAY_SIZE(spi_inst)];
+
+static struct {
+	spi_dma_done_cb cb;
+	void *ctx;
+	volatile bool busy;
+} spi_dma[ARRAY_SIZE(spi_inst)];
+
 ALWAYS_INLINE u32 ssp_reg_read(const enum spi_instance inst,
 			       const enum ssp_reg reg)
 {
@@ -242,43 +282,186 @@ void spi_init_moto_master(const enum spi_instance inst,
 	ssp_reg_write(inst, SSP_REG_CR1, CR1);
 }
 
-void spi_tx_blocking_u8(const enum spi_instance inst, const u8 *const src,
-			const u32 src_size)
+static void dma_finish(const enum spi_instance inst, const bool err)
 {
-	for (u32 i = 0; i < src_size;) {
-		while (!tx_fifo_not_full(inst))
-			nop();
+	ssp_reg_write(inst, SSP_REG_DMACR, 0);
 
-		ssp_reg_write(inst, SSP_REG_DR, src[i++]);
+	if (err) {
+		gpdma_channel_stop(spi_inst[inst].dma_tx_ch);
+		gpdma_channel_stop(spi_inst[inst].dma_rx_ch);
+	}
 
-		while (!rx_fifo_not_empty(inst))
-			nop();
+	spi_dma[inst].busy = false;
 
-		ssp_reg_read(inst, SSP_REG_DR);
+	if (spi_dma[inst].cb)
+		spi_dma[inst].cb(inst, err, spi_dma[inst].ctx);
+}
+
+static void dma_rx_done(const enum gpdma_channel ch, const bool err,
+			void *const ctx)
+{
+	(void)ch;
+
+	const enum spi_instance inst = (enum spi_instance)(uintptr_t)ctx;
+
+	// The terminal count interrupt is only requested on the last RX linked
+	// list item, so reaching this point without an error means every frame
+	// has been shifted out and received.
+	dma_finish(inst, err);
+}
+
+static void dma_tx_done(const enum gpdma_channel ch, const bool err,
+			void *const ctx)
+{
+	(void)ch;
+
+	// Only an error is reported on the TX channel; completion is tracked
+	// through the RX channel.
+	if (err)
+		dma_finish((enum spi_instance)(uintptr_t)ctx, true);
+}
+
+void spi_dma_init(const enum spi_instance inst)
+{
+	ssp_reg_write(inst, SSP_REG_DMACR, 0);
+	spi_dma[inst].busy = false;
+}
+
+void spi_dma_tx_rx_u8(const enum spi_instance inst,
+		      const struct spi_dma_desc *const desc, const u32 num_desc,
+		      const spi_dma_done_cb cb, void *const ctx)
+{
+	app_assert(!spi_dma[inst].busy);
+	app_assert((num_desc > 0) && (num_desc <= SPI_DMA_DESC_NUM_MAX));
+
+	const struct gpdma_xfer_cfg rx_cfg = {
+		// clang-format off
+
+		.type		= GPDMA_XFER_TYPE_P2M,
+		.src_periph	= spi_inst[inst].dma_rx_periph,
+		.burst		= GPDMA_BURST_4,
+		.width		= GPDMA_WIDTH_8BIT
+
+		// clang-format on
+	};
+
+	const struct gpdma_xfer_cfg tx_cfg = {
+		// clang-format off
+
+		.type		= GPDMA_XFER_TYPE_M2P,
+		.dst_periph	= spi_inst[inst].dma_tx_periph,
+		.burst		= GPDMA_BURST_4,
+		.width		= GPDMA_WIDTH_8BIT
+
+		// clang-format on
+	};
+
+	const uintptr_t DR = spi_inst[inst].base_addr + SSP_REG_DR;
+	struct gpdma_lli *const rx_lli = spi_dma_mem[inst].rx_lli;
+	struct gpdma_lli *const tx_lli = spi_dma_mem[inst].tx_lli;
+
+	for (u32 i = 0; i < num_desc; ++i) {
+		const struct spi_dma_desc *const d = &desc[i];
+		const bool last = (i == (num_desc - 1));
+
+		app_assert(d->size && (d->size <= GPDMA_XFER_SIZE_MAX));
+		app_assert(!d->src || gpdma_addr_reachable(d->src));
+		app_assert(!d->dst || gpdma_addr_reachable(d->dst));
+
+		rx_lli[i].src = DR;
+		rx_lli[i].dst = d->dst ? (uintptr_t)d->dst :
+					 (uintptr_t)&spi_dma_mem[inst].rx_sink;
+		rx_lli[i].next = last ? 0 : (uintptr_t)&rx_lli[i + 1];
+		rx_lli[i].ctrl =
+			gpdma_lli_ctrl(&rx_cfg, d->size, false, d->dst, last);
+
+		spi_dma_mem[inst].tx_fill[i] = d->fill;
+
+		tx_lli[i].src =
+			d->src ? (uintptr_t)d->src :
+				 (uintptr_t)&spi_dma_mem[inst].tx_fill[i];
+		tx_lli[i].dst = DR;
+		tx_lli[i].next = last ? 0 : (uintptr_t)&tx_lli[i + 1];
+		tx_lli[i].ctrl =
+			gpdma_lli_ctrl(&tx_cfg, d->size, d->src, false, false);
 	}
 
-	while (ssp_reg_read(inst, SSP_REG_SR) & SR_BSY)
-		nop();
+	// Anything left over in the RX FIFO would be the first thing the RX
+	// channel reads, shifting the whole transfer by one or more bytes.
+	while (rx_fifo_not_empty(inst))
+		ssp_reg_read(inst, SSP_REG_DR);
+
+	spi_dma[inst].cb = cb;
+	spi_dma[inst].ctx = ctx;
+	spi_dma[inst].busy = true;
+
+	void *const inst_ctx = (void *)(uintptr_t)inst;
+
+	gpdma_channel_start(spi_inst[inst].dma_rx_ch, &rx_cfg, &rx_lli[0],
+			    dma_rx_done, inst_ctx);
+	gpdma_channel_start(spi_inst[inst].dma_tx_ch, &tx_cfg, &tx_lli[0],
+			    dma_tx_done, inst_ctx);
+
+	ssp_reg_write(inst, SSP_REG_DMACR, DMACR_RXDMAE | DMACR_TXDMAE);
 }
 
-void spi_tx_rx_blocking_u8(const enum spi_instance inst, const u8 *const src,
-			   u8 *const dst, const u32 size)
+bool spi_dma_busy(const enum spi_instance inst)
 {
-	u32 src_idx = 0;
+	return spi_dma[inst].busy;
+}
+
+// Shifts @p size frames through the SSP while keeping as many of them in
+// flight as the FIFOs allow, so that SCK runs back-to-back instead of idling
+// while each received frame is collected.
+//
+// A frame counts as in flight from the moment it is written to the TX FIFO
+// until it has been read from the RX FIFO. Capping that count at the depth of
+// the RX FIFO makes an RX overrun impossible, no matter how late the frames
+// are collected.
+static void xfer_pipelined(const enum spi_instance inst, const u8 *const src,
+			   const u8 fill, u8 *const dst, const u32 size)
+{
+	u32 tx_idx = 0;
 	u32 rx_idx = 0;
 
-	while ((src_idx < size) && (rx_idx < size)) {
-		while (!tx_fifo_not_full(inst))
-			nop();
+	while (rx_idx < size) {
+		const u32 SR = ssp_reg_read(inst, SSP_REG_SR);
+
+		if (SR & SR_RNE) {
+			const u8 byte = ssp_reg_read(inst, SSP_REG_DR);
 
-		ssp_reg_write(inst, SSP_REG_DR, src[src_idx++]);
+			if (dst)
+				dst[rx_idx] = byte;
 
-		while (!rx_fifo_not_empty(inst))
-			nop();
+			rx_idx++;
+		}
 
-		dst[rx_idx++] = ssp_reg_read(inst, SSP_REG_DR);
+		if ((SR & SR_TNF) && (tx_idx < size) &&
+		    ((tx_idx - rx_idx) < SSP_FIFO_DEPTH)) {
+			ssp_reg_write(inst, SSP_REG_DR,
+				      src ? src[tx_idx] : fill);
+			tx_idx++;
+		}
 	}
 
 	while (ssp_reg_read(inst, SSP_REG_SR) & SR_BSY)
 		nop();
 }
+
+void spi_tx_blocking_u8(const enum spi_instance inst, const u8 *const src,
+			const u32 src_size)
+{
+	xfer_pipelined(inst, src, 0, NULL, src_size);
+}
+
+void spi_tx_rx_blocking_u8(const enum spi_instance inst, const u8 *const src,
+			   u8 *const dst, const u32 size)
+{
+	xfer_pipelined(inst, src, 0, dst, size);
+}
+
+void spi_rx_blocking_u8(const enum spi_instance inst, const u8 fill,
+			u8 *const dst, const u32 size)
+{
+	xfer_pipelined(inst, NULL, fill, dst, size);
+}
@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include <stdbool.h>
+
 #include "sysctl.h"
 
 enum spi_instance {
@@ -69,6 +71,33 @@ enum spi_cfg_moto_spi_cpha {
 	SPI_CFG_MOTO_SPI_CPHA_SECOND
 };
 
+enum {
+	/** Maximum number of descriptors a single DMA transfer may chain. */
+	SPI_DMA_DESC_NUM_MAX = 4
+};
+
+struct spi_dma_desc {
+	/**
+	 * Bytes to transmit, or NULL to clock out @ref fill for every frame.
+	 * Must be reachable by the GPDMA.
+	 */
+	const u8 *src;
+
+	/** Byte repeatedly transmitted when @ref src is NULL. */
+	u8 fill;
+
+	/**
+	 * Where received bytes are stored, or NULL to discard them. Must be
+	 * reachable by the GPDMA.
+	 */
+	u8 *dst;
+
+	/** Number of frames; at most GPDMA_XFER_SIZE_MAX. */
+	u32 size;
+};
+
+typedef void (*spi_dma_done_cb)(enum spi_instance inst, bool err, void *ctx);
+
 struct spi_cfg_moto_master {
 	enum sysctl_pclksel_clk clk_speed;
 	enum spi_data_size data_size;
@@ -81,7 +110,34 @@ struct spi_cfg_moto_master {
 void spi_init_moto_master(enum spi_instance inst,
 			  const struct spi_cfg_moto_master *cfg);
 
+// The blocking transfers hold up only the task which calls them, as the USB
+// stack runs from PendSV and preempts them. A caller with work to overlap with
+// the bus starts a transfer with spi_dma_tx_rx_u8() instead, and learns of its
+// completion from isr_GPDMA.
 void spi_tx_blocking_u8(enum spi_instance inst, const u8 *src, u32 src_size);
 
 void spi_tx_rx_blocking_u8(enum spi_instance inst, const u8 *src, u8 *dst,
-			   u32 size);
\ No newline at end of file
+			   u32 size);
+
+/**
+ * Receives @p size bytes while transmitting @p fill for every frame, for
+ * devices which expect a command byte to be repeated during a read.
+ */
+void spi_rx_blocking_u8(enum spi_instance inst, u8 fill, u8 *dst, u32 size);
+
+void spi_dma_init(enum spi_instance inst);
+
+/**
+ * Starts a full-duplex transfer of one or more descriptors, executed
+ * back-to-back without CPU involvement.
+ *
+ * @param inst The SSP instance to use.
+ * @param desc The descriptors to transfer; copied before returning.
+ * @param num_desc The number of descriptors, at most SPI_DMA_DESC_NUM_MAX.
+ * @param cb Called from isr_GPDMA once every frame has been received.
+ * @param ctx Passed to @p cb as is.
+ */
+void spi_dma_tx_rx_u8(enum spi_instance inst, const struct spi_dma_desc *desc,
+		      u32 num_desc, spi_dma_done_cb cb, void *ctx);
+
+bool spi_dma_busy(enum spi_instance inst);
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "common/compiler.h"
+#include "common/types.h"
+#include "common/util.h"
+#include "util.h"
+
+enum systick_reg {
+	SYSTICK_REG_CSR = 0xE000E010,
+	SYSTICK_REG_RVR = 0xE000E014,
+	SYSTICK_REG_CVR = 0xE000E018
+};
+
+enum {
+	CSR_ENABLE = BIT_0,
+	CSR_TICKINT = BIT_1,
+	CSR_CLKSOURCE = BIT_2,
+	CSR_COUNTFLAG = BIT_16
+};
+
+enum {
+	SYSTICK_RELOAD_MAX = BITMASK_FROM_RANGE(0, 23)
+};
+
+/**
+ * Starts the SysTick timer from the core clock, raising an interrupt every
+ * @p period cycles.
+ */
+ALWAYS_INLINE void systick_init(const u32 period)
+{
+	mmio_write32(SYSTICK_REG_CSR, 0);
+	mmio_write32(SYSTICK_REG_RVR, period - 1);
+	mmio_write32(SYSTICK_REG_CVR, 0);
+	mmio_write32(SYSTICK_REG_CSR, CSR_ENABLE | CSR_TICKINT | CSR_CLKSOURCE);
+}
+
+/** The current value of the timer, which counts down to 0 and then reloads. */
+ALWAYS_INLINE u32 systick_val(void)
+{
+	return mmio_read32(SYSTICK_REG_CVR);
+}
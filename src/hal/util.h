@@ -23,9 +23,10 @@
 #pragma once
 
 #include "common/compiler.h"
+#include "common/types.h"
 #include "common/util.h"
 
-#define DEFINE_MMIO_HELPERS(bitwidth)                                         \
+#define DEFINE_MMIO_ACCESSORS(bitwidth)                                       \
 	ALWAYS_INLINE uint##bitwidth##_t mmio_read##bitwidth(                 \
 		const uintptr_t addr)                                         \
 	{                                                                     \
@@ -36,8 +37,9 @@
 						const uint##bitwidth##_t val) \
 	{                                                                     \
 		*((volatile uint##bitwidth##_t *const)addr) = val;            \
-	}                                                                     \
-                                                                              \
+	}
+
+#define DEFINE_MMIO_HELPERS(bitwidth)                                         \
 	ALWAYS_INLINE void mmio_set##bitwidth(const uintptr_t addr,           \
 					      const uint##bitwidth##_t bits)  \
 	{                                                                     \
@@ -61,6 +63,24 @@
 		mmio_write##bitwidth(addr, dst);                              \
 	}
 
+#ifdef HOST_TEST
+// The host tests (see test/) run the firmware against models of the
+// peripherals. Every register access and every instruction which touches the
+// core state goes through them instead.
+u32 mmio_read32(uintptr_t addr);
+void mmio_write32(uintptr_t addr, u32 val);
+
+DEFINE_MMIO_HELPERS(32);
+
+void nop(void);
+void bkpt(void);
+void irq_disable(void);
+void irq_enable(void);
+void wfi(void);
+u32 basepri_read(void);
+void basepri_write(u32 val);
+#else
+DEFINE_MMIO_ACCESSORS(32);
 DEFINE_MMIO_HELPERS(32);
 
 ALWAYS_INLINE void nop(void)
@@ -71,4 +91,43 @@ ALWAYS_INLINE void nop(void)
 ALWAYS_INLINE void bkpt(void)
 {
 	asm("bkpt");
-}
\ No newline at end of file
+}
+
+/** Masks all configurable interrupts by setting PRIMASK. */
+ALWAYS_INLINE void irq_disable(void)
+{
+	asm volatile("cpsid i" : : : "memory");
+}
+
+ALWAYS_INLINE void irq_enable(void)
+{
+	asm volatile("cpsie i" : : : "memory");
+}
+
+/**
+ * Sleeps until an interrupt becomes pending. This also happens with PRIMASK
+ * set, in which case the interrupt is only taken once it is cleared again.
+ */
+ALWAYS_INLINE void wfi(void)
+{
+	asm volatile("wfi" : : : "memory");
+}
+
+ALWAYS_INLINE u32 basepri_read(void)
+{
+	u32 val;
+
+	asm volatile("mrs %0, basepri" : "=r"(val));
+	return val;
+}
+
+/**
+ * Masks every exception and interrupt with a priority of @p val or lower; 0
+ * unmasks all of them. @p val is in the same encoding as the priority
+ * registers, see nvic_prio_to_reg().
+ */
+ALWAYS_INLINE void basepri_write(const u32 val)
+{
+	asm volatile("msr basepri, %0" : : "r"(val) : "memory");
+}
+#endif // HOST_TEST
\ No newline at end of file
@@ -23,16 +23,15 @@
 #include <stdlib.h>
 
 #include "board/board.h"
-#include "task-ccc.h"
+#include "sched.h"
 
 int main(void)
 {
 	board_init();
+	sched_init();
 
-	for (;;) {
-		board_tick();
-		task_ccc_tick();
-	}
+	for (;;)
+		sched_run();
 
 	return EXIT_FAILURE;
 }
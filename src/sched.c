@@ -0,0 +1,290 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "common/util.h"
+#include "hal/dwt.h"
+#include "hal/scb.h"
+#include "hal/sysctl.h"
+#include "hal/systick.h"
+#include "hal/util.h"
+#include "sched.h"
+#include "task-ccc.h"
+#include "task-dict.h"
+#include "task-poll.h"
+
+enum {
+	SCHED_TICK_HZ = 1000,
+	SCHED_TICK_CYCLES = SYSCTL_CCLK_HZ / SCHED_TICK_HZ,
+	SCHED_CYCLES_PER_US = SYSCTL_CCLK_HZ / mhz_to_hz(1)
+};
+
+_Static_assert(SCHED_TICK_CYCLES - 1 <= SYSTICK_RELOAD_MAX,
+	       "Scheduler tick does not fit into the SysTick reload value");
+
+static const struct {
+	void (*const run)(void);
+
+	/** Release interval in ms; 0 if the task only runs when signaled. */
+	const u32 period_ms;
+
+	/** Maximum delay from release or signal to start, in ms. */
+	const u32 deadline_ms;
+
+	const u32 budget_us;
+} sched_task_desc[SCHED_TASK_NUM] = {
+	// clang-format off
+
+	[SCHED_TASK_CCC] = {
+		.run		= task_ccc_tick,
+		.period_ms	= 10,
+		.deadline_ms	= 2,
+		.budget_us	= 2000
+	},
+
+	[SCHED_TASK_POLL] = {
+		.run		= task_poll_tick,
+		.period_ms	= 1,
+		.deadline_ms	= 2,
+		.budget_us	= 5000
+	},
+
+	// Only runs while a key search is under way; an authentication
+	// attempt takes a few milliseconds and cannot be split.
+	[SCHED_TASK_DICT] = {
+		.run		= task_dict_tick,
+		.period_ms	= 0,
+		.deadline_ms	= 10,
+		.budget_us	= 5000
+	}
+
+	// clang-format on
+};
+
+static struct {
+	volatile u32 ms;
+
+	enum sched_task current;
+	u32 current_start;
+
+	struct {
+		u32 release_ms;
+		volatile u32 signaled_ms;
+		volatile bool signaled;
+
+		struct sched_task_stats stats;
+	} task[SCHED_TASK_NUM];
+
+	struct sched_idle_stats idle;
+} sched;
+
+void isr_SysTick(void)
+{
+	sched.ms++;
+}
+
+void sched_init(void)
+{
+	systick_init(SCHED_TICK_CYCLES);
+
+	for (u32 i = 0; i < SCHED_TASK_NUM; ++i)
+		sched.task[i].release_ms = sched_task_desc[i].period_ms;
+}
+
+u32 sched_time_ms(void)
+{
+	return sched.ms;
+}
+
+static u64 time_us(const u32 ms, const u32 val)
+{
+	const u32 elapsed = (SCHED_TICK_CYCLES - 1) - val;
+
+	return ((u64)ms * 1000) + (elapsed / SCHED_CYCLES_PER_US);
+}
+
+u64 sched_time_us_masked(void)
+{
+	// A tick which is pending has not been counted yet, although the timer
+	// has already reloaded.
+	u32 val = systick_val();
+	const bool tick = scb_systick_pending();
+
+	// The timer may have reloaded after it was read; read it again, so that
+	// the value belongs to the millisecond of the pending tick.
+	if (tick)
+		val = systick_val();
+
+	return time_us(sched.ms + tick, val);
+}
+
+u64 sched_time_us(void)
+{
+	u32 ms;
+	u32 val;
+
+	// Retry if the tick interrupt fired in between, as the timer value
+	// would then belong to the next millisecond.
+	do {
+		ms = sched.ms;
+		val = systick_val();
+	} while (ms != sched.ms);
+
+	return time_us(ms, val);
+}
+
+void sched_signal(const enum sched_task task)
+{
+	if (!sched.task[task].signaled) {
+		sched.task[task].signaled_ms = sched.ms;
+		sched.task[task].signaled = true;
+	}
+}
+
+bool sched_budget_expired(void)
+{
+	const u32 elapsed = dwt_cyccnt_read() - sched.current_start;
+	const u32 budget = sched_task_desc[sched.current].budget_us;
+
+	return elapsed >= budget * SCHED_CYCLES_PER_US;
+}
+
+static bool time_reached(const u32 now, const u32 t)
+{
+	return (s32)(now - t) >= 0;
+}
+
+/**
+ * Determines whether @p task is ready to run, and if so, when it was released.
+ */
+static bool task_ready(const enum sched_task task, const u32 now,
+		       u32 *const released)
+{
+	const u32 period = sched_task_desc[task].period_ms;
+
+	if (sched.task[task].signaled) {
+		*released = sched.task[task].signaled_ms;
+		return true;
+	}
+
+	if (period && time_reached(now, sched.task[task].release_ms)) {
+		*released = sched.task[task].release_ms;
+		return true;
+	}
+	return false;
+}
+
+static void task_run(const enum sched_task task, const u32 now,
+		     const u32 released)
+{
+	struct sched_task_stats *const stats = &sched.task[task].stats;
+	const u32 period = sched_task_desc[task].period_ms;
+
+	// A signal arriving while the task runs makes it ready again.
+	sched.task[task].signaled = false;
+
+	// Periodic releases are not caught up on after a long stall; the next
+	// one is always in the future.
+	if (period)
+		sched.task[task].release_ms = now + period;
+
+	if (now - released > sched_task_desc[task].deadline_ms)
+		stats->deadline_misses++;
+
+	sched.current = task;
+	sched.current_start = dwt_cyccnt_read();
+
+	sched_task_desc[task].run();
+
+	const u32 us =
+		dwt_cycles_to_us(dwt_cyccnt_read() - sched.current_start);
+
+	stats->runs++;
+	stats->time_total_us += us;
+
+	if (us > stats->time_max_us)
+		stats->time_max_us = us;
+
+	if (us > sched_task_desc[task].budget_us)
+		stats->overruns++;
+}
+
+/**
+ * Sleeps until an interrupt becomes pending. Called with interrupts masked, so
+ * that an interrupt which makes a task ready after the scheduler has checked
+ * still ends the sleep instead of being missed until the next one.
+ */
+static void idle(void)
+{
+	const u64 start = sched_time_us_masked();
+
+	wfi();
+
+	const u32 val = systick_val();
+	const bool tick = scb_systick_pending();
+
+	irq_enable();
+
+	sched.idle.sleeps++;
+	sched.idle.sleep_total_us += sched_time_us() - start;
+
+	if (tick) {
+		// The timer reloads as the interrupt becomes pending, so what
+		// it has counted down since is the time it took to wake up.
+		const u32 latency = (SCHED_TICK_CYCLES - 1) - val;
+
+		sched.idle.tick_wakes++;
+		sched.idle.wake_latency_last = latency;
+
+		if (latency > sched.idle.wake_latency_max)
+			sched.idle.wake_latency_max = latency;
+	}
+}
+
+void sched_run(void)
+{
+	irq_disable();
+
+	const u32 now = sched.ms;
+
+	for (u32 task = 0; task < SCHED_TASK_NUM; ++task) {
+		u32 released;
+
+		if (task_ready(task, now, &released)) {
+			irq_enable();
+			task_run(task, now, released);
+			return;
+		}
+	}
+
+	idle();
+}
+
+void sched_task_stats_get(const enum sched_task task,
+			  struct sched_task_stats *const stats)
+{
+	*stats = sched.task[task].stats;
+}
+
+void sched_idle_stats_get(struct sched_idle_stats *const stats)
+{
+	*stats = sched.idle;
+}
@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <stdbool.h>
+#include "common/types.h"
+
+/**
+ * The tasks known to the scheduler, highest priority first. A task runs when
+ * its period has elapsed or when it has been signaled, whichever comes first;
+ * tasks never preempt each other.
+ */
+enum sched_task {
+	SCHED_TASK_CCC,
+	SCHED_TASK_POLL,
+	SCHED_TASK_DICT,
+	SCHED_TASK_NUM
+};
+
+struct sched_task_stats {
+	u32 runs;
+
+	/** Runs which exceeded the task's time budget. */
+	u32 overruns;
+
+	/** Runs which started later than the task's deadline. */
+	u32 deadline_misses;
+
+	u32 time_total_us;
+	u32 time_max_us;
+};
+
+struct sched_idle_stats {
+	u32 sleeps;
+	u32 sleep_total_us;
+
+	/** Sleeps ended by the scheduler tick rather than another interrupt. */
+	u32 tick_wakes;
+
+	/**
+	 * Core cycles from the tick interrupt becoming pending to the core
+	 * resuming from sleep, for the latest and the slowest tick wake-up.
+	 */
+	u32 wake_latency_last;
+	u32 wake_latency_max;
+};
+
+void sched_init(void);
+
+/**
+ * Runs the highest priority task which is ready. If there is none, sleeps until
+ * the next interrupt, which is at most one scheduler tick away.
+ */
+void sched_run(void);
+
+/**
+ * Makes @p task ready to run. This may be called from interrupt context, e.g.
+ * when data for the task has arrived.
+ */
+void sched_signal(enum sched_task task);
+
+/**
+ * Whether the task currently running has used up its time budget. Tasks which
+ * work through a backlog should check this, and signal themselves to carry on
+ * with the rest later.
+ */
+bool sched_budget_expired(void);
+
+/** Milliseconds since sched_init(); wraps after about 49 days. */
+u32 sched_time_ms(void);
+
+/** Microseconds since sched_init(). */
+u64 sched_time_us(void);
+
+/** sched_time_us(), for callers which have interrupts masked. */
+u64 sched_time_us_masked(void);
+
+void sched_task_stats_get(enum sched_task task, struct sched_task_stats *stats);
+
+void sched_idle_stats_get(struct sched_idle_stats *stats);
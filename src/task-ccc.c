@@ -20,28 +20,71 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <string.h>
+
 #include "board/ccc/ccc.h"
+#include "board/nfc/inventory.h"
+#include "board/nfc/iso14443_4.h"
+#include "board/nfc/iso14443a.h"
+#include "board/nfc/mifare-classic.h"
 #include "board/nfc/nfc.h"
+#include "board/nfc/type2.h"
+#include "common/crc.h"
 #include "common/types.h"
 #include "common/util.h"
+#include "drivers/clrc663/clrc663.h"
+#include "hal/dwt.h"
+#include "hal/gpdma.h"
 #include "hal/util.h"
+#include "sched.h"
 #include "task-ccc.h"
+#include "task-dict.h"
+#include "task-poll.h"
+
+// Every exchange with the host is a frame:
+//
+//   SOF | LEN_LO | LEN_HI | SEQ | PAYLOAD[LEN] | CRC_LO | CRC_HI
+//
+// The CRC is a CRC-16/CCITT-FALSE over LEN_LO through the end of the payload.
+// A request payload is a sequence of commands, each an opcode followed by its
+// parameters. The response echoes SEQ; its payload is a frame status byte,
+// followed by a status byte and the result data of each command executed.
+// Execution stops at the first command which does not succeed.
+//
+// The protocol is served on the CDC and the vendor interface alike, each with
+// its own parser state; a reply goes out on the interface its request came in
+// on.
 
-static void cmd_reg_read(void);
-static void cmd_reg_write(void);
+enum {
+	FRAME_SOF = 0x7E,
+	FRAME_PAYLOAD_SIZE_MAX = 1024
+};
 
-static void cmd_protocol_set(void);
+enum frame_state {
+	FRAME_STATE_SOF,
+	FRAME_STATE_LEN_LO,
+	FRAME_STATE_LEN_HI,
+	FRAME_STATE_SEQ,
+	FRAME_STATE_PAYLOAD,
+	FRAME_STATE_CRC_LO,
+	FRAME_STATE_CRC_HI
+};
 
-static void cmd_rf_field_on(void);
-static void cmd_rf_field_off(void);
+enum frame_status {
+	FRAME_STATUS_OK = 0x00,
+	FRAME_STATUS_BAD_CRC = 0x01,
+	FRAME_STATUS_TOO_LONG = 0x02,
 
-enum ccc_state {
-	TASK_STATE_WAITING_FOR_CMD,
-	TASK_STATE_WAITING_FOR_PARAMS,
+	// Sent by the firmware on its own rather than in response to a frame
+	FRAME_STATUS_EVENT = 0x03
 };
 
-enum {
-	CMD_NUM_PARAMS_MAX = 30,
+enum cmd_status {
+	CMD_STATUS_UNKNOWN = 0xAA,
+	CMD_STATUS_ACK = 0xBB,
+	CMD_STATUS_TRUNCATED = 0xCC,
+	CMD_STATUS_NO_SPACE = 0xDD,
+	CMD_STATUS_NAK = 0xFF
 };
 
 enum ccc_cmd {
@@ -50,128 +93,1563 @@ enum ccc_cmd {
 	CMD_PROTOCOL_SET,
 	CMD_RF_FIELD_ON,
 	CMD_RF_FIELD_OFF,
-	CMD_NUM_MAX,
+	CMD_FIFO_BENCH,
+	CMD_FIFO_FLUSH,
+	CMD_FIFO_LENGTH,
+	CMD_FIFO_READ,
+	CMD_FIFO_WRITE,
+	CMD_CCC_STATS,
+	CMD_USB_STATS,
+	CMD_SCHED_STATS,
+	CMD_NFC_TRANSCEIVE,
+	CMD_NFC_XFER_STATS,
+	CMD_ISO14443A_ACTIVATE,
+	CMD_ISO14443A_HALT,
+	CMD_ISO14443A_STATS,
+	CMD_INVENTORY_POLL,
+	CMD_INVENTORY_RESET,
+	CMD_INVENTORY_STATS,
+	CMD_POLL_START,
+	CMD_POLL_STOP,
+	CMD_POLL_STATS,
+	CMD_ISO14443_4_RATS,
+	CMD_ISO14443_4_PPS,
+	CMD_ISO14443_4_EXCHANGE,
+	CMD_ISO14443_4_DESELECT,
+	CMD_ISO14443_4_STATS,
+	CMD_MIFARE_KEY_SET,
+	CMD_MIFARE_SECTOR_READ,
+	CMD_MIFARE_SECTOR_WRITE,
+	CMD_MIFARE_DUMP,
+	CMD_MIFARE_STATS,
+	CMD_MIFARE_DICT_CLEAR,
+	CMD_MIFARE_DICT_ADD,
+	CMD_MIFARE_DICT_START,
+	CMD_MIFARE_DICT_STOP,
+	CMD_MIFARE_DICT_RESULT,
+	CMD_TYPE2_READ,
+	CMD_TYPE2_NDEF_READ,
+	CMD_TYPE2_STATS,
+	CMD_NUM_MAX
+};
+
+enum poll_flags {
+	POLL_FLAG_LPCD = BIT_0
+};
+
+enum rats_flags {
+	RATS_FLAG_RATE_RAISE = BIT_0
+};
+
+struct req {
+	const u8 *buf;
+	u32 size;
+	u32 pos;
 };
 
-enum { CMD_UNKNOWN = 0xAA, CMD_ACK = 0xBB, CMD_NAK = 0xFF };
+struct rsp {
+	u8 *buf;
+	u32 size;
+	u32 pos;
+};
+
+static enum cmd_status cmd_reg_read(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_reg_write(struct req *req, struct rsp *rsp);
+
+static enum cmd_status cmd_protocol_set(struct req *req, struct rsp *rsp);
+
+static enum cmd_status cmd_rf_field_on(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_rf_field_off(struct req *req, struct rsp *rsp);
+
+static enum cmd_status cmd_fifo_bench(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_fifo_flush(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_fifo_length(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_fifo_read(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_fifo_write(struct req *req, struct rsp *rsp);
+
+static enum cmd_status cmd_ccc_stats(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_usb_stats(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_sched_stats(struct req *req, struct rsp *rsp);
+
+static enum cmd_status cmd_nfc_transceive(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_nfc_xfer_stats(struct req *req, struct rsp *rsp);
+
+static enum cmd_status cmd_iso14443a_activate(struct req *req,
+					      struct rsp *rsp);
+static enum cmd_status cmd_iso14443a_halt(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_iso14443a_stats(struct req *req, struct rsp *rsp);
+
+static enum cmd_status cmd_inventory_poll(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_inventory_reset(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_inventory_stats(struct req *req, struct rsp *rsp);
+
+static enum cmd_status cmd_poll_start(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_poll_stop(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_poll_stats(struct req *req, struct rsp *rsp);
+
+static enum cmd_status cmd_iso14443_4_rats(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_iso14443_4_pps(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_iso14443_4_exchange(struct req *req,
+					       struct rsp *rsp);
+static enum cmd_status cmd_iso14443_4_deselect(struct req *req,
+					       struct rsp *rsp);
+static enum cmd_status cmd_iso14443_4_stats(struct req *req, struct rsp *rsp);
+
+static enum cmd_status cmd_mifare_key_set(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_mifare_sector_read(struct req *req,
+					      struct rsp *rsp);
+static enum cmd_status cmd_mifare_sector_write(struct req *req,
+					       struct rsp *rsp);
+static enum cmd_status cmd_mifare_dump(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_mifare_stats(struct req *req, struct rsp *rsp);
+
+static enum cmd_status cmd_mifare_dict_clear(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_mifare_dict_add(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_mifare_dict_start(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_mifare_dict_stop(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_mifare_dict_result(struct req *req,
+					      struct rsp *rsp);
+
+static enum cmd_status cmd_type2_read(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_type2_ndef_read(struct req *req, struct rsp *rsp);
+static enum cmd_status cmd_type2_stats(struct req *req, struct rsp *rsp);
 
 static struct {
-	void (*const cmd)(void);
-	const u32 num_params;
+	enum cmd_status (*const cmd)(struct req *req, struct rsp *rsp);
 } ccc_cmd[] = {
 	// clang-format off
 
-	[CMD_REG_READ] = {
-		.cmd		= cmd_reg_read,
-		.num_params	= 1
-	},
-
-	[CMD_REG_WRITE] = {
-		.cmd		= cmd_reg_write,
-		.num_params	= 2
-	},
-
-	[CMD_PROTOCOL_SET] = {
-		.cmd		= cmd_protocol_set,
-		.num_params	= 1
-	},
-
-	[CMD_RF_FIELD_ON] = {
-		.cmd		= cmd_rf_field_on,
-		.num_params	= 0,
-	},
-
-	[CMD_RF_FIELD_OFF] = {
-		.cmd		= cmd_rf_field_off,
-		.num_params	= 0
-	}
+	[CMD_REG_READ]		= { .cmd = cmd_reg_read },
+	[CMD_REG_WRITE]		= { .cmd = cmd_reg_write },
+	[CMD_PROTOCOL_SET]	= { .cmd = cmd_protocol_set },
+	[CMD_RF_FIELD_ON]	= { .cmd = cmd_rf_field_on },
+	[CMD_RF_FIELD_OFF]	= { .cmd = cmd_rf_field_off },
+	[CMD_FIFO_BENCH]	= { .cmd = cmd_fifo_bench },
+	[CMD_FIFO_FLUSH]	= { .cmd = cmd_fifo_flush },
+	[CMD_FIFO_LENGTH]	= { .cmd = cmd_fifo_length },
+	[CMD_FIFO_READ]		= { .cmd = cmd_fifo_read },
+	[CMD_FIFO_WRITE]	= { .cmd = cmd_fifo_write },
+	[CMD_CCC_STATS]		= { .cmd = cmd_ccc_stats },
+	[CMD_USB_STATS]		= { .cmd = cmd_usb_stats },
+	[CMD_SCHED_STATS]	= { .cmd = cmd_sched_stats },
+	[CMD_NFC_TRANSCEIVE]	= { .cmd = cmd_nfc_transceive },
+	[CMD_NFC_XFER_STATS]	= { .cmd = cmd_nfc_xfer_stats },
+	[CMD_ISO14443A_ACTIVATE] = { .cmd = cmd_iso14443a_activate },
+	[CMD_ISO14443A_HALT]	= { .cmd = cmd_iso14443a_halt },
+	[CMD_ISO14443A_STATS]	= { .cmd = cmd_iso14443a_stats },
+	[CMD_INVENTORY_POLL]	= { .cmd = cmd_inventory_poll },
+	[CMD_INVENTORY_RESET]	= { .cmd = cmd_inventory_reset },
+	[CMD_INVENTORY_STATS]	= { .cmd = cmd_inventory_stats },
+	[CMD_POLL_START]	= { .cmd = cmd_poll_start },
+	[CMD_POLL_STOP]		= { .cmd = cmd_poll_stop },
+	[CMD_POLL_STATS]	= { .cmd = cmd_poll_stats },
+	[CMD_ISO14443_4_RATS]	= { .cmd = cmd_iso14443_4_rats },
+	[CMD_ISO14443_4_PPS]	= { .cmd = cmd_iso14443_4_pps },
+	[CMD_ISO14443_4_EXCHANGE] = { .cmd = cmd_iso14443_4_exchange },
+	[CMD_ISO14443_4_DESELECT] = { .cmd = cmd_iso14443_4_deselect },
+	[CMD_ISO14443_4_STATS]	= { .cmd = cmd_iso14443_4_stats },
+	[CMD_MIFARE_KEY_SET]	= { .cmd = cmd_mifare_key_set },
+	[CMD_MIFARE_SECTOR_READ] = { .cmd = cmd_mifare_sector_read },
+	[CMD_MIFARE_SECTOR_WRITE] = { .cmd = cmd_mifare_sector_write },
+	[CMD_MIFARE_DUMP]	= { .cmd = cmd_mifare_dump },
+	[CMD_MIFARE_STATS]	= { .cmd = cmd_mifare_stats },
+	[CMD_MIFARE_DICT_CLEAR]	= { .cmd = cmd_mifare_dict_clear },
+	[CMD_MIFARE_DICT_ADD]	= { .cmd = cmd_mifare_dict_add },
+	[CMD_MIFARE_DICT_START]	= { .cmd = cmd_mifare_dict_start },
+	[CMD_MIFARE_DICT_STOP]	= { .cmd = cmd_mifare_dict_stop },
+	[CMD_MIFARE_DICT_RESULT] = { .cmd = cmd_mifare_dict_result },
+	[CMD_TYPE2_READ]	= { .cmd = cmd_type2_read },
+	[CMD_TYPE2_NDEF_READ]	= { .cmd = cmd_type2_ndef_read },
+	[CMD_TYPE2_STATS]	= { .cmd = cmd_type2_stats }
 
 	// clang-format on
 };
 
+struct link {
+	enum frame_state state;
+
+	u16 len;
+	u16 pos;
+	u8 seq;
+	u16 crc;
+	u16 crc_rx;
+};
+
 static struct {
-	enum ccc_state state;
+	struct link link[CCC_USB_LINK_NUM];
+
+	/** The link whose frame is being executed. */
+	enum ccc_usb_link active;
+
+	/** The card activated last, which MIFARE commands address. */
+	struct iso14443a_card card;
+
+	/** The link polling was started from, which events are sent on. */
+	enum ccc_usb_link event_link;
+	u8 event_seq;
+
+	u8 rx[CCC_USB_RX_SIZE_MAX];
 
 	struct {
-		enum ccc_cmd cmd;
-		u8 params[CMD_NUM_PARAMS_MAX];
-		u32 num_params;
-	} curr_cmd;
+		u32 bytes_rx;
+		u32 frames_rx;
+		u32 frames_bad;
+		u32 cmds;
+
+		/** Cycles spent parsing, excluding command execution. */
+		u32 parse_cycles;
+	} stats;
 } ccc_task;
 
-static void cmd_reg_read(void)
+// NFC_TRANSCEIVE sends straight out of the request and receives straight into
+// the response, so both are kept where the GPDMA can reach them.
+static GPDMA_MEM struct {
+	u8 req[CCC_USB_LINK_NUM][FRAME_PAYLOAD_SIZE_MAX];
+	u8 rsp[FRAME_PAYLOAD_SIZE_MAX];
+} frame_buf;
+
+static bool req_u8(struct req *const req, u8 *const val)
+{
+	if (req->pos + 1 > req->size)
+		return false;
+
+	*val = req->buf[req->pos++];
+	return true;
+}
+
+static bool req_u16(struct req *const req, u16 *const val)
+{
+	if (req->pos + 2 > req->size)
+		return false;
+
+	*val = req->buf[req->pos] | (req->buf[req->pos + 1] << 8);
+	req->pos += 2;
+
+	return true;
+}
+
+static bool req_u32(struct req *const req, u32 *const val)
+{
+	if (req->pos + 4 > req->size)
+		return false;
+
+	*val = req->buf[req->pos] | (req->buf[req->pos + 1] << 8) |
+	       (req->buf[req->pos + 2] << 16) |
+	       ((u32)req->buf[req->pos + 3] << 24);
+
+	req->pos += 4;
+	return true;
+}
+
+static const u8 *req_bytes(struct req *const req, const u32 size)
+{
+	if (req->pos + size > req->size)
+		return NULL;
+
+	const u8 *const bytes = &req->buf[req->pos];
+	req->pos += size;
+
+	return bytes;
+}
+
+static u32 rsp_space(const struct rsp *const rsp)
+{
+	return rsp->size - rsp->pos;
+}
+
+static u8 *rsp_reserve(struct rsp *const rsp, const u32 size)
+{
+	if (rsp->pos + size > rsp->size)
+		return NULL;
+
+	u8 *const bytes = &rsp->buf[rsp->pos];
+	rsp->pos += size;
+
+	return bytes;
+}
+
+static bool rsp_u8(struct rsp *const rsp, const u8 val)
+{
+	u8 *const dst = rsp_reserve(rsp, 1);
+
+	if (!dst)
+		return false;
+
+	dst[0] = val;
+	return true;
+}
+
+static bool rsp_u16(struct rsp *const rsp, const u16 val)
 {
-	const u8 byte = nfc_read_reg(ccc_task.curr_cmd.params[0]);
-	ccc_cdc_write_byte(byte);
+	u8 *const dst = rsp_reserve(rsp, 2);
+
+	if (!dst)
+		return false;
 
-	ccc_task.state = TASK_STATE_WAITING_FOR_CMD;
+	dst[0] = val >> 0;
+	dst[1] = val >> 8;
+
+	return true;
 }
 
-static void cmd_reg_write(void)
+static bool rsp_u32(struct rsp *const rsp, const u32 val)
 {
-	ccc_task.state = TASK_STATE_WAITING_FOR_CMD;
+	u8 *const dst = rsp_reserve(rsp, 4);
+
+	if (!dst)
+		return false;
+
+	dst[0] = val >> 0;
+	dst[1] = val >> 8;
+	dst[2] = val >> 16;
+	dst[3] = val >> 24;
+
+	return true;
 }
 
-static void cmd_protocol_set(void)
+/**
+ * Keeps the sessions of the card modules in step after a command which
+ * activated, halted or reset the card without them.
+ */
+static void card_session_reset(const bool selected)
 {
-	nfc_protocol_set(ccc_task.curr_cmd.params[0]);
-	ccc_cdc_write_byte(CMD_ACK);
+	mifare_classic_session_reset(selected);
+	type2_session_reset(selected);
+}
+
+static enum cmd_status cmd_reg_read(struct req *const req,
+				    struct rsp *const rsp)
+{
+	u8 reg;
+
+	if (!req_u8(req, &reg))
+		return CMD_STATUS_TRUNCATED;
+
+	if (!rsp_u8(rsp, nfc_read_reg(reg)))
+		return CMD_STATUS_NO_SPACE;
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_reg_write(struct req *const req,
+				     struct rsp *const rsp)
+{
+	(void)rsp;
+
+	u8 reg;
+	u8 val;
+
+	if (!req_u8(req, &reg) || !req_u8(req, &val))
+		return CMD_STATUS_TRUNCATED;
+
+	nfc_write_reg(reg, val);
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_protocol_set(struct req *const req,
+					struct rsp *const rsp)
+{
+	(void)rsp;
+
+	u8 protocol;
+
+	if (!req_u8(req, &protocol))
+		return CMD_STATUS_TRUNCATED;
 
-	ccc_task.state = TASK_STATE_WAITING_FOR_CMD;
+	if (protocol >= NFC_PROTOCOL_NUM)
+		return CMD_STATUS_NAK;
+
+	if (!nfc_protocol_set(protocol))
+		return CMD_STATUS_NAK;
+
+	return CMD_STATUS_ACK;
 }
 
-static void cmd_rf_field_on(void)
+static enum cmd_status cmd_rf_field_on(struct req *const req,
+				       struct rsp *const rsp)
 {
+	(void)req;
+	(void)rsp;
+
 	nfc_rf_field_enable();
-	ccc_cdc_write_byte(CMD_ACK);
+	card_session_reset(false);
 
-	ccc_task.state = TASK_STATE_WAITING_FOR_CMD;
+	return CMD_STATUS_ACK;
 }
 
-static void cmd_rf_field_off(void)
+static enum cmd_status cmd_rf_field_off(struct req *const req,
+					struct rsp *const rsp)
 {
+	(void)req;
+	(void)rsp;
+
 	nfc_rf_field_disable();
-	ccc_cdc_write_byte(CMD_ACK);
+	card_session_reset(false);
 
-	ccc_task.state = TASK_STATE_WAITING_FOR_CMD;
+	return CMD_STATUS_ACK;
 }
 
-static void handle_waiting_for_cmd(const u8 byte)
+static enum cmd_status cmd_fifo_bench(struct req *const req,
+				      struct rsp *const rsp)
 {
-	if (byte >= CMD_NUM_MAX) {
-		ccc_cdc_write_byte(CMD_NAK);
-		ccc_cdc_write_byte(CMD_UNKNOWN);
-		return;
+	u16 size;
+
+	if (!req_u16(req, &size))
+		return CMD_STATUS_TRUNCATED;
+
+	struct nfc_fifo_bench result;
+
+	if (!nfc_fifo_bench(size, &result))
+		return CMD_STATUS_NAK;
+
+	if (!rsp_u32(rsp, result.write_bps) || !rsp_u32(rsp, result.read_bps))
+		return CMD_STATUS_NO_SPACE;
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_fifo_flush(struct req *const req,
+				      struct rsp *const rsp)
+{
+	(void)req;
+	(void)rsp;
+
+	nfc_fifo_flush();
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_fifo_length(struct req *const req,
+				       struct rsp *const rsp)
+{
+	(void)req;
+
+	if (!rsp_u16(rsp, nfc_fifo_length()))
+		return CMD_STATUS_NO_SPACE;
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_fifo_read(struct req *const req,
+				     struct rsp *const rsp)
+{
+	u16 size;
+
+	if (!req_u16(req, &size))
+		return CMD_STATUS_TRUNCATED;
+
+	if (size > DRV_CLRC663_FIFO_NUM_BYTES_MAX)
+		return CMD_STATUS_NAK;
+
+	u8 *const dst = rsp_reserve(rsp, size);
+
+	if (!dst)
+		return CMD_STATUS_NO_SPACE;
+
+	nfc_fifo_read(dst, size);
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_fifo_write(struct req *const req,
+				      struct rsp *const rsp)
+{
+	(void)rsp;
+
+	u16 size;
+
+	if (!req_u16(req, &size))
+		return CMD_STATUS_TRUNCATED;
+
+	const u8 *const src = req_bytes(req, size);
+
+	if (!src)
+		return CMD_STATUS_TRUNCATED;
+
+	nfc_fifo_write(src, size);
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_ccc_stats(struct req *const req,
+				     struct rsp *const rsp)
+{
+	(void)req;
+
+	struct ccc_usb_tx_stats tx;
+	ccc_usb_tx_stats_get(ccc_task.active, &tx);
+
+	if (!rsp_u32(rsp, ccc_task.stats.bytes_rx) ||
+	    !rsp_u32(rsp, ccc_task.stats.frames_rx) ||
+	    !rsp_u32(rsp, ccc_task.stats.frames_bad) ||
+	    !rsp_u32(rsp, ccc_task.stats.cmds) ||
+	    !rsp_u32(rsp, dwt_cycles_to_us(ccc_task.stats.parse_cycles)) ||
+	    !rsp_u32(rsp, tx.bytes) || !rsp_u32(rsp, tx.packets) ||
+	    !rsp_u32(rsp, tx.flushes) || !rsp_u32(rsp, tx.drops))
+		return CMD_STATUS_NO_SPACE;
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_usb_stats(struct req *const req,
+				     struct rsp *const rsp)
+{
+	(void)req;
+
+	struct ccc_usb_dispatch_stats stats;
+	ccc_usb_dispatch_stats_get(&stats);
+
+	if (!rsp_u32(rsp, stats.events) || !rsp_u32(rsp, stats.dispatches) ||
+	    !rsp_u32(rsp, dwt_cycles_to_us(stats.latency_last)) ||
+	    !rsp_u32(rsp, dwt_cycles_to_us(stats.latency_max)))
+		return CMD_STATUS_NO_SPACE;
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_sched_stats(struct req *const req,
+				       struct rsp *const rsp)
+{
+	(void)req;
+
+	const u64 uptime_us = sched_time_us();
+
+	struct sched_idle_stats idle;
+	sched_idle_stats_get(&idle);
+
+	if (!rsp_u32(rsp, uptime_us >> 0) || !rsp_u32(rsp, uptime_us >> 32) ||
+	    !rsp_u32(rsp, idle.sleeps) || !rsp_u32(rsp, idle.sleep_total_us) ||
+	    !rsp_u32(rsp, idle.tick_wakes) ||
+	    !rsp_u32(rsp, idle.wake_latency_last) ||
+	    !rsp_u32(rsp, idle.wake_latency_max) ||
+	    !rsp_u8(rsp, SCHED_TASK_NUM))
+		return CMD_STATUS_NO_SPACE;
+
+	for (u32 task = 0; task < SCHED_TASK_NUM; ++task) {
+		struct sched_task_stats stats;
+		sched_task_stats_get(task, &stats);
+
+		if (!rsp_u32(rsp, stats.runs) ||
+		    !rsp_u32(rsp, stats.overruns) ||
+		    !rsp_u32(rsp, stats.deadline_misses) ||
+		    !rsp_u32(rsp, stats.time_total_us) ||
+		    !rsp_u32(rsp, stats.time_max_us))
+			return CMD_STATUS_NO_SPACE;
 	}
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_nfc_transceive(struct req *const req,
+					  struct rsp *const rsp)
+{
+	u8 flags;
+	u8 tx_last_bits;
+	u32 timeout_us;
+	u16 size;
+
+	if (!req_u8(req, &flags) || !req_u8(req, &tx_last_bits) ||
+	    !req_u32(req, &timeout_us) || !req_u16(req, &size))
+		return CMD_STATUS_TRUNCATED;
+
+	const u8 *const tx = req_bytes(req, size);
+
+	if (!tx)
+		return CMD_STATUS_TRUNCATED;
+
+	// The response is received straight into the response frame, behind
+	// the fixed part of the result.
+	u8 *const hdr = rsp_reserve(rsp, 8);
 
-	if (!ccc_cmd[byte].num_params)
-		ccc_cmd[byte].cmd();
-	else {
-		ccc_task.curr_cmd.cmd = byte;
-		ccc_task.curr_cmd.num_params = 0;
+	if (!hdr)
+		return CMD_STATUS_NO_SPACE;
+
+	const struct nfc_xfer xfer = {
+		// clang-format off
+
+		.tx		= tx,
+		.tx_size	= size,
+		.tx_last_bits	= tx_last_bits,
+		.flags		= flags,
+		.rx		= &rsp->buf[rsp->pos],
+		.rx_size_max	= rsp_space(rsp),
+		.timeout_us	= timeout_us
+
+		// clang-format on
+	};
+
+	struct nfc_xfer_result result;
+	nfc_transceive(&xfer, &result);
+
+	rsp->pos += result.rx_size;
+
+	const u32 latency_us = dwt_cycles_to_us(result.latency_cycles);
+
+	hdr[0] = result.status;
+	hdr[1] = result.rx_last_bits;
+	hdr[2] = latency_us >> 0;
+	hdr[3] = latency_us >> 8;
+	hdr[4] = latency_us >> 16;
+	hdr[5] = latency_us >> 24;
+	hdr[6] = result.rx_size >> 0;
+	hdr[7] = result.rx_size >> 8;
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_nfc_xfer_stats(struct req *const req,
+					  struct rsp *const rsp)
+{
+	(void)req;
+
+	struct nfc_xfer_stats stats;
+	nfc_xfer_stats_get(&stats);
+
+	if (!rsp_u32(rsp, stats.frames) || !rsp_u32(rsp, stats.errors) ||
+	    !rsp_u32(rsp, stats.timeouts) ||
+	    !rsp_u32(rsp, dwt_cycles_to_us(stats.latency_last)) ||
+	    !rsp_u32(rsp, dwt_cycles_to_us(stats.latency_max)))
+		return CMD_STATUS_NO_SPACE;
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_iso14443a_activate(struct req *const req,
+					      struct rsp *const rsp)
+{
+	u8 type;
+
+	if (!req_u8(req, &type))
+		return CMD_STATUS_TRUNCATED;
+
+	if (type > ISO14443A_REQ_WUPA)
+		return CMD_STATUS_NAK;
+
+	struct iso14443a_card card = { 0 };
+	const enum nfc_status status = iso14443a_activate(type, &card);
+
+	struct iso14443a_stats stats;
+	iso14443a_stats_get(&stats);
+
+	u32 time_us = 0;
+
+	if (status == NFC_STATUS_OK)
+		time_us = dwt_cycles_to_us(stats.time_last);
+	else
+		card.uid_size = 0;
+
+	ccc_task.card = card;
+	card_session_reset(status == NFC_STATUS_OK);
+
+	if (!rsp_u8(rsp, status) || !rsp_u8(rsp, card.atqa[0]) ||
+	    !rsp_u8(rsp, card.atqa[1]) || !rsp_u8(rsp, card.sak) ||
+	    !rsp_u32(rsp, time_us) || !rsp_u8(rsp, card.uid_size))
+		return CMD_STATUS_NO_SPACE;
+
+	u8 *const uid = rsp_reserve(rsp, card.uid_size);
+
+	if (!uid)
+		return CMD_STATUS_NO_SPACE;
+
+	memcpy(uid, card.uid, card.uid_size);
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_iso14443a_halt(struct req *const req,
+					  struct rsp *const rsp)
+{
+	(void)req;
 
-		ccc_task.state = TASK_STATE_WAITING_FOR_PARAMS;
+	const enum nfc_status status = iso14443a_halt();
+	card_session_reset(false);
+
+	if (!rsp_u8(rsp, status))
+		return CMD_STATUS_NO_SPACE;
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_iso14443a_stats(struct req *const req,
+					   struct rsp *const rsp)
+{
+	(void)req;
+
+	struct iso14443a_stats stats;
+	iso14443a_stats_get(&stats);
+
+	if (!rsp_u32(rsp, stats.activations) ||
+	    !rsp_u32(rsp, stats.failures) ||
+	    !rsp_u32(rsp, stats.collisions) ||
+	    !rsp_u32(rsp, dwt_cycles_to_us(stats.time_last)) ||
+	    !rsp_u32(rsp, dwt_cycles_to_us(stats.time_max)))
+		return CMD_STATUS_NO_SPACE;
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_inventory_poll(struct req *const req,
+					  struct rsp *const rsp)
+{
+	(void)req;
+
+	const u32 card_num = inventory_poll();
+	card_session_reset(false);
+
+	u8 *const hdr = rsp_reserve(rsp, 2);
+
+	if (!hdr)
+		return CMD_STATUS_NO_SPACE;
+
+	// Events which do not fit stay queued for the next poll.
+	u32 event_num = 0;
+	struct inventory_event event;
+
+	while ((rsp_space(rsp) >= (2 + ISO14443A_UID_SIZE_MAX)) &&
+	       inventory_event_pop(&event)) {
+		rsp_u8(rsp, event.type);
+		rsp_u8(rsp, event.card.uid_size);
+
+		memcpy(rsp_reserve(rsp, event.card.uid_size), event.card.uid,
+		       event.card.uid_size);
+
+		event_num++;
 	}
+
+	hdr[0] = card_num;
+	hdr[1] = event_num;
+
+	return CMD_STATUS_ACK;
 }
 
-static void handle_waiting_for_params(const u8 byte)
+static enum cmd_status cmd_inventory_reset(struct req *const req,
+					   struct rsp *const rsp)
 {
-	ccc_task.curr_cmd.params[ccc_task.curr_cmd.num_params++] = byte;
+	(void)req;
+	(void)rsp;
 
-	if (ccc_task.curr_cmd.num_params >=
-	    ccc_cmd[ccc_task.curr_cmd.cmd].num_params)
-		ccc_cmd[ccc_task.curr_cmd.cmd].cmd();
+	inventory_reset();
+	return CMD_STATUS_ACK;
 }
 
-static void process_byte(const u8 byte)
+static enum cmd_status cmd_inventory_stats(struct req *const req,
+					   struct rsp *const rsp)
 {
-	switch (ccc_task.state) {
-	case TASK_STATE_WAITING_FOR_CMD:
-		handle_waiting_for_cmd(byte);
+	(void)req;
+
+	struct inventory_stats stats;
+	inventory_stats_get(&stats);
+
+	if (!rsp_u32(rsp, stats.polls) || !rsp_u32(rsp, stats.branches) ||
+	    !rsp_u32(rsp, stats.checks) || !rsp_u32(rsp, stats.arrivals) ||
+	    !rsp_u32(rsp, stats.departures) ||
+	    !rsp_u32(rsp, stats.cards_dropped) ||
+	    !rsp_u32(rsp, stats.events_dropped) ||
+	    !rsp_u32(rsp, dwt_cycles_to_us(stats.time_last)) ||
+	    !rsp_u32(rsp, dwt_cycles_to_us(stats.time_max)))
+		return CMD_STATUS_NO_SPACE;
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_poll_start(struct req *const req,
+				      struct rsp *const rsp)
+{
+	(void)rsp;
+
+	u16 period_ms;
+	u8 techs;
+	u8 flags;
+
+	if (!req_u16(req, &period_ms) || !req_u8(req, &techs) ||
+	    !req_u8(req, &flags))
+		return CMD_STATUS_TRUNCATED;
+
+	const struct task_poll_cfg cfg = {
+		// clang-format off
+
+		.period_ms	= period_ms,
+		.techs		= techs,
+		.lpcd		= flags & POLL_FLAG_LPCD
+
+		// clang-format on
+	};
+
+	// The key search needs the CLRC663 to itself.
+	if (task_dict_running() || !task_poll_start(&cfg))
+		return CMD_STATUS_NAK;
+
+	// Polling activates and halts cards of its own accord.
+	card_session_reset(false);
+
+	ccc_task.event_link = ccc_task.active;
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_poll_stop(struct req *const req,
+				     struct rsp *const rsp)
+{
+	(void)req;
+	(void)rsp;
+
+	task_poll_stop();
+	card_session_reset(false);
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_poll_stats(struct req *const req,
+				      struct rsp *const rsp)
+{
+	(void)req;
+
+	struct task_poll_stats stats;
+	task_poll_stats_get(&stats);
+
+	if (!rsp_u8(rsp, task_poll_running()) || !rsp_u32(rsp, stats.polls) ||
+	    !rsp_u32(rsp, stats.events) || !rsp_u32(rsp, stats.events_lost) ||
+	    !rsp_u32(rsp, stats.period_last_us) ||
+	    !rsp_u32(rsp, stats.period_max_us) ||
+	    !rsp_u32(rsp, stats.detect_latency_last_us) ||
+	    !rsp_u32(rsp, stats.detect_latency_max_us) ||
+	    !rsp_u32(rsp, stats.field_on_last_us) ||
+	    !rsp_u32(rsp, stats.field_on_max_us) ||
+	    !rsp_u32(rsp, stats.lpcd_wakes) ||
+	    !rsp_u32(rsp, stats.lpcd_false_wakes) ||
+	    !rsp_u32(rsp, stats.lpcd_calibrations) ||
+	    !rsp_u32(rsp, stats.lpcd_calibration_failures))
+		return CMD_STATUS_NO_SPACE;
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_iso14443_4_rats(struct req *const req,
+					   struct rsp *const rsp)
+{
+	u8 flags;
+
+	if (!req_u8(req, &flags))
+		return CMD_STATUS_TRUNCATED;
+
+	struct iso14443_4_ats ats = { 0 };
+	enum nfc_status status = iso14443_4_rats(&ats);
+
+	enum iso14443_4_div ds = ISO14443_4_DIV_1;
+	enum iso14443_4_div dr = ISO14443_4_DIV_1;
+
+	if ((status == NFC_STATUS_OK) && (flags & RATS_FLAG_RATE_RAISE))
+		status = iso14443_4_rate_raise(&ats, &ds, &dr);
+
+	if (status != NFC_STATUS_OK)
+		ats.hist_size = 0;
+
+	if (!rsp_u8(rsp, status) || !rsp_u8(rsp, ds) || !rsp_u8(rsp, dr) ||
+	    !rsp_u16(rsp, ats.fsc) ||
+	    !rsp_u32(rsp, ats.fwt_us) || !rsp_u8(rsp, ats.ta) ||
+	    !rsp_u8(rsp, ats.tb) || !rsp_u8(rsp, ats.tc) ||
+	    !rsp_u8(rsp, ats.hist_size))
+		return CMD_STATUS_NO_SPACE;
+
+	u8 *const hist = rsp_reserve(rsp, ats.hist_size);
+
+	if (!hist)
+		return CMD_STATUS_NO_SPACE;
+
+	memcpy(hist, ats.hist, ats.hist_size);
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_iso14443_4_pps(struct req *const req,
+					  struct rsp *const rsp)
+{
+	u8 ds;
+	u8 dr;
+
+	if (!req_u8(req, &ds) || !req_u8(req, &dr))
+		return CMD_STATUS_TRUNCATED;
+
+	if ((ds > ISO14443_4_DIV_8) || (dr > ISO14443_4_DIV_8))
+		return CMD_STATUS_NAK;
+
+	if (!rsp_u8(rsp, iso14443_4_pps(ds, dr)))
+		return CMD_STATUS_NO_SPACE;
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_iso14443_4_exchange(struct req *const req,
+					       struct rsp *const rsp)
+{
+	u16 size;
+
+	if (!req_u16(req, &size))
+		return CMD_STATUS_TRUNCATED;
+
+	const u8 *const tx = req_bytes(req, size);
+
+	if (!tx)
+		return CMD_STATUS_TRUNCATED;
+
+	// As with NFC_TRANSCEIVE, the response is reassembled straight into
+	// the response frame.
+	u8 *const hdr = rsp_reserve(rsp, 7);
+
+	if (!hdr)
+		return CMD_STATUS_NO_SPACE;
+
+	u32 rx_size;
+	const enum nfc_status status = iso14443_4_exchange(
+		tx, size, &rsp->buf[rsp->pos], rsp_space(rsp), &rx_size);
+
+	struct iso14443_4_stats stats;
+	iso14443_4_stats_get(&stats);
+
+	u32 time_us = 0;
+
+	if (status == NFC_STATUS_OK)
+		time_us = dwt_cycles_to_us(stats.time_last);
+	else
+		rx_size = 0;
+
+	rsp->pos += rx_size;
+
+	hdr[0] = status;
+	hdr[1] = time_us >> 0;
+	hdr[2] = time_us >> 8;
+	hdr[3] = time_us >> 16;
+	hdr[4] = time_us >> 24;
+	hdr[5] = rx_size >> 0;
+	hdr[6] = rx_size >> 8;
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_iso14443_4_deselect(struct req *const req,
+					       struct rsp *const rsp)
+{
+	(void)req;
+
+	if (!rsp_u8(rsp, iso14443_4_deselect()))
+		return CMD_STATUS_NO_SPACE;
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_iso14443_4_stats(struct req *const req,
+					    struct rsp *const rsp)
+{
+	(void)req;
+
+	struct iso14443_4_stats stats;
+	iso14443_4_stats_get(&stats);
+
+	if (!rsp_u32(rsp, stats.exchanges) || !rsp_u32(rsp, stats.failures) ||
+	    !rsp_u32(rsp, stats.blocks_tx) || !rsp_u32(rsp, stats.blocks_rx) ||
+	    !rsp_u32(rsp, stats.retransmissions) ||
+	    !rsp_u32(rsp, stats.wtx) || !rsp_u32(rsp, stats.bytes_tx) ||
+	    !rsp_u32(rsp, stats.bytes_rx) ||
+	    !rsp_u32(rsp, dwt_cycles_to_us(stats.time_last)) ||
+	    !rsp_u32(rsp, dwt_cycles_to_us(stats.time_max)) ||
+	    !rsp_u32(rsp, stats.pps) || !rsp_u32(rsp, stats.pps_failures))
+		return CMD_STATUS_NO_SPACE;
+
+	for (u32 div = 0; div < ISO14443_4_DIV_NUM; div++) {
+		if (!rsp_u32(rsp, stats.sessions_ds[div]))
+			return CMD_STATUS_NO_SPACE;
+	}
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_mifare_key_set(struct req *const req,
+					  struct rsp *const rsp)
+{
+	(void)rsp;
+
+	u8 slot;
+
+	if (!req_u8(req, &slot))
+		return CMD_STATUS_TRUNCATED;
+
+	const u8 *const key = req_bytes(req, MIFARE_CLASSIC_KEY_SIZE);
+
+	if (!key)
+		return CMD_STATUS_TRUNCATED;
+
+	if (!mifare_classic_key_set(slot, key))
+		return CMD_STATUS_NAK;
+
+	return CMD_STATUS_ACK;
+}
+
+/** Reads the sector and key shared by the sector commands. */
+static enum cmd_status mifare_sector_req(struct req *const req,
+					 u8 *const sector,
+					 struct mifare_classic_key_ref *key)
+{
+	if (!req_u8(req, sector) || !req_u8(req, &key->type) ||
+	    !req_u8(req, &key->slot))
+		return CMD_STATUS_TRUNCATED;
+
+	if ((*sector >= MIFARE_CLASSIC_SECTOR_NUM_MAX) ||
+	    !mifare_classic_key_valid(key) || !ccc_task.card.uid_size)
+		return CMD_STATUS_NAK;
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_mifare_sector_read(struct req *const req,
+					      struct rsp *const rsp)
+{
+	u8 sector;
+	struct mifare_classic_key_ref key;
+
+	const enum cmd_status req_status = mifare_sector_req(req, &sector,
+							     &key);
+
+	if (req_status != CMD_STATUS_ACK)
+		return req_status;
+
+	const u32 size = mifare_classic_sector_size(sector);
+	u8 *const hdr = rsp_reserve(rsp, 1);
+
+	if (!hdr || (rsp_space(rsp) < size))
+		return CMD_STATUS_NO_SPACE;
+
+	hdr[0] = mifare_classic_sector_read(&ccc_task.card, sector, &key,
+					    &rsp->buf[rsp->pos]);
+
+	if (hdr[0] == NFC_STATUS_OK)
+		rsp->pos += size;
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_mifare_sector_write(struct req *const req,
+					       struct rsp *const rsp)
+{
+	u8 sector;
+	struct mifare_classic_key_ref key;
+
+	const enum cmd_status req_status = mifare_sector_req(req, &sector,
+							     &key);
+
+	if (req_status != CMD_STATUS_ACK)
+		return req_status;
+
+	const u32 size =
+		mifare_classic_sector_size(sector) - MIFARE_CLASSIC_BLOCK_SIZE;
+	const u8 *const data = req_bytes(req, size);
+
+	if (!data)
+		return CMD_STATUS_TRUNCATED;
+
+	const enum nfc_status status =
+		mifare_classic_sector_write(&ccc_task.card, sector, &key, data);
+
+	if (!rsp_u8(rsp, status))
+		return CMD_STATUS_NO_SPACE;
+
+	return CMD_STATUS_ACK;
+}
+
+struct mifare_dump_ctx {
+	struct rsp *rsp;
+	u32 sector_num;
+};
+
+static bool mifare_dump_sector(void *const ctx, const u8 sector,
+			       const enum nfc_status status,
+			       const u8 key_index, const u8 *const data,
+			       const u32 size)
+{
+	struct mifare_dump_ctx *const dump = ctx;
+	struct rsp *const rsp = dump->rsp;
+
+	(void)sector;
+
+	rsp_u8(rsp, status);
+	rsp_u8(rsp, key_index);
+
+	if (status == NFC_STATUS_OK)
+		memcpy(rsp_reserve(rsp, size), data, size);
+
+	dump->sector_num++;
+
+	// Stop short of a sector which might not fit.
+	return rsp_space(rsp) >= (2 + MIFARE_CLASSIC_SECTOR_SIZE_MAX);
+}
+
+static enum cmd_status cmd_mifare_dump(struct req *const req,
+				       struct rsp *const rsp)
+{
+	enum {
+		KEY_NUM_MAX = 16
+	};
+
+	u8 first;
+	u8 sector_num;
+	u8 key_num;
+
+	if (!req_u8(req, &first) || !req_u8(req, &sector_num) ||
+	    !req_u8(req, &key_num))
+		return CMD_STATUS_TRUNCATED;
+
+	struct mifare_classic_key_ref keys[KEY_NUM_MAX];
+
+	if ((key_num > KEY_NUM_MAX) || !key_num || !ccc_task.card.uid_size ||
+	    ((first + sector_num) > MIFARE_CLASSIC_SECTOR_NUM_MAX))
+		return CMD_STATUS_NAK;
+
+	for (u32 i = 0; i < key_num; i++) {
+		if (!req_u8(req, &keys[i].type) || !req_u8(req, &keys[i].slot))
+			return CMD_STATUS_TRUNCATED;
+
+		if (!mifare_classic_key_valid(&keys[i]))
+			return CMD_STATUS_NAK;
+	}
+
+	u8 *const hdr = rsp_reserve(rsp, 5);
+
+	if (!hdr || (rsp_space(rsp) < (2 + MIFARE_CLASSIC_SECTOR_SIZE_MAX)))
+		return CMD_STATUS_NO_SPACE;
+
+	struct mifare_dump_ctx dump = {
+		// clang-format off
+
+		.rsp		= rsp,
+		.sector_num	= 0
+
+		// clang-format on
+	};
+
+	if (sector_num)
+		mifare_classic_dump(&ccc_task.card, first, sector_num, keys,
+				    key_num, mifare_dump_sector, &dump);
+
+	struct mifare_classic_stats stats;
+	mifare_classic_stats_get(&stats);
+
+	const u32 time_us = dwt_cycles_to_us(stats.dump_time_last);
+
+	hdr[0] = dump.sector_num;
+	hdr[1] = time_us >> 0;
+	hdr[2] = time_us >> 8;
+	hdr[3] = time_us >> 16;
+	hdr[4] = time_us >> 24;
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_mifare_stats(struct req *const req,
+					struct rsp *const rsp)
+{
+	(void)req;
+
+	struct mifare_classic_stats stats;
+	mifare_classic_stats_get(&stats);
+
+	if (!rsp_u32(rsp, stats.auths) || !rsp_u32(rsp, stats.auth_failures) ||
+	    !rsp_u32(rsp, stats.auths_saved) ||
+	    !rsp_u32(rsp, stats.reselects) ||
+	    !rsp_u32(rsp, stats.blocks_read) ||
+	    !rsp_u32(rsp, stats.blocks_written) ||
+	    !rsp_u32(rsp, dwt_cycles_to_us(stats.dump_time_last)) ||
+	    !rsp_u32(rsp, dwt_cycles_to_us(stats.dump_time_max)))
+		return CMD_STATUS_NO_SPACE;
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_mifare_dict_clear(struct req *const req,
+					     struct rsp *const rsp)
+{
+	(void)req;
+	(void)rsp;
+
+	if (task_dict_running())
+		return CMD_STATUS_NAK;
+
+	task_dict_clear();
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_mifare_dict_add(struct req *const req,
+					   struct rsp *const rsp)
+{
+	u8 key_num;
+
+	if (!req_u8(req, &key_num))
+		return CMD_STATUS_TRUNCATED;
+
+	const u8 *const keys =
+		req_bytes(req, key_num * MIFARE_CLASSIC_KEY_SIZE);
+
+	if (!keys)
+		return CMD_STATUS_TRUNCATED;
+
+	if (!task_dict_add(keys, key_num))
+		return CMD_STATUS_NAK;
+
+	if (!rsp_u16(rsp, task_dict_size()))
+		return CMD_STATUS_NO_SPACE;
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_mifare_dict_start(struct req *const req,
+					     struct rsp *const rsp)
+{
+	(void)rsp;
+
+	struct task_dict_cfg cfg = { .card = ccc_task.card };
+
+	if (!req_u8(req, &cfg.first) || !req_u8(req, &cfg.sector_num) ||
+	    !req_u8(req, &cfg.types))
+		return CMD_STATUS_TRUNCATED;
+
+	if (!cfg.card.uid_size || task_poll_running() || task_dict_running())
+		return CMD_STATUS_NAK;
+
+	if (!task_dict_start(&cfg))
+		return CMD_STATUS_NAK;
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_mifare_dict_stop(struct req *const req,
+					    struct rsp *const rsp)
+{
+	(void)req;
+	(void)rsp;
+
+	task_dict_stop();
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_mifare_dict_result(struct req *const req,
+					      struct rsp *const rsp)
+{
+	(void)req;
+
+	struct task_dict_stats stats;
+	task_dict_stats_get(&stats);
+
+	const u32 attempts_per_sec =
+		stats.time_us ? (((u64)stats.attempts * mhz_to_hz(1)) /
+				 stats.time_us) :
+				0;
+
+	if (!rsp_u8(rsp, task_dict_running()) || !rsp_u8(rsp, stats.status) ||
+	    !rsp_u32(rsp, stats.attempts) || !rsp_u32(rsp, stats.hits) ||
+	    !rsp_u32(rsp, stats.time_us) || !rsp_u32(rsp, attempts_per_sec))
+		return CMD_STATUS_NO_SPACE;
+
+	for (u32 sector = 0; sector < MIFARE_CLASSIC_SECTOR_NUM_MAX; sector++) {
+		const u16 key_a = task_dict_hit(sector, MIFARE_CLASSIC_KEY_A);
+		const u16 key_b = task_dict_hit(sector, MIFARE_CLASSIC_KEY_B);
+
+		if (!rsp_u16(rsp, key_a) || !rsp_u16(rsp, key_b))
+			return CMD_STATUS_NO_SPACE;
+	}
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_type2_read(struct req *const req,
+				      struct rsp *const rsp)
+{
+	u8 first;
+	u8 page_num;
+
+	if (!req_u8(req, &first) || !req_u8(req, &page_num))
+		return CMD_STATUS_TRUNCATED;
+
+	if (!page_num || ((first + page_num) > 256) || !ccc_task.card.uid_size)
+		return CMD_STATUS_NAK;
+
+	const u32 size = page_num * TYPE2_PAGE_SIZE;
+	u8 *const hdr = rsp_reserve(rsp, 1);
+
+	if (!hdr || (rsp_space(rsp) < size))
+		return CMD_STATUS_NO_SPACE;
+
+	hdr[0] = type2_read(&ccc_task.card, first, page_num,
+			    &rsp->buf[rsp->pos]);
+
+	if (hdr[0] == NFC_STATUS_OK)
+		rsp->pos += size;
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_type2_ndef_read(struct req *const req,
+					   struct rsp *const rsp)
+{
+	(void)req;
+
+	if (!ccc_task.card.uid_size)
+		return CMD_STATUS_NAK;
+
+	// The message is copied straight into the response frame.
+	u8 *const hdr = rsp_reserve(rsp, 11);
+
+	if (!hdr)
+		return CMD_STATUS_NO_SPACE;
+
+	struct type2_cc cc;
+	u32 size;
+
+	const enum nfc_status status =
+		type2_ndef_read(&ccc_task.card, &cc, &rsp->buf[rsp->pos],
+				rsp_space(rsp), &size);
+
+	struct type2_stats stats;
+	type2_stats_get(&stats);
+
+	const u32 time_us = dwt_cycles_to_us(stats.ndef_time_last);
+
+	rsp->pos += size;
+
+	hdr[0] = status;
+	hdr[1] = cc.magic;
+	hdr[2] = cc.version;
+	hdr[3] = cc.size;
+	hdr[4] = cc.access;
+	hdr[5] = time_us >> 0;
+	hdr[6] = time_us >> 8;
+	hdr[7] = time_us >> 16;
+	hdr[8] = time_us >> 24;
+	hdr[9] = size >> 0;
+	hdr[10] = size >> 8;
+
+	return CMD_STATUS_ACK;
+}
+
+static enum cmd_status cmd_type2_stats(struct req *const req,
+				       struct rsp *const rsp)
+{
+	(void)req;
+
+	struct type2_stats stats;
+	type2_stats_get(&stats);
+
+	if (!rsp_u32(rsp, stats.fast_reads) || !rsp_u32(rsp, stats.reads) ||
+	    !rsp_u32(rsp, stats.fast_read_fallbacks) ||
+	    !rsp_u32(rsp, stats.pages_read) ||
+	    !rsp_u32(rsp, stats.ndef_reads) ||
+	    !rsp_u32(rsp, dwt_cycles_to_us(stats.ndef_time_last)) ||
+	    !rsp_u32(rsp, dwt_cycles_to_us(stats.ndef_time_max)))
+		return CMD_STATUS_NO_SPACE;
+
+	return CMD_STATUS_ACK;
+}
+
+static bool frame_send(const enum ccc_usb_link link, const u8 seq,
+		       const u8 *const payload, const u32 size)
+{
+	const u8 hdr[] = {
+		[0] = FRAME_SOF,
+		[1] = size >> 0,
+		[2] = size >> 8,
+		[3] = seq,
+	};
+
+	u16 crc = CRC16_CCITT_INIT;
+
+	for (u32 i = 1; i < sizeof(hdr); ++i)
+		crc = crc16_ccitt_update(crc, hdr[i]);
+
+	for (u32 i = 0; i < size; ++i)
+		crc = crc16_ccitt_update(crc, payload[i]);
+
+	const u8 trailer[] = {
+		[0] = crc >> 0,
+		[1] = crc >> 8,
+	};
+
+	// Queued as a unit, so that a frame which does not fit is dropped
+	// whole rather than leaving the host a partial one to resync from.
+	const struct ccc_usb_buf bufs[] = {
+		{ .data = hdr, .size = sizeof(hdr) },
+		{ .data = payload, .size = size },
+		{ .data = trailer, .size = sizeof(trailer) },
+	};
+
+	return ccc_usb_write(link, bufs, ARRAY_SIZE(bufs));
+}
+
+static void frame_send_status(const enum ccc_usb_link link,
+			      const enum frame_status status)
+{
+	const u8 payload = status;
+	frame_send(link, ccc_task.link[link].seq, &payload, sizeof(payload));
+}
+
+/**
+ * Whether @p opcode leaves the CLRC663 alone, so that it may run while card
+ * polling or a key search owns the chip. Anything else would disturb them: a
+ * register access wakes the CLRC663 from LPCD standby, and a new command
+ * replaces the one running.
+ */
+static bool cmd_chip_free(const u8 opcode)
+{
+	switch (opcode) {
+	case CMD_CCC_STATS:
+	case CMD_USB_STATS:
+	case CMD_SCHED_STATS:
+	case CMD_NFC_XFER_STATS:
+	case CMD_ISO14443A_STATS:
+	case CMD_INVENTORY_STATS:
+	case CMD_POLL_START:
+	case CMD_POLL_STOP:
+	case CMD_POLL_STATS:
+	case CMD_ISO14443_4_STATS:
+	case CMD_MIFARE_STATS:
+	case CMD_MIFARE_DICT_CLEAR:
+	case CMD_MIFARE_DICT_ADD:
+	case CMD_MIFARE_DICT_START:
+	case CMD_MIFARE_DICT_STOP:
+	case CMD_MIFARE_DICT_RESULT:
+	case CMD_TYPE2_STATS:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+static enum cmd_status cmd_exec(const u8 opcode, struct req *const req,
+				struct rsp *const rsp)
+{
+	if (opcode >= CMD_NUM_MAX)
+		return CMD_STATUS_UNKNOWN;
+
+	if ((task_poll_running() || task_dict_running()) &&
+	    !cmd_chip_free(opcode))
+		return CMD_STATUS_NAK;
+
+	return ccc_cmd[opcode].cmd(req, rsp);
+}
+
+static void frame_exec(const enum ccc_usb_link link)
+{
+	const u32 start = dwt_cyccnt_read();
+	const struct link *const l = &ccc_task.link[link];
+
+	ccc_task.active = link;
+
+	struct req req = {
+		// clang-format off
+
+		.buf	= frame_buf.req[link],
+		.size	= l->len,
+		.pos	= 0
+
+		// clang-format on
+	};
+
+	struct rsp rsp = {
+		// clang-format off
+
+		.buf	= frame_buf.rsp,
+		.size	= sizeof(frame_buf.rsp),
+		.pos	= 0
+
+		// clang-format on
+	};
+
+	rsp_u8(&rsp, FRAME_STATUS_OK);
+
+	while (req.pos < req.size) {
+		const u8 opcode = req.buf[req.pos++];
+		const u32 status_pos = rsp.pos;
+
+		if (!rsp_reserve(&rsp, 1))
+			break;
+
+		const enum cmd_status status = cmd_exec(opcode, &req, &rsp);
+
+		rsp.buf[status_pos] = status;
+		ccc_task.stats.cmds++;
+
+		if (status != CMD_STATUS_ACK) {
+			// Whatever the command managed to produce before
+			// failing is of no use to the host.
+			rsp.pos = status_pos + 1;
+			break;
+		}
+	}
+
+	frame_send(link, l->seq, rsp.buf, rsp.pos);
+
+	// task_ccc_tick() charges all of this to the parser; take it back out.
+	ccc_task.stats.parse_cycles -= dwt_cyccnt_read() - start;
+}
+
+static void process_byte(const enum ccc_usb_link link, const u8 byte)
+{
+	struct link *const l = &ccc_task.link[link];
+
+	switch (l->state) {
+	case FRAME_STATE_SOF:
+		if (byte == FRAME_SOF) {
+			l->crc = CRC16_CCITT_INIT;
+			l->state = FRAME_STATE_LEN_LO;
+		}
 		return;
 
-	case TASK_STATE_WAITING_FOR_PARAMS:
-		handle_waiting_for_params(byte);
+	case FRAME_STATE_LEN_LO:
+		l->crc = crc16_ccitt_update(l->crc, byte);
+		l->len = byte;
+		l->state = FRAME_STATE_LEN_HI;
+		return;
+
+	case FRAME_STATE_LEN_HI:
+		l->crc = crc16_ccitt_update(l->crc, byte);
+		l->len |= byte << 8;
+
+		// Swallowing an oversized or corrupted length would take every
+		// frame sent after it along; look for the next SOF instead.
+		if (l->len > sizeof(frame_buf.req[link])) {
+			l->state = FRAME_STATE_SOF;
+
+			ccc_task.stats.frames_rx++;
+			ccc_task.stats.frames_bad++;
+			frame_send_status(link, FRAME_STATUS_TOO_LONG);
+			return;
+		}
+
+		l->state = FRAME_STATE_SEQ;
+		return;
+
+	case FRAME_STATE_SEQ:
+		l->crc = crc16_ccitt_update(l->crc, byte);
+		l->seq = byte;
+		l->pos = 0;
+		l->state = l->len ? FRAME_STATE_PAYLOAD : FRAME_STATE_CRC_LO;
+		return;
+
+	case FRAME_STATE_PAYLOAD:
+		l->crc = crc16_ccitt_update(l->crc, byte);
+		frame_buf.req[link][l->pos] = byte;
+
+		if (++l->pos >= l->len)
+			l->state = FRAME_STATE_CRC_LO;
+		return;
+
+	case FRAME_STATE_CRC_LO:
+		l->crc_rx = byte;
+		l->state = FRAME_STATE_CRC_HI;
+		return;
+
+	case FRAME_STATE_CRC_HI:
+		l->crc_rx |= byte << 8;
+		l->state = FRAME_STATE_SOF;
+
+		ccc_task.stats.frames_rx++;
+
+		if (l->crc_rx != l->crc) {
+			ccc_task.stats.frames_bad++;
+			frame_send_status(link, FRAME_STATUS_BAD_CRC);
+		} else {
+			frame_exec(link);
+		}
 		return;
 
 	default:
@@ -180,9 +1658,65 @@ static void process_byte(const u8 byte)
 	}
 }
 
+static void link_tick(const enum ccc_usb_link link)
+{
+	// Consume everything the host has sent so far rather than a byte per
+	// pass of the main loop, as far as the time budget allows. Whatever is
+	// left over is picked up on the next run.
+	u32 size;
+
+	while ((size = ccc_usb_read(link, ccc_task.rx, sizeof(ccc_task.rx)))) {
+		ccc_task.stats.bytes_rx += size;
+
+		for (u32 i = 0; i < size; ++i) {
+			const u32 start = dwt_cyccnt_read();
+
+			process_byte(link, ccc_task.rx[i]);
+
+			const u32 cycles = dwt_cyccnt_read() - start;
+			ccc_task.stats.parse_cycles += cycles;
+		}
+
+		if (sched_budget_expired()) {
+			sched_signal(SCHED_TASK_CCC);
+			break;
+		}
+	}
+
+	// Every reply produced above has only been queued; push them out in as
+	// few packets as possible.
+	ccc_usb_flush(link);
+}
+
+bool task_ccc_poll_event_send(const struct task_poll_event *const event)
+{
+	const enum ccc_usb_link link = ccc_task.event_link;
+	const struct iso14443a_card *const card = &event->card;
+
+	u8 payload[8 + ISO14443A_UID_SIZE_MAX];
+
+	payload[0] = FRAME_STATUS_EVENT;
+	payload[1] = event->type;
+	payload[2] = event->tech;
+	payload[3] = event->time_us >> 0;
+	payload[4] = event->time_us >> 8;
+	payload[5] = event->time_us >> 16;
+	payload[6] = event->time_us >> 24;
+	payload[7] = card->uid_size;
+	memcpy(&payload[8], card->uid, card->uid_size);
+
+	if (!frame_send(link, ccc_task.event_seq++, payload,
+			8 + card->uid_size))
+		return false;
+
+	// Events are rare and urgent, so they do not wait for the end of the
+	// host command task's next run.
+	ccc_usb_flush(link);
+	return true;
+}
+
 void task_ccc_tick(void)
 {
-	u8 byte;
-	if (ccc_cdc_read_byte(&byte))
-		process_byte(byte);
-}
\ No newline at end of file
+	for (u32 link = 0; link < CCC_USB_LINK_NUM; ++link)
+		link_tick(link);
+}
@@ -22,4 +22,16 @@
 
 #pragma once
 
-void task_ccc_tick(void);
\ No newline at end of file
+#include <stdbool.h>
+
+#include "task-poll.h"
+
+void task_ccc_tick(void);
+
+/**
+ * Sends @p event to the host unsolicited, on the interface polling was
+ * started from.
+ *
+ * @returns false if the host is not connected.
+ */
+bool task_ccc_poll_event_send(const struct task_poll_event *event);
\ No newline at end of file
@@ -0,0 +1,224 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <string.h>
+
+#include "board/nfc/iso14443a.h"
+#include "board/nfc/mifare-classic.h"
+#include "board/nfc/nfc.h"
+#include "common/types.h"
+#include "common/util.h"
+#include "hal/util.h"
+#include "sched.h"
+#include "task-dict.h"
+
+enum {
+	TYPE_NUM = MIFARE_CLASSIC_KEY_B + 1,
+	TYPES_VALID = (1U << TYPE_NUM) - 1
+};
+
+static struct {
+	u8 keys[TASK_DICT_KEY_NUM_MAX][MIFARE_CLASSIC_KEY_SIZE];
+	u32 key_num;
+
+	bool running;
+	struct task_dict_cfg cfg;
+
+	/** The sector and key type being searched */
+	u8 sector;
+	u8 type;
+
+	/**
+	 * The next candidate: 0 is the key found last, which cards tend to
+	 * reuse across sectors, and n the dictionary's key n - 1.
+	 */
+	u32 pos;
+	u16 key_last;
+
+	u16 hits[MIFARE_CLASSIC_SECTOR_NUM_MAX][TYPE_NUM];
+
+	u64 start_us;
+	struct task_dict_stats stats;
+} dict;
+
+void task_dict_clear(void)
+{
+	if (!dict.running)
+		dict.key_num = 0;
+}
+
+bool task_dict_add(const u8 *const keys, const u32 key_num)
+{
+	if (dict.running || (key_num > (TASK_DICT_KEY_NUM_MAX - dict.key_num)))
+		return false;
+
+	memcpy(dict.keys[dict.key_num], keys,
+	       key_num * MIFARE_CLASSIC_KEY_SIZE);
+	dict.key_num += key_num;
+
+	return true;
+}
+
+u32 task_dict_size(void)
+{
+	return dict.key_num;
+}
+
+/** Moves on to the next key type, and sector; false once all are done. */
+static bool target_next(void)
+{
+	dict.pos = (dict.key_last == TASK_DICT_KEY_NONE) ? 1 : 0;
+
+	do {
+		if (++dict.type == TYPE_NUM) {
+			dict.type = 0;
+
+			if (++dict.sector ==
+			    (dict.cfg.first + dict.cfg.sector_num))
+				return false;
+		}
+	} while (!(dict.cfg.types & (1U << dict.type)));
+
+	return true;
+}
+
+static void finish(const enum nfc_status status)
+{
+	dict.stats.status = status;
+	dict.stats.time_us = sched_time_us() - dict.start_us;
+	dict.running = false;
+
+	// Leave the card in plain, as after any other command. It has to be
+	// selected again before it takes plain commands.
+	nfc_crypto1_disable();
+	mifare_classic_session_reset(false);
+}
+
+/** Tries the next candidate; false once the search has ended. */
+static bool attempt(void)
+{
+	// The key found last comes first, and is not tried twice.
+	if ((dict.pos > 0) && ((dict.pos - 1) == dict.key_last))
+		dict.pos++;
+
+	if (dict.pos > dict.key_num) {
+		if (!target_next()) {
+			finish(NFC_STATUS_OK);
+			return false;
+		}
+
+		return true;
+	}
+
+	const u16 index = dict.pos ? (dict.pos - 1) : dict.key_last;
+	dict.pos++;
+
+	const enum nfc_status status = mifare_classic_key_try(
+		&dict.cfg.card, dict.sector, dict.type, dict.keys[index]);
+
+	dict.stats.attempts++;
+
+	if (status == NFC_STATUS_AUTH)
+		return true;
+
+	if (status != NFC_STATUS_OK) {
+		finish(status);
+		return false;
+	}
+
+	dict.stats.hits++;
+	dict.hits[dict.sector][dict.type] = index;
+	dict.key_last = index;
+
+	if (!target_next()) {
+		finish(NFC_STATUS_OK);
+		return false;
+	}
+
+	return true;
+}
+
+void task_dict_tick(void)
+{
+	if (!dict.running)
+		return;
+
+	while (attempt()) {
+		if (sched_budget_expired()) {
+			sched_signal(SCHED_TASK_DICT);
+			return;
+		}
+	}
+}
+
+bool task_dict_start(const struct task_dict_cfg *const cfg)
+{
+	if (!dict.key_num || !cfg->sector_num ||
+	    ((cfg->first + cfg->sector_num) > MIFARE_CLASSIC_SECTOR_NUM_MAX) ||
+	    !(cfg->types & TYPES_VALID) || (cfg->types & ~TYPES_VALID))
+		return false;
+
+	dict.cfg = *cfg;
+	dict.key_last = TASK_DICT_KEY_NONE;
+
+	memset(dict.hits, 0xFF, sizeof(dict.hits));
+
+	dict.sector = cfg->first;
+	dict.type = (cfg->types & (1U << MIFARE_CLASSIC_KEY_A)) ?
+			    MIFARE_CLASSIC_KEY_A :
+			    MIFARE_CLASSIC_KEY_B;
+	dict.pos = 1;
+
+	dict.stats = (struct task_dict_stats){ 0 };
+	dict.start_us = sched_time_us();
+	dict.running = true;
+
+	sched_signal(SCHED_TASK_DICT);
+	return true;
+}
+
+void task_dict_stop(void)
+{
+	if (dict.running)
+		finish(NFC_STATUS_OK);
+}
+
+bool task_dict_running(void)
+{
+	return dict.running;
+}
+
+u16 task_dict_hit(const u8 sector, const u8 type)
+{
+	app_assert((sector < MIFARE_CLASSIC_SECTOR_NUM_MAX) &&
+		   (type < TYPE_NUM));
+
+	return dict.hits[sector][type];
+}
+
+void task_dict_stats_get(struct task_dict_stats *const stats)
+{
+	*stats = dict.stats;
+
+	if (dict.running)
+		stats->time_us = sched_time_us() - dict.start_us;
+}
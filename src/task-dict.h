@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "board/nfc/iso14443a.h"
+#include "board/nfc/mifare-classic.h"
+#include "common/types.h"
+
+enum {
+	/** Candidate keys the dictionary holds */
+	TASK_DICT_KEY_NUM_MAX = 512,
+
+	/** Marks a sector and key type for which no key was found */
+	TASK_DICT_KEY_NONE = 0xFFFF
+};
+
+struct task_dict_cfg {
+	/** The card to search, which must have been activated last */
+	struct iso14443a_card card;
+
+	u8 first;
+	u8 sector_num;
+
+	/** The key types to search for; bit 0 is key A, bit 1 key B */
+	u8 types;
+};
+
+struct task_dict_stats {
+	u32 attempts;
+	u32 hits;
+
+	/** Time the latest search has run for, in microseconds */
+	u32 time_us;
+
+	/** Why the latest search ended early; NFC_STATUS_OK if it did not */
+	u32 status;
+};
+
+/**
+ * Tries candidate keys on a run of sectors in the background, one
+ * authentication at a time, for as long as the task's budget allows per run.
+ */
+void task_dict_tick(void);
+
+void task_dict_clear(void);
+
+/**
+ * Appends @p key_num keys of MIFARE_CLASSIC_KEY_SIZE bytes each to the
+ * dictionary.
+ *
+ * @returns false if they do not fit, or a search is running.
+ */
+bool task_dict_add(const u8 *keys, u32 key_num);
+
+u32 task_dict_size(void);
+
+/**
+ * Starts searching the dictionary for the keys of the sectors in @p cfg,
+ * forgetting the results of any previous search.
+ *
+ * @returns false if @p cfg is out of range or the dictionary empty.
+ */
+bool task_dict_start(const struct task_dict_cfg *cfg);
+
+void task_dict_stop(void);
+bool task_dict_running(void);
+
+/**
+ * The dictionary index of the key found for @p sector and @p type in the
+ * latest search, or TASK_DICT_KEY_NONE.
+ */
+u16 task_dict_hit(u8 sector, u8 type);
+
+void task_dict_stats_get(struct task_dict_stats *stats);
@@ -0,0 +1,304 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "board/nfc/inventory.h"
+#include "board/nfc/lpcd.h"
+#include "board/nfc/nfc.h"
+#include "common/types.h"
+#include "common/util.h"
+#include "hal/util.h"
+#include "sched.h"
+#include "task-ccc.h"
+#include "task-poll.h"
+
+enum poll_state {
+	/** Not polling; the field is off. */
+	POLL_STATE_STOPPED,
+
+	/** Waiting for the next poll; the field is off. */
+	POLL_STATE_WAIT,
+
+	/** The field is on, and the cards are powering up. */
+	POLL_STATE_GUARD,
+
+	/** The CLRC663 is watching the antenna for a card to arrive. */
+	POLL_STATE_LPCD
+};
+
+static const struct {
+	const enum nfc_protocol protocol;
+
+	/**
+	 * Runs one detection cycle, queueing inventory events, and returns
+	 * the number of cards present.
+	 */
+	u32 (*const detect)(void);
+} tech_tbl[TASK_POLL_TECH_NUM] = {
+	// clang-format off
+
+	[TASK_POLL_TECH_ISO14443A] = {
+		.protocol	= NFC_PROTOCOL_MIFARE_106,
+		.detect		= inventory_poll
+	}
+
+	// clang-format on
+};
+
+static struct {
+	enum poll_state state;
+	struct task_poll_cfg cfg;
+	enum task_poll_tech tech;
+
+	u32 next_ms;
+	u32 field_on_ms;
+	u64 start_us;
+	u64 prev_start_us;
+
+	struct nfc_lpcd_cal lpcd_cal;
+	bool lpcd_cal_needed;
+
+	/** Whether the poll in progress was started by LPCD */
+	bool lpcd_woken;
+
+	struct task_poll_stats stats;
+} task_poll;
+
+static void max_update(u32 *const max, const u32 val)
+{
+	if (val > *max)
+		*max = val;
+}
+
+static enum task_poll_tech tech_next(const enum task_poll_tech tech)
+{
+	for (u32 i = 1; i <= TASK_POLL_TECH_NUM; ++i) {
+		const u32 next = (tech + i) % TASK_POLL_TECH_NUM;
+
+		if (task_poll.cfg.techs & (1U << next))
+			return next;
+	}
+
+	UNREACHABLE;
+}
+
+static void field_on(const u32 now)
+{
+	const u64 start_us = sched_time_us();
+
+	if (task_poll.stats.polls) {
+		const u32 period = start_us - task_poll.prev_start_us;
+
+		task_poll.stats.period_last_us = period;
+		max_update(&task_poll.stats.period_max_us, period);
+	}
+
+	task_poll.prev_start_us = start_us;
+	task_poll.start_us = start_us;
+
+	// Every poll starts from a freshly loaded protocol, as the host may
+	// have changed the CLRC663 configuration in between.
+	nfc_protocol_set(tech_tbl[task_poll.tech].protocol);
+	nfc_rf_field_enable();
+
+	task_poll.field_on_ms = now;
+	task_poll.state = POLL_STATE_GUARD;
+}
+
+static void events_send(void)
+{
+	struct inventory_event inv;
+
+	while (inventory_event_pop(&inv)) {
+		const enum task_poll_event_type type =
+			(inv.type == INVENTORY_EVENT_ARRIVED) ?
+				TASK_POLL_EVENT_PRESENT :
+				TASK_POLL_EVENT_REMOVED;
+
+		const struct task_poll_event event = {
+			// clang-format off
+
+			.type		= type,
+			.tech		= task_poll.tech,
+			.time_us	= task_poll.start_us,
+			.card		= inv.card
+
+			// clang-format on
+		};
+
+		task_poll.stats.events++;
+
+		if (!task_ccc_poll_event_send(&event)) {
+			task_poll.stats.events_lost++;
+			continue;
+		}
+
+		const u32 latency = sched_time_us() - task_poll.start_us;
+
+		task_poll.stats.detect_latency_last_us = latency;
+		max_update(&task_poll.stats.detect_latency_max_us, latency);
+	}
+}
+
+/**
+ * Hands over to LPCD, calibrating it first if there is no reference for the
+ * empty field yet, or if the latest one let a change in the environment wake
+ * the loop up for nothing.
+ */
+static void lpcd_enter(void)
+{
+	if (task_poll.lpcd_cal_needed) {
+		task_poll.stats.lpcd_calibrations++;
+
+		if (!nfc_lpcd_calibrate(&task_poll.lpcd_cal)) {
+			task_poll.stats.lpcd_calibration_failures++;
+			task_poll.state = POLL_STATE_WAIT;
+			return;
+		}
+
+		task_poll.lpcd_cal_needed = false;
+	}
+
+	nfc_lpcd_arm(&task_poll.lpcd_cal, task_poll.cfg.period_ms);
+	task_poll.state = POLL_STATE_LPCD;
+}
+
+static void poll(void)
+{
+	const u32 card_num = tech_tbl[task_poll.tech].detect();
+
+	nfc_rf_field_disable();
+
+	const u32 field_on = sched_time_us() - task_poll.start_us;
+
+	task_poll.stats.polls++;
+	task_poll.stats.field_on_last_us = field_on;
+	max_update(&task_poll.stats.field_on_max_us, field_on);
+
+	events_send();
+
+	if (task_poll.lpcd_woken && !card_num) {
+		task_poll.stats.lpcd_false_wakes++;
+		task_poll.lpcd_cal_needed = true;
+	}
+
+	task_poll.lpcd_woken = false;
+	task_poll.tech = tech_next(task_poll.tech);
+
+	// Cards present are polled for periodically, so that their removal
+	// is noticed; LPCD only takes over once the field is empty again.
+	if (task_poll.cfg.lpcd && !card_num)
+		lpcd_enter();
+	else
+		task_poll.state = POLL_STATE_WAIT;
+}
+
+void task_poll_tick(void)
+{
+	const u32 now = sched_time_ms();
+
+	switch (task_poll.state) {
+	case POLL_STATE_STOPPED:
+		return;
+
+	case POLL_STATE_WAIT:
+		if ((s32)(now - task_poll.next_ms) < 0)
+			return;
+
+		// Polls are spaced from their scheduled start, so a late one
+		// does not push back all that follow.
+		task_poll.next_ms += task_poll.cfg.period_ms;
+
+		if ((s32)(now - task_poll.next_ms) >= 0)
+			task_poll.next_ms = now + task_poll.cfg.period_ms;
+
+		field_on(now);
+		return;
+
+	case POLL_STATE_GUARD:
+		if ((now - task_poll.field_on_ms) < TASK_POLL_GUARD_MS)
+			return;
+
+		poll();
+		return;
+
+	case POLL_STATE_LPCD:
+		if (!nfc_lpcd_triggered())
+			return;
+
+		nfc_lpcd_disarm();
+
+		task_poll.stats.lpcd_wakes++;
+		task_poll.lpcd_woken = true;
+
+		field_on(now);
+		return;
+
+	default:
+		app_assert(false);
+		return;
+	}
+}
+
+bool task_poll_start(const struct task_poll_cfg *const cfg)
+{
+	const u32 techs_valid = (1U << TASK_POLL_TECH_NUM) - 1;
+
+	if ((cfg->period_ms < TASK_POLL_PERIOD_MIN_MS) || !cfg->techs ||
+	    (cfg->techs & ~techs_valid))
+		return false;
+
+	task_poll_stop();
+
+	task_poll.cfg = *cfg;
+	task_poll.tech = tech_next(TASK_POLL_TECH_NUM - 1);
+	task_poll.next_ms = sched_time_ms();
+	task_poll.state = POLL_STATE_WAIT;
+	task_poll.lpcd_cal_needed = true;
+	task_poll.lpcd_woken = false;
+
+	// Start from an empty set, so that the cards already in the field
+	// are reported by the first poll.
+	inventory_reset();
+
+	task_poll.stats = (struct task_poll_stats){ 0 };
+	return true;
+}
+
+void task_poll_stop(void)
+{
+	if (task_poll.state == POLL_STATE_GUARD)
+		nfc_rf_field_disable();
+	else if (task_poll.state == POLL_STATE_LPCD)
+		nfc_lpcd_disarm();
+
+	task_poll.state = POLL_STATE_STOPPED;
+}
+
+bool task_poll_running(void)
+{
+	return task_poll.state != POLL_STATE_STOPPED;
+}
+
+void task_poll_stats_get(struct task_poll_stats *const stats)
+{
+	*stats = task_poll.stats;
+}
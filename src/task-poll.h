@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "board/nfc/iso14443a.h"
+#include "common/types.h"
+
+/** The card technologies the poll loop can rotate through. */
+enum task_poll_tech {
+	TASK_POLL_TECH_ISO14443A,
+	TASK_POLL_TECH_NUM
+};
+
+enum task_poll_event_type {
+	TASK_POLL_EVENT_PRESENT,
+	TASK_POLL_EVENT_REMOVED
+};
+
+struct task_poll_event {
+	enum task_poll_event_type type;
+	enum task_poll_tech tech;
+
+	/** When the poll which found the change started, in microseconds */
+	u32 time_us;
+
+	struct iso14443a_card card;
+};
+
+struct task_poll_cfg {
+	/** Time from the start of one poll to the start of the next */
+	u32 period_ms;
+
+	/** The technologies to poll, one per period in turn; a BIT() mask */
+	u32 techs;
+
+	/**
+	 * While no card is present, leaves it to the CLRC663's low-power card
+	 * detection to notice one arriving, rather than polling. LPCD then
+	 * measures every period_ms.
+	 */
+	bool lpcd;
+};
+
+struct task_poll_stats {
+	u32 polls;
+	u32 events;
+
+	/**
+	 * Events which could not be sent, as the host was not connected or
+	 * had stopped reading
+	 */
+	u32 events_lost;
+
+	/** Time from one poll starting to the next, in microseconds */
+	u32 period_last_us;
+	u32 period_max_us;
+
+	/** Time from switching the field on to the last event being sent */
+	u32 detect_latency_last_us;
+	u32 detect_latency_max_us;
+
+	/** Time the field was on for a poll, in microseconds */
+	u32 field_on_last_us;
+	u32 field_on_max_us;
+
+	u32 lpcd_wakes;
+
+	/** Wake-ups after which no card was found */
+	u32 lpcd_false_wakes;
+
+	u32 lpcd_calibrations;
+
+	/** Calibrations which failed, leaving the loop polling instead */
+	u32 lpcd_calibration_failures;
+};
+
+enum {
+	/**
+	 * Cards need this long after the field has come up before they can be
+	 * addressed; ISO/IEC 14443-3 requires at least 5 ms.
+	 */
+	TASK_POLL_GUARD_MS = 5,
+
+	TASK_POLL_PERIOD_MIN_MS = 2 * TASK_POLL_GUARD_MS
+};
+
+void task_poll_tick(void);
+
+/**
+ * Starts polling autonomously. The field is only on during a poll, and every
+ * change in the cards present is passed to task_ccc_poll_event_send().
+ *
+ * @returns false if @p cfg is invalid.
+ */
+bool task_poll_start(const struct task_poll_cfg *cfg);
+
+/** Stops polling, switching the field off if a poll was in progress. */
+void task_poll_stop(void);
+
+bool task_poll_running(void);
+
+void task_poll_stats_get(struct task_poll_stats *stats);
@@ -0,0 +1,537 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "common/crc.h"
+#include "fake/hw.h"
+#include "fake/usb.h"
+#include "task-ccc.h"
+
+#include "test.h"
+
+// The host command parser, fed through the CDC link as the host would and
+// checked only by the frames it sends back.
+
+enum {
+	SOF = 0x7E,
+	PAYLOAD_SIZE_MAX = 1024,
+	FRAME_SIZE_MAX = 4 + PAYLOAD_SIZE_MAX + 2,
+
+	STATUS_OK = 0x00,
+	STATUS_BAD_CRC = 0x01,
+	STATUS_TOO_LONG = 0x02,
+
+	CMD_REG_WRITE = 0x01,
+	CMD_CCC_STATS = 0x0A,
+	CMD_UNKNOWN = 0x7F,
+
+	CMD_UNKNOWN_STATUS = 0xAA,
+	CMD_ACK = 0xBB,
+	CMD_TRUNCATED = 0xCC,
+
+	CCC_STATS_SIZE = 9 * 4
+};
+
+struct frame {
+	u8 seq;
+	u8 payload[PAYLOAD_SIZE_MAX];
+	u32 size;
+};
+
+enum ccc_stat {
+	STAT_BYTES_RX,
+	STAT_FRAMES_RX,
+	STAT_FRAMES_BAD,
+	STAT_CMDS,
+	STAT_TX_DROPS = 8
+};
+
+static struct {
+	u8 buf[1 << 16];
+	u32 size;
+	u32 pos;
+} host;
+
+static u32 encode(u8 *const dst, const u8 seq, const u8 *const payload,
+		  const u32 size)
+{
+	dst[0] = SOF;
+	dst[1] = size >> 0;
+	dst[2] = size >> 8;
+	dst[3] = seq;
+	memcpy(&dst[4], payload, size);
+
+	u16 crc = CRC16_CCITT_INIT;
+
+	for (u32 i = 1; i < 4 + size; ++i)
+		crc = crc16_ccitt_update(crc, dst[i]);
+
+	dst[4 + size] = crc >> 0;
+	dst[5 + size] = crc >> 8;
+
+	return 4 + size + 2;
+}
+
+static void send(const u8 seq, const u8 *const payload, const u32 size)
+{
+	u8 buf[FRAME_SIZE_MAX];
+	const u32 frame_size = encode(buf, seq, payload, size);
+
+	hw_usb_host_send(CCC_USB_LINK_CDC, buf, frame_size);
+}
+
+static void run(void)
+{
+	while (hw_usb_host_pending(CCC_USB_LINK_CDC))
+		task_ccc_tick();
+
+	host.size += hw_usb_host_recv(CCC_USB_LINK_CDC, &host.buf[host.size],
+				      sizeof(host.buf) - host.size);
+}
+
+static u32 host_u8(void)
+{
+	CHECK(host.pos < host.size);
+	return host.buf[host.pos++];
+}
+
+/** Returns false once everything received so far has been taken. */
+static bool recv(struct frame *const f)
+{
+	if (host.pos == host.size)
+		return false;
+
+	CHECK_EQ(host_u8(), SOF);
+
+	u16 crc = CRC16_CCITT_INIT;
+	u8 hdr[3];
+
+	for (u32 i = 0; i < sizeof(hdr); ++i) {
+		hdr[i] = host_u8();
+		crc = crc16_ccitt_update(crc, hdr[i]);
+	}
+
+	f->size = hdr[0] | (hdr[1] << 8);
+	f->seq = hdr[2];
+
+	CHECK(f->size <= sizeof(f->payload));
+
+	for (u32 i = 0; i < f->size; ++i) {
+		f->payload[i] = host_u8();
+		crc = crc16_ccitt_update(crc, f->payload[i]);
+	}
+
+	const u32 crc_lo = host_u8();
+	CHECK_EQ(crc_lo | (host_u8() << 8), crc);
+
+	return true;
+}
+
+static void recv_status(const u8 seq, const u8 status)
+{
+	struct frame f;
+
+	CHECK(recv(&f));
+	CHECK_EQ(f.seq, seq);
+	CHECK_EQ(f.size, 1);
+	CHECK_EQ(f.payload[0], status);
+}
+
+static u32 le32(const u8 *const p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((u32)p[3] << 24);
+}
+
+/** Fetches the parser's counters with a frame of its own. */
+static void stats(u32 *const dst)
+{
+	static const u8 req[] = { CMD_CCC_STATS };
+	struct frame f;
+
+	send(0xEE, req, sizeof(req));
+	run();
+
+	CHECK(recv(&f));
+	CHECK_EQ(f.seq, 0xEE);
+	CHECK_EQ(f.size, 2 + CCC_STATS_SIZE);
+	CHECK_EQ(f.payload[0], STATUS_OK);
+	CHECK_EQ(f.payload[1], CMD_ACK);
+	CHECK(!recv(&f));
+
+	for (u32 i = 0; i < 4; ++i)
+		dst[i] = le32(&f.payload[2 + (i * 4)]);
+}
+
+static void setup(void)
+{
+	hw_reset();
+	hw_usb_reset();
+
+	memset(&host, 0, sizeof(host));
+}
+
+static void test_ok(void)
+{
+	static const u8 req[] = { CMD_CCC_STATS, CMD_CCC_STATS };
+	struct frame f;
+
+	setup();
+
+	u32 before[4];
+	stats(before);
+
+	send(0x01, req, sizeof(req));
+	run();
+
+	CHECK(recv(&f));
+	CHECK_EQ(f.seq, 0x01);
+	CHECK_EQ(f.size, 1 + (2 * (1 + CCC_STATS_SIZE)));
+	CHECK_EQ(f.payload[0], STATUS_OK);
+	CHECK_EQ(f.payload[1], CMD_ACK);
+	CHECK_EQ(f.payload[2 + CCC_STATS_SIZE], CMD_ACK);
+	CHECK(!recv(&f));
+
+	// The counters as the first command saw them: everything up to and
+	// including this frame has been received, and the stats() frame and
+	// its command have been counted.
+	const u8 *const p = &f.payload[2];
+
+	CHECK_EQ(le32(&p[STAT_BYTES_RX * 4]),
+		 before[STAT_BYTES_RX] + 4 + sizeof(req) + 2);
+	CHECK_EQ(le32(&p[STAT_FRAMES_RX * 4]), before[STAT_FRAMES_RX] + 1);
+	CHECK_EQ(le32(&p[STAT_FRAMES_BAD * 4]), before[STAT_FRAMES_BAD]);
+	CHECK_EQ(le32(&p[STAT_CMDS * 4]), before[STAT_CMDS] + 1);
+
+	// An empty frame is answered with nothing but its status.
+	send(0x02, NULL, 0);
+	run();
+
+	recv_status(0x02, STATUS_OK);
+	CHECK(!recv(&f));
+}
+
+static void test_bad_crc(void)
+{
+	static const u8 req[] = { CMD_CCC_STATS };
+	u8 buf[FRAME_SIZE_MAX];
+	struct frame f;
+
+	setup();
+
+	u32 before[4];
+	stats(before);
+
+	// Every byte covered by the CRC, and the CRC itself.
+	const u32 size = encode(buf, 0x10, req, sizeof(req));
+
+	for (u32 i = 1; i < size; ++i) {
+		buf[i] ^= 0x40;
+		hw_usb_host_send(CCC_USB_LINK_CDC, buf, size);
+		buf[i] ^= 0x40;
+
+		if (i == 1 || i == 2) {
+			// A corrupted length is no longer the length that was
+			// sent: the parser either waits for a payload which is
+			// not coming or refuses the frame outright. Either way,
+			// a run of bytes that cannot be mistaken for a frame
+			// gets it back in step.
+			static const u8 fill[4 + PAYLOAD_SIZE_MAX + 2];
+
+			hw_usb_host_send(CCC_USB_LINK_CDC, fill, sizeof(fill));
+			run();
+
+			CHECK(recv(&f));
+
+			do {
+				CHECK_EQ(f.size, 1);
+				CHECK(f.payload[0] == STATUS_BAD_CRC ||
+				      f.payload[0] == STATUS_TOO_LONG);
+			} while (recv(&f));
+		} else {
+			run();
+
+			CHECK(recv(&f));
+			CHECK_EQ(f.size, 1);
+			CHECK_EQ(f.payload[0], STATUS_BAD_CRC);
+
+			// The reply carries the sequence number as received.
+			CHECK_EQ(f.seq, (i == 3) ? 0x10 ^ 0x40 : 0x10);
+			CHECK(!recv(&f));
+		}
+
+		// The next frame is parsed as if nothing had happened.
+		hw_usb_host_send(CCC_USB_LINK_CDC, buf, size);
+		run();
+
+		CHECK(recv(&f));
+		CHECK_EQ(f.seq, 0x10);
+		CHECK_EQ(f.payload[0], STATUS_OK);
+		CHECK_EQ(f.payload[1], CMD_ACK);
+		CHECK(!recv(&f));
+	}
+
+	u32 after[4];
+	stats(after);
+
+	CHECK(after[STAT_FRAMES_BAD] - before[STAT_FRAMES_BAD] >= size - 1);
+	CHECK_EQ(after[STAT_CMDS] - before[STAT_CMDS], (size - 1) + 1);
+}
+
+static void test_too_long(void)
+{
+	static const u8 req[] = { CMD_CCC_STATS };
+	static const u8 lens[][2] = {
+		{ (PAYLOAD_SIZE_MAX + 1) & 0xFF, (PAYLOAD_SIZE_MAX + 1) >> 8 },
+		{ 0xFF, 0xFF },
+	};
+
+	u8 buf[FRAME_SIZE_MAX];
+	struct frame f;
+
+	setup();
+
+	for (u32 i = 0; i < ARRAY_SIZE(lens); ++i) {
+		// The largest frame allowed goes through.
+		static u8 big[PAYLOAD_SIZE_MAX];
+		memset(big, CMD_UNKNOWN, sizeof(big));
+
+		send(0x20, big, sizeof(big));
+		run();
+
+		CHECK(recv(&f));
+		CHECK_EQ(f.seq, 0x20);
+		CHECK_EQ(f.size, 2);
+		CHECK_EQ(f.payload[0], STATUS_OK);
+		CHECK_EQ(f.payload[1], CMD_UNKNOWN_STATUS);
+		CHECK(!recv(&f));
+
+		// An oversized frame is refused as soon as its length is
+		// known, with the sequence number of the frame before it, and
+		// none of what follows it is taken as part of it.
+		const u8 hdr[] = { SOF, lens[i][0], lens[i][1] };
+
+		hw_usb_host_send(CCC_USB_LINK_CDC, hdr, sizeof(hdr));
+		run();
+
+		recv_status(0x20, STATUS_TOO_LONG);
+		CHECK(!recv(&f));
+
+		const u32 size = encode(buf, 0x21 + i, req, sizeof(req));
+
+		hw_usb_host_send(CCC_USB_LINK_CDC, buf, size);
+		run();
+
+		CHECK(recv(&f));
+		CHECK_EQ(f.seq, 0x21 + i);
+		CHECK_EQ(f.payload[0], STATUS_OK);
+		CHECK_EQ(f.payload[1], CMD_ACK);
+		CHECK(!recv(&f));
+
+		// Nor is the payload the host sent with it, unless it happens
+		// to hold a frame of its own.
+		hw_usb_host_send(CCC_USB_LINK_CDC, hdr, sizeof(hdr));
+		hw_usb_host_send(CCC_USB_LINK_CDC, big, sizeof(big));
+		hw_usb_host_send(CCC_USB_LINK_CDC, buf, size);
+		run();
+
+		recv_status(0x21 + i, STATUS_TOO_LONG);
+
+		CHECK(recv(&f));
+		CHECK_EQ(f.seq, 0x21 + i);
+		CHECK_EQ(f.payload[0], STATUS_OK);
+		CHECK(!recv(&f));
+	}
+}
+
+static void test_split(void)
+{
+	static const u8 req[] = { CMD_CCC_STATS, CMD_REG_WRITE, 0x00 };
+	static u8 stream[1 << 12];
+
+	setup();
+
+	// Noise before the first frame and between frames is skipped.
+	u32 size = 0;
+
+	for (u32 i = 0; i < 8; ++i) {
+		stream[size++] = 0x55;
+		size += encode(&stream[size], 0x30 + i, req, sizeof(req));
+	}
+
+	// However the link chops the stream up, the same frames come out.
+	for (u32 chunk = 1; chunk <= CCC_USB_RX_SIZE_MAX; chunk *= 3) {
+		hw_usb_chunk_set(chunk);
+		hw_usb_host_send(CCC_USB_LINK_CDC, stream, size);
+		run();
+
+		for (u32 i = 0; i < 8; ++i) {
+			struct frame f;
+
+			CHECK(recv(&f));
+			CHECK_EQ(f.seq, 0x30 + i);
+			CHECK_EQ(f.size, 1 + 1 + CCC_STATS_SIZE + 1);
+			CHECK_EQ(f.payload[0], STATUS_OK);
+			CHECK_EQ(f.payload[1], CMD_ACK);
+
+			// The register write is missing its value.
+			CHECK_EQ(f.payload[2 + CCC_STATS_SIZE], CMD_TRUNCATED);
+		}
+	}
+}
+
+static void test_unknown(void)
+{
+	static const u8 req[] = { CMD_UNKNOWN, CMD_CCC_STATS };
+	struct frame f;
+
+	setup();
+
+	// Nothing after an unknown opcode is run.
+	send(0x40, req, sizeof(req));
+	run();
+
+	CHECK(recv(&f));
+	CHECK_EQ(f.seq, 0x40);
+	CHECK_EQ(f.size, 2);
+	CHECK_EQ(f.payload[0], STATUS_OK);
+	CHECK_EQ(f.payload[1], CMD_UNKNOWN_STATUS);
+	CHECK(!recv(&f));
+}
+
+static void test_tx_full(void)
+{
+	static const u8 req[] = { CMD_CCC_STATS };
+	struct frame f;
+
+	setup();
+
+	// Room for the header but not the rest: the host gets nothing rather
+	// than a partial frame.
+	hw_usb_tx_space_set(CCC_USB_LINK_CDC, 8);
+
+	send(0x50, req, sizeof(req));
+	run();
+
+	CHECK(!recv(&f));
+
+	hw_usb_tx_space_set(CCC_USB_LINK_CDC, UINT32_MAX);
+
+	send(0x51, req, sizeof(req));
+	run();
+
+	CHECK(recv(&f));
+	CHECK_EQ(f.seq, 0x51);
+	CHECK_EQ(f.size, 2 + CCC_STATS_SIZE);
+	CHECK_EQ(le32(&f.payload[2 + (STAT_TX_DROPS * 4)]), 1);
+	CHECK(!recv(&f));
+}
+
+static u64 now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((u64)ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+/**
+ * Feeds @p frames frames of @p cmds commands each through the parser in
+ * chunks as large as the CDC endpoint hands them over, and reports the rate
+ * on this host. It only says something about the parser relative to earlier
+ * runs on the same machine, not about the LPC1769.
+ */
+static void bench(const u32 frames, const u32 cmds)
+{
+	// The clock stands still without register accesses, so the time budget
+	// never runs out: each pass takes all of the stream, and has to leave
+	// room for the replies.
+	static u8 stream[1 << 14];
+	static u8 rsp[1 << 16];
+	static u8 req[PAYLOAD_SIZE_MAX];
+
+	setup();
+
+	// The model is not under test here.
+	hw_mmio_cycles_set(0);
+
+	memset(req, CMD_CCC_STATS, cmds);
+
+	u32 size = 0;
+
+	while (size + 4 + cmds + 2 <= sizeof(stream))
+		size += encode(&stream[size], size, req, cmds);
+
+	const u32 per_stream = size / (4 + cmds + 2);
+
+	u64 rsp_size = 0;
+	u32 sent = 0;
+
+	const u64 start = now_ns();
+
+	while (sent < frames) {
+		hw_usb_host_send(CCC_USB_LINK_CDC, stream, size);
+
+		while (hw_usb_host_pending(CCC_USB_LINK_CDC)) {
+			task_ccc_tick();
+
+			u32 n;
+
+			while ((n = hw_usb_host_recv(CCC_USB_LINK_CDC, rsp,
+						     sizeof(rsp))))
+				rsp_size += n;
+		}
+
+		sent += per_stream;
+	}
+
+	const u64 elapsed = now_ns() - start;
+
+	CHECK_EQ(rsp_size,
+		 (u64)sent * (4 + 1 + (cmds * (1 + CCC_STATS_SIZE)) + 2));
+
+	printf("bench: %u frames of %u commands: %.0f frames/s, "
+	       "%.0f commands/s, %.1f MB/s in\n",
+	       sent, cmds, sent * 1e9 / elapsed, sent * cmds * 1e9 / elapsed,
+	       (u64)sent * (4 + cmds + 2) * 1e3 / elapsed);
+}
+
+static void bench_parser(void)
+{
+	bench(100000, 1);
+	bench(20000, 16);
+}
+
+int main(void)
+{
+	RUN(test_ok);
+	RUN(test_bad_crc);
+	RUN(test_too_long);
+	RUN(test_split);
+	RUN(test_unknown);
+	RUN(test_tx_full);
+	RUN(bench_parser);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,352 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <string.h>
+
+#include "common/util.h"
+#include "hal/gpdma.h"
+
+#include "hw.h"
+
+// The GPDMA controller, moving one byte per cycle on behalf of the highest
+// priority channel with a pending request. Only 8-bit transfers between memory
+// and the SSP0 FIFOs are modelled. Memory the controller could not reach on
+// the LPC1769 raises the error interrupt instead of being accessed.
+
+enum {
+	REG_IntStat = 0x000,
+	REG_IntTCStat = 0x004,
+	REG_IntTCClear = 0x008,
+	REG_IntErrStat = 0x00C,
+	REG_IntErrClr = 0x010,
+	REG_EnbldChns = 0x01C,
+	REG_Config = 0x030,
+
+	CH_BASE = 0x100,
+	CH_STRIDE = 0x20,
+
+	CH_REG_SrcAddr = 0x0,
+	CH_REG_DestAddr = 0x4,
+	CH_REG_LLI = 0x8,
+	CH_REG_Control = 0xC,
+	CH_REG_Config = 0x10
+};
+
+enum {
+	Config_E = BIT_0,
+
+	Control_MASK_TransferSize = BITMASK_FROM_RANGE(0, 11),
+	Control_MASK_Width = BITMASK_FROM_RANGE(18, 23),
+	Control_SI = BIT_26,
+	Control_DI = BIT_27,
+	Control_I = BIT_31,
+
+	ChConfig_E = BIT_0,
+	ChConfig_SrcPeriph_SHIFT = 1,
+	ChConfig_DestPeriph_SHIFT = 6,
+	ChConfig_TransferType_SHIFT = 11,
+	ChConfig_IE = BIT_14,
+	ChConfig_ITC = BIT_15,
+	ChConfig_H = BIT_18
+};
+
+static struct {
+	u32 Config;
+	u32 IntTCStat;
+	u32 IntErrStat;
+
+	struct {
+		u32 SrcAddr;
+		u32 DestAddr;
+		u32 LLI;
+		u32 Control;
+		u32 Config;
+
+		struct hw_gpdma_ch_info info;
+	} ch[GPDMA_CHANNEL_NUM];
+} dma;
+
+void hw_gpdma_reset(void)
+{
+	memset(&dma, 0, sizeof(dma));
+}
+
+void hw_gpdma_ch_info_get(const u32 ch, struct hw_gpdma_ch_info *const info)
+{
+	*info = dma.ch[ch].info;
+}
+
+static u32 enabled_channels(void)
+{
+	u32 mask = 0;
+
+	for (u32 ch = 0; ch < GPDMA_CHANNEL_NUM; ++ch) {
+		if (dma.ch[ch].Config & ChConfig_E)
+			mask |= UINT32_C(1) << ch;
+	}
+	return mask;
+}
+
+u32 hw_gpdma_read(const u32 off)
+{
+	if (off >= CH_BASE) {
+		const u32 ch = (off - CH_BASE) / CH_STRIDE;
+
+		if (ch >= GPDMA_CHANNEL_NUM)
+			return 0;
+
+		switch ((off - CH_BASE) % CH_STRIDE) {
+		case CH_REG_SrcAddr:
+			return dma.ch[ch].SrcAddr;
+
+		case CH_REG_DestAddr:
+			return dma.ch[ch].DestAddr;
+
+		case CH_REG_LLI:
+			return dma.ch[ch].LLI;
+
+		case CH_REG_Control:
+			return dma.ch[ch].Control;
+
+		case CH_REG_Config:
+			// Never active: a halted channel drains at once.
+			return dma.ch[ch].Config;
+
+		default:
+			return 0;
+		}
+	}
+
+	switch (off) {
+	case REG_IntStat:
+		return dma.IntTCStat | dma.IntErrStat;
+
+	case REG_IntTCStat:
+		return dma.IntTCStat;
+
+	case REG_IntErrStat:
+		return dma.IntErrStat;
+
+	case REG_EnbldChns:
+		return enabled_channels();
+
+	case REG_Config:
+		return dma.Config;
+
+	default:
+		return 0;
+	}
+}
+
+void hw_gpdma_write(const u32 off, const u32 val)
+{
+	if (off >= CH_BASE) {
+		const u32 ch = (off - CH_BASE) / CH_STRIDE;
+
+		if (ch >= GPDMA_CHANNEL_NUM)
+			return;
+
+		switch ((off - CH_BASE) % CH_STRIDE) {
+		case CH_REG_SrcAddr:
+			dma.ch[ch].SrcAddr = val;
+			break;
+
+		case CH_REG_DestAddr:
+			dma.ch[ch].DestAddr = val;
+			break;
+
+		case CH_REG_LLI:
+			dma.ch[ch].LLI = val;
+			break;
+
+		case CH_REG_Control:
+			dma.ch[ch].Control = val;
+			break;
+
+		case CH_REG_Config:
+			if ((val & ChConfig_E) &&
+			    !(dma.ch[ch].Config & ChConfig_E)) {
+				dma.ch[ch].info.starts++;
+				dma.ch[ch].info.src = dma.ch[ch].SrcAddr;
+				dma.ch[ch].info.dst = dma.ch[ch].DestAddr;
+			}
+			dma.ch[ch].Config = val;
+			break;
+
+		default:
+			break;
+		}
+		return;
+	}
+
+	switch (off) {
+	case REG_IntTCClear:
+		dma.IntTCStat &= ~val;
+		break;
+
+	case REG_IntErrClr:
+		dma.IntErrStat &= ~val;
+		break;
+
+	case REG_Config:
+		dma.Config = val & 0x3;
+		break;
+
+	default:
+		break;
+	}
+}
+
+static bool periph_req(const u32 periph)
+{
+	switch (periph) {
+	case GPDMA_PERIPH_SSP0_TX:
+		return hw_ssp_dma_tx_req();
+
+	case GPDMA_PERIPH_SSP0_RX:
+		return hw_ssp_dma_rx_req();
+
+	default:
+		hw_fail("GPDMA: peripheral %u has no model", periph);
+	}
+}
+
+static bool ch_req(const u32 ch)
+{
+	const u32 Config = dma.ch[ch].Config;
+
+	if (!(Config & ChConfig_E) || (Config & ChConfig_H))
+		return false;
+
+	switch ((Config >> ChConfig_TransferType_SHIFT) & 0x7) {
+	case GPDMA_XFER_TYPE_M2P:
+		return periph_req((Config >> ChConfig_DestPeriph_SHIFT) & 0x1F);
+
+	case GPDMA_XFER_TYPE_P2M:
+		return periph_req((Config >> ChConfig_SrcPeriph_SHIFT) & 0x1F);
+
+	default:
+		hw_fail("GPDMA: channel %u has an unsupported flow", ch);
+	}
+}
+
+static void ch_error(const u32 ch)
+{
+	dma.ch[ch].Config &= ~ChConfig_E;
+
+	if (dma.ch[ch].Config & ChConfig_IE)
+		dma.IntErrStat |= UINT32_C(1) << ch;
+}
+
+static u8 *mem(const u32 addr)
+{
+	if (!gpdma_addr_reachable((const void *)(uintptr_t)addr))
+		return NULL;
+
+	return (u8 *)(uintptr_t)addr;
+}
+
+static void ch_xfer(const u32 ch)
+{
+	const u32 type =
+		(dma.ch[ch].Config >> ChConfig_TransferType_SHIFT) & 0x7;
+	const u32 Control = dma.ch[ch].Control;
+
+	if (Control & Control_MASK_Width)
+		hw_fail("GPDMA: channel %u uses a width above 8 bits", ch);
+
+	if (type == GPDMA_XFER_TYPE_M2P) {
+		const u8 *const src = mem(dma.ch[ch].SrcAddr);
+
+		if (!src) {
+			ch_error(ch);
+			return;
+		}
+
+		hw_ssp_dma_push(*src);
+
+		if (Control & Control_SI)
+			dma.ch[ch].SrcAddr++;
+	} else {
+		u8 *const dst = mem(dma.ch[ch].DestAddr);
+
+		if (!dst) {
+			ch_error(ch);
+			return;
+		}
+
+		*dst = hw_ssp_dma_pop();
+
+		if (Control & Control_DI)
+			dma.ch[ch].DestAddr++;
+	}
+
+	const u32 left = (Control & Control_MASK_TransferSize) - 1;
+	dma.ch[ch].Control = (Control & ~Control_MASK_TransferSize) | left;
+
+	if (left)
+		return;
+
+	if ((Control & Control_I) && (dma.ch[ch].Config & ChConfig_ITC))
+		dma.IntTCStat |= UINT32_C(1) << ch;
+
+	if (!dma.ch[ch].LLI) {
+		dma.ch[ch].Config &= ~ChConfig_E;
+		return;
+	}
+
+	const struct gpdma_lli *const lli =
+		(const struct gpdma_lli *)mem(dma.ch[ch].LLI);
+
+	if (!lli) {
+		ch_error(ch);
+		return;
+	}
+
+	dma.ch[ch].SrcAddr = lli->src;
+	dma.ch[ch].DestAddr = lli->dst;
+	dma.ch[ch].LLI = lli->next;
+	dma.ch[ch].Control = lli->ctrl;
+}
+
+bool hw_gpdma_enabled(void)
+{
+	return dma.Config & Config_E;
+}
+
+void hw_gpdma_step(void)
+{
+	if (!(dma.Config & Config_E))
+		return;
+
+	for (u32 ch = 0; ch < GPDMA_CHANNEL_NUM; ++ch) {
+		if (ch_req(ch)) {
+			ch_xfer(ch);
+			return;
+		}
+	}
+}
+
+bool hw_gpdma_irq(void)
+{
+	return dma.IntTCStat | dma.IntErrStat;
+}
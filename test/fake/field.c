@@ -0,0 +1,742 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <string.h>
+
+#include "board/nfc/nfc.h"
+#include "hal/sysctl.h"
+
+#include "field.h"
+#include "hw.h"
+
+enum {
+	CMD_REQA = 0x26,
+	CMD_WUPA = 0x52,
+	CMD_HLTA = 0x50,
+	CMD_RATS = 0xE0,
+	CMD_PPSS = 0xD0,
+
+	CASCADE_TAG = 0x88,
+	NVB_SELECT = 0x70,
+	SHORT_FRAME_BITS = 7,
+
+	PPS0_PPS1 = 0x11,
+
+	PCB_BLOCK_NUM = BIT_0,
+	PCB_CHAINING = BIT_4,
+
+	PCB_I = 0x02,
+	PCB_R_ACK = 0xA2,
+	PCB_R_NAK = 0xB2,
+	PCB_S_DESELECT = 0xC2,
+	PCB_S_WTX = 0xF2,
+
+	PCB_MASK_I = 0xEE,
+	PCB_MASK_R = 0xFE,
+
+	T0_FSCI = 0x0F,
+	FSCI_DEFAULT = 2,
+	FSCI_MAX = 0x0C,
+
+	CRC_A_INIT = 0x6363,
+
+	/** Carrier frequency, and the time a bit takes at 106 kbit/s in it */
+	FC_HZ = 13560000,
+	FC_PER_BIT = 128,
+
+	/** Frame delay time, from the end of a command to the answer */
+	FDT_FC = 1172,
+
+	/** The CLRC663 reports collisions up to this bit position */
+	COLL_POS_NUM = 128,
+
+	/** A frame of the largest FSD the reader may ask for, and its CRC */
+	FRAME_SIZE_MAX = 4096 + 2
+};
+
+struct frame {
+	u8 buf[FRAME_SIZE_MAX];
+	u32 bits;
+};
+
+static const u16 fsc_tbl[FSCI_MAX + 1] = {
+	16, 24, 32, 40, 48, 64, 96, 128, 256, 512, 1024, 2048, 4096
+};
+
+struct card {
+	struct hw_card cfg;
+	bool present;
+
+	enum hw_card_state state;
+	u8 level;
+
+	/** Whether the card was woken from HALT, and returns there on error */
+	bool halted;
+
+	u32 level_num;
+	u8 uid_cl[ISO14443A_CASCADE_LEVEL_NUM][ISO14443A_UID_CL_SIZE];
+
+	// ISO/IEC 14443-4
+
+	/** Largest frames the reader and the card take, with PCB and CRC */
+	u32 fsd;
+	u32 fsc;
+
+	u8 block_num;
+
+	/** Bit rate divisors, card to reader and reader to card */
+	u8 ds;
+	u8 dr;
+
+	/** The command being chained by the reader */
+	u8 cmd[HW_CARD_APDU_SIZE_MAX];
+	u32 cmd_size;
+
+	/** The response, and how much of it has been sent */
+	u8 rsp[HW_CARD_APDU_SIZE_MAX];
+	u32 rsp_size;
+	u32 rsp_pos;
+
+	u8 wtx_left;
+	bool wtx_wait;
+
+	/** The last block sent, for the reader to ask for again */
+	struct frame last;
+};
+
+static const u8 sel_tbl[ISO14443A_CASCADE_LEVEL_NUM] = {
+	// clang-format off
+
+	[0] = 0x93,
+	[1] = 0x95,
+	[2] = 0x97
+
+	// clang-format on
+};
+
+static struct {
+	struct card cards[HW_FIELD_CARD_NUM_MAX];
+	u32 card_num;
+
+	/** Bit rate divisors the reader sends and receives at */
+	u8 tx_div;
+	u8 rx_div;
+
+	u32 tx_period;
+	u32 rx_period;
+	u32 tx_count;
+	u32 rx_count;
+
+	/** Time the card answering takes on top of the frame delay time */
+	u32 delay_us;
+
+	struct hw_field_stats stats;
+} field;
+
+static bool bit_get(const u8 *const buf, const u32 pos)
+{
+	return (buf[pos / 8] >> (pos % 8)) & 1;
+}
+
+static void bit_put(u8 *const buf, const u32 pos, const bool val)
+{
+	if (val)
+		buf[pos / 8] |= 1U << (pos % 8);
+	else
+		buf[pos / 8] &= ~(1U << (pos % 8));
+}
+
+static u16 crc_a(const u8 *const buf, const u32 size)
+{
+	u16 crc = CRC_A_INIT;
+
+	for (u32 i = 0; i < size; ++i) {
+		crc ^= buf[i];
+
+		for (u32 bit = 0; bit < 8; ++bit)
+			crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : crc >> 1;
+	}
+
+	return crc;
+}
+
+static void frame_bytes(struct frame *const f, const u8 *const src,
+			const u32 size)
+{
+	memcpy(f->buf, src, size);
+	f->bits = size * 8;
+}
+
+static void frame_crc_append(struct frame *const f)
+{
+	const u32 size = f->bits / 8;
+	const u16 crc = crc_a(f->buf, size);
+
+	f->buf[size + 0] = crc >> 0;
+	f->buf[size + 1] = crc >> 8;
+	f->bits += 16;
+}
+
+static u64 fc_to_cycles(const u64 fc)
+{
+	return (fc * SYSCTL_CCLK_HZ) / FC_HZ;
+}
+
+/**
+ * Time a frame of @p bits takes on air at 106 kbit/s divided by @p div, with
+ * its start, parity and end
+ */
+static u64 frame_fc(const u32 bits, const u8 div)
+{
+	return (u64)(1 + bits + (bits / 8) + 1) * (FC_PER_BIT >> div);
+}
+
+/** Something the card did not expect, which sends it back to sleep. */
+static void card_drop(struct card *const c)
+{
+	c->state = c->halted ? HW_CARD_HALT : HW_CARD_IDLE;
+	c->ds = 0;
+	c->dr = 0;
+}
+
+static bool card_request(struct card *const c, const u8 cmd,
+			 struct frame *const rsp)
+{
+	const bool wake = (c->state == HW_CARD_IDLE) ||
+			  ((cmd == CMD_WUPA) && (c->state == HW_CARD_HALT));
+
+	if (!wake) {
+		// A halted card sleeps through REQA.
+		if (c->state != HW_CARD_HALT)
+			card_drop(c);
+
+		return false;
+	}
+
+	c->halted = c->state == HW_CARD_HALT;
+	c->state = HW_CARD_READY;
+	c->level = 0;
+
+	frame_bytes(rsp, c->cfg.atqa, sizeof(c->cfg.atqa));
+	return true;
+}
+
+/** ANTICOLLISION and SELECT of the card's current cascade level */
+static bool card_select(struct card *const c, const u8 *const tx,
+			const u32 tx_bits, const bool tx_crc,
+			struct frame *const rsp)
+{
+	if ((tx_bits < 16) || (tx[0] != sel_tbl[c->level])) {
+		card_drop(c);
+		return false;
+	}
+
+	const u8 nvb = tx[1];
+	const u32 known = tx_bits - 16;
+
+	if ((u32)(((nvb >> 4) * 8) + (nvb & 0x0F)) != tx_bits) {
+		card_drop(c);
+		return false;
+	}
+
+	const u8 *const uid_cl = c->uid_cl[c->level];
+
+	if (known == ISO14443A_UID_CL_BITS) {
+		if (!tx_crc || memcmp(&tx[2], uid_cl, ISO14443A_UID_CL_SIZE)) {
+			card_drop(c);
+			return false;
+		}
+
+		const bool last = c->level + 1U == c->level_num;
+		const u8 sak = last ? c->cfg.sak & ~ISO14443A_SAK_CASCADE :
+				      ISO14443A_SAK_CASCADE;
+
+		if (last)
+			c->state = HW_CARD_ACTIVE;
+		else
+			c->level++;
+
+		frame_bytes(rsp, &sak, sizeof(sak));
+		frame_crc_append(rsp);
+		return true;
+	}
+
+	if (tx_crc || (known > ISO14443A_UID_CL_BITS)) {
+		card_drop(c);
+		return false;
+	}
+
+	// Cards whose UID starts differently keep quiet, and wait for the
+	// next round.
+	for (u32 i = 0; i < known; ++i) {
+		if (bit_get(&tx[2], i) != bit_get(uid_cl, i))
+			return false;
+	}
+
+	memset(rsp->buf, 0, sizeof(rsp->buf));
+	rsp->bits = ISO14443A_UID_CL_BITS - known;
+
+	for (u32 i = 0; i < rsp->bits; ++i)
+		bit_put(rsp->buf, i, bit_get(uid_cl, known + i));
+
+	return true;
+}
+
+static bool card_active(struct card *const c, const u8 *const tx,
+			const u32 tx_bits, const bool tx_crc,
+			struct frame *const rsp)
+{
+	if ((tx_bits == 16) && tx_crc && (tx[0] == CMD_HLTA) && !tx[1]) {
+		c->state = HW_CARD_HALT;
+		return false;
+	}
+
+	if ((tx_bits == 16) && tx_crc && (tx[0] == CMD_RATS) &&
+	    c->cfg.ats_size) {
+		const u8 fsdi = tx[1] >> 4;
+		u8 fsci = (c->cfg.ats_size > 1) ? c->cfg.ats[1] & T0_FSCI :
+						  FSCI_DEFAULT;
+
+		if (fsci > FSCI_MAX)
+			fsci = FSCI_MAX;
+
+		c->fsd = fsc_tbl[(fsdi > FSCI_MAX) ? FSCI_MAX : fsdi];
+		c->fsc = fsc_tbl[fsci];
+		c->block_num = 1;
+		c->cmd_size = 0;
+		c->rsp_size = 0;
+		c->rsp_pos = 0;
+		c->wtx_wait = false;
+		c->state = HW_CARD_PROTOCOL;
+
+		frame_bytes(rsp, c->cfg.ats, c->cfg.ats_size);
+		frame_crc_append(rsp);
+		return true;
+	}
+
+	card_drop(c);
+	return false;
+}
+
+/** The next block of the response, or a request for more time first */
+static void tcl_answer(struct card *const c, struct frame *const rsp)
+{
+	if (c->wtx_left) {
+		const u8 wtx[] = { PCB_S_WTX, c->cfg.wtxm };
+
+		c->wtx_left--;
+		c->wtx_wait = true;
+
+		frame_bytes(rsp, wtx, sizeof(wtx));
+		return;
+	}
+
+	if (!c->rsp_pos)
+		field.delay_us = c->cfg.proc_us;
+
+	c->wtx_wait = false;
+
+	u32 inf_size_max = c->fsd - 3;
+
+	if (c->cfg.chain_size && (c->cfg.chain_size < inf_size_max))
+		inf_size_max = c->cfg.chain_size;
+
+	const u32 left = c->rsp_size - c->rsp_pos;
+	const u32 inf_size = (left < inf_size_max) ? left : inf_size_max;
+
+	rsp->buf[0] = PCB_I | c->block_num;
+
+	if (inf_size < left)
+		rsp->buf[0] |= PCB_CHAINING;
+
+	memcpy(&rsp->buf[1], &c->rsp[c->rsp_pos], inf_size);
+	rsp->bits = (1 + inf_size) * 8;
+
+	c->rsp_pos += inf_size;
+}
+
+static bool tcl_block(struct card *const c, const u8 *const tx,
+		      const u32 size, struct frame *const rsp)
+{
+	const u8 pcb = tx[0];
+
+	if ((pcb & PCB_MASK_I) == PCB_I) {
+		c->block_num ^= PCB_BLOCK_NUM;
+
+		if (c->cmd_size + size - 1 > sizeof(c->cmd))
+			hw_fail("field: a command of over %u bytes",
+				c->cmd_size + size - 1);
+
+		memcpy(&c->cmd[c->cmd_size], &tx[1], size - 1);
+		c->cmd_size += size - 1;
+
+		if (pcb & PCB_CHAINING) {
+			const u8 ack = PCB_R_ACK | c->block_num;
+			frame_bytes(rsp, &ack, sizeof(ack));
+			return true;
+		}
+
+		c->rsp_size = c->cfg.app(c->cmd, c->cmd_size, c->rsp);
+		c->rsp_pos = 0;
+		c->cmd_size = 0;
+		c->wtx_left = c->cfg.wtx_num;
+
+		if (c->rsp_size > sizeof(c->rsp))
+			hw_fail("field: a response of %u bytes", c->rsp_size);
+
+		tcl_answer(c, rsp);
+		return true;
+	}
+
+	if (((pcb & PCB_MASK_R) == PCB_R_ACK) ||
+	    ((pcb & PCB_MASK_R) == PCB_R_NAK)) {
+		if (size != 1)
+			return false;
+
+		// The reader missed the last block.
+		if ((pcb & PCB_BLOCK_NUM) == c->block_num) {
+			*rsp = c->last;
+			return true;
+		}
+
+		// The reader missed a block, or the card missed its last one.
+		if ((pcb & PCB_MASK_R) == PCB_R_NAK) {
+			const u8 ack = PCB_R_ACK | c->block_num;
+			frame_bytes(rsp, &ack, sizeof(ack));
+			return true;
+		}
+
+		// The reader took the last block of a chain and asks for the
+		// next one.
+		if (c->rsp_pos == c->rsp_size)
+			return false;
+
+		c->block_num ^= PCB_BLOCK_NUM;
+		tcl_answer(c, rsp);
+		return true;
+	}
+
+	if ((pcb == PCB_S_WTX) && (size == 2) && c->wtx_wait) {
+		tcl_answer(c, rsp);
+		return true;
+	}
+
+	return false;
+}
+
+static bool card_protocol(struct card *const c, const u8 *const tx,
+			  const u32 tx_bits, const bool tx_crc,
+			  struct frame *const rsp)
+{
+	const u32 size = tx_bits / 8;
+
+	// Broken blocks are ignored, and left to the reader to recover from.
+	if (!tx_crc || !size || (tx_bits % 8))
+		return false;
+
+	if (size + 2 > c->fsc) {
+		field.stats.rejects++;
+		return false;
+	}
+
+	if ((tx[0] == CMD_PPSS) && (size == 3) && (tx[1] == PPS0_PPS1)) {
+		frame_bytes(rsp, tx, 1);
+		frame_crc_append(rsp);
+
+		// The answer still goes out at the old bit rate.
+		c->ds = (tx[2] >> 2) & 0x03;
+		c->dr = tx[2] & 0x03;
+		return true;
+	}
+
+	if ((tx[0] == PCB_S_DESELECT) && (size == 1)) {
+		frame_bytes(rsp, tx, 1);
+		frame_crc_append(rsp);
+
+		c->state = HW_CARD_HALT;
+		c->ds = 0;
+		c->dr = 0;
+		return true;
+	}
+
+	if (!tcl_block(c, tx, size, rsp))
+		return false;
+
+	c->last = *rsp;
+	frame_crc_append(rsp);
+	return true;
+}
+
+/** Hands a frame to @p c; returns whether it answers, with @p rsp. */
+static bool card_rx(struct card *const c, const u8 *const tx,
+		    const u32 tx_bits, const bool tx_crc,
+		    struct frame *const rsp)
+{
+	if ((tx_bits == SHORT_FRAME_BITS) && !tx_crc) {
+		const u8 cmd = tx[0] & 0x7F;
+
+		if ((cmd == CMD_REQA) || (cmd == CMD_WUPA))
+			return card_request(c, cmd, rsp);
+	}
+
+	switch (c->state) {
+	case HW_CARD_READY:
+		return card_select(c, tx, tx_bits, tx_crc, rsp);
+
+	case HW_CARD_ACTIVE:
+		return card_active(c, tx, tx_bits, tx_crc, rsp);
+
+	case HW_CARD_PROTOCOL:
+		return card_protocol(c, tx, tx_bits, tx_crc, rsp);
+
+	default:
+		return false;
+	}
+}
+
+void hw_field_reset(void)
+{
+	memset(&field, 0, sizeof(field));
+}
+
+u32 hw_field_card_add(const struct hw_card *const cfg)
+{
+	if ((cfg->uid_size != 4) && (cfg->uid_size != 7) &&
+	    (cfg->uid_size != 10))
+		hw_fail("field: a UID of %u bytes", cfg->uid_size);
+
+	if (field.card_num == HW_FIELD_CARD_NUM_MAX)
+		hw_fail("field: too many cards");
+
+	struct card *const c = &field.cards[field.card_num];
+
+	memset(c, 0, sizeof(*c));
+	c->cfg = *cfg;
+	c->present = true;
+	c->state = HW_CARD_IDLE;
+
+	const u8 *uid = cfg->uid;
+	u32 left = cfg->uid_size;
+
+	while (left > 4) {
+		u8 *const uid_cl = c->uid_cl[c->level_num++];
+
+		uid_cl[0] = CASCADE_TAG;
+		memcpy(&uid_cl[1], uid, 3);
+
+		uid += 3;
+		left -= 3;
+	}
+
+	memcpy(c->uid_cl[c->level_num++], uid, 4);
+
+	for (u32 level = 0; level < c->level_num; ++level) {
+		u8 *const cl = c->uid_cl[level];
+		cl[4] = cl[0] ^ cl[1] ^ cl[2] ^ cl[3];
+	}
+
+	return field.card_num++;
+}
+
+void hw_field_card_remove(const u32 id)
+{
+	field.cards[id].present = false;
+}
+
+enum hw_card_state hw_field_card_state(const u32 id)
+{
+	return field.cards[id].state;
+}
+
+void hw_field_noise_set(const u32 tx_period, const u32 rx_period)
+{
+	field.tx_period = tx_period;
+	field.rx_period = rx_period;
+	field.tx_count = 0;
+	field.rx_count = 0;
+}
+
+void hw_field_stats_get(struct hw_field_stats *const stats)
+{
+	*stats = field.stats;
+}
+
+enum nfc_status nfc_transceive(const struct nfc_xfer *const xfer,
+			       struct nfc_xfer_result *const result)
+{
+	const u64 start = hw_cycles();
+
+	memset(result, 0, sizeof(*result));
+	field.stats.frames++;
+
+	if ((xfer->tx_size > FRAME_SIZE_MAX) || (xfer->rx_align > 7))
+		hw_fail("field: transceive of %u bytes, aligned to %u",
+			xfer->tx_size, xfer->rx_align);
+
+	const bool tx_crc = xfer->flags & NFC_XFER_TX_CRC;
+	const u32 tx_bits = xfer->tx_last_bits ?
+				    ((xfer->tx_size - 1) * 8) +
+					    xfer->tx_last_bits :
+				    xfer->tx_size * 8;
+
+	hw_advance(fc_to_cycles(
+		frame_fc(tx_bits + (tx_crc ? 16 : 0), field.tx_div)));
+
+	field.delay_us = 0;
+
+	const bool lost = field.tx_period &&
+			  !(++field.tx_count % field.tx_period);
+
+	if (lost)
+		field.stats.errors++;
+
+	// What the cards answer, superimposed.
+	static struct frame rx;
+	u32 answers = 0;
+	u32 coll = UINT32_MAX;
+	bool garbled = false;
+
+	for (u32 i = 0; i < field.card_num && !lost; ++i) {
+		struct card *const c = &field.cards[i];
+		static struct frame rsp;
+
+		if (!c->present)
+			continue;
+
+		if (c->dr != field.tx_div) {
+			field.stats.rejects++;
+			continue;
+		}
+
+		// A PPS changes the bit rate only after the answer to it.
+		const u8 ds = c->ds;
+
+		if (!card_rx(c, xfer->tx, tx_bits, tx_crc, &rsp))
+			continue;
+
+		if (ds != field.rx_div)
+			garbled = true;
+
+		if (!answers++) {
+			rx = rsp;
+			continue;
+		}
+
+		const u32 bits = (rsp.bits > rx.bits) ? rsp.bits : rx.bits;
+
+		for (u32 pos = 0; (pos < bits) && (pos < coll); ++pos) {
+			if ((pos >= rsp.bits) || (pos >= rx.bits) ||
+			    (bit_get(rsp.buf, pos) != bit_get(rx.buf, pos)))
+				coll = pos;
+		}
+
+		if (rsp.bits > rx.bits)
+			rx.bits = rsp.bits;
+	}
+
+	// An answer too late is as good as none, although the card has sent
+	// it.
+	if (field.delay_us > xfer->timeout_us)
+		answers = 0;
+
+	if (!answers) {
+		field.stats.timeouts++;
+		hw_advance((u64)xfer->timeout_us * (SYSCTL_CCLK_HZ / 1000000));
+
+		result->latency_cycles = hw_cycles() - start;
+		result->status = NFC_STATUS_TIMEOUT;
+		return result->status;
+	}
+
+	hw_advance(fc_to_cycles(FDT_FC + frame_fc(rx.bits, field.rx_div)) +
+		   ((u64)field.delay_us * (SYSCTL_CCLK_HZ / 1000000)));
+
+	if ((xfer->flags & NFC_XFER_RX_CRC) && field.rx_period &&
+	    !(++field.rx_count % field.rx_period)) {
+		field.stats.errors++;
+		garbled = true;
+	}
+
+	if (garbled)
+		rx.buf[0] ^= 0x01;
+
+	enum nfc_status status = NFC_STATUS_OK;
+
+	if (coll != UINT32_MAX) {
+		field.stats.collisions++;
+		status = NFC_STATUS_COLLISION;
+
+		result->coll_pos_valid = xfer->rx_align + coll < COLL_POS_NUM;
+		result->coll_pos = xfer->rx_align + coll;
+
+		for (u32 pos = coll; pos < rx.bits; ++pos)
+			bit_put(rx.buf, pos, false);
+	} else if (xfer->flags & NFC_XFER_RX_CRC) {
+		const u32 size = rx.bits / 8;
+
+		if ((rx.bits % 8) || (size < 2) ||
+		    crc_a(rx.buf, size - 2) !=
+			    (rx.buf[size - 2] | (rx.buf[size - 1] << 8)))
+			status = NFC_STATUS_INTEGRITY;
+		else
+			rx.bits -= 16;
+	}
+
+	// The first bit lands at rx_align in the first byte, the bits below
+	// it are left to the caller.
+	const u32 end = xfer->rx_align + rx.bits;
+
+	result->rx_size = (end + 7) / 8;
+	result->rx_last_bits = end % 8;
+
+	if (result->rx_size > xfer->rx_size_max) {
+		result->status = NFC_STATUS_OVERFLOW;
+		return result->status;
+	}
+
+	for (u32 i = 0; i < rx.bits; ++i)
+		bit_put(xfer->rx, xfer->rx_align + i, bit_get(rx.buf, i));
+
+	result->latency_cycles = hw_cycles() - start;
+	result->status = status;
+	return status;
+}
+
+bool nfc_protocol_set(const enum nfc_protocol protocol)
+{
+	return nfc_protocol_set_split(protocol, protocol);
+}
+
+bool nfc_protocol_set_split(const enum nfc_protocol tx,
+			    const enum nfc_protocol rx)
+{
+	if ((tx > NFC_PROTOCOL_MIFARE_848) || (rx > NFC_PROTOCOL_MIFARE_848))
+		return false;
+
+	field.tx_div = tx - NFC_PROTOCOL_MIFARE_106;
+	field.rx_div = rx - NFC_PROTOCOL_MIFARE_106;
+	return true;
+}
+
+void nfc_crypto1_disable(void)
+{
+}
@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "board/nfc/iso14443a.h"
+#include "common/types.h"
+
+// ISO/IEC 14443A cards in the field of the antenna, standing in for
+// board/nfc/nfc.c: nfc_transceive() hands each frame to every card present and
+// returns what they answer, as the CLRC663 would receive it.
+//
+// Cards answering at once are heard bit by bit; the first bit on which they
+// disagree is reported as a collision, as the CLRC663 does with RxColl, with
+// the bits after it cleared. Time advances by the time the frames take on air,
+// or by the timeout if no card answers.
+//
+// Cards with an ATS also take RATS, PPS and the blocks of ISO/IEC 14443-4,
+// following the rules for the card side of the block protocol. A frame sent
+// at a bit rate other than the one the card is at does not reach it, and an
+// answer at a bit rate other than the one the reader expects is garbled.
+
+enum {
+	HW_FIELD_CARD_NUM_MAX = 32,
+
+	HW_CARD_ATS_SIZE_MAX = 20,
+
+	/** Largest command and response of a card's application */
+	HW_CARD_APDU_SIZE_MAX = 4096
+};
+
+/**
+ * The application on an ISO/IEC 14443-4 card, answering the command in @p cmd
+ * with the response in @p rsp.
+ *
+ * @returns The size of the response.
+ */
+typedef u32 (*hw_card_app)(const u8 *cmd, u32 size, u8 *rsp);
+
+/** A card, as configured by the test. */
+struct hw_card {
+	u8 uid[ISO14443A_UID_SIZE_MAX];
+	u8 uid_size;
+	u8 atqa[ISO14443A_ATQA_SIZE];
+
+	/** SAK of the last cascade level; the others add the cascade bit. */
+	u8 sak;
+
+	// ISO/IEC 14443-4, for a card with an ATS.
+
+	/** The ATS, starting with TL, sent in answer to RATS */
+	u8 ats[HW_CARD_ATS_SIZE_MAX];
+	u8 ats_size;
+
+	/** INF bytes per chained response block; 0 for as many as FSD allows */
+	u16 chain_size;
+
+	/** S(WTX) requests before the response to every command, and WTXM */
+	u8 wtx_num;
+	u8 wtxm;
+
+	/**
+	 * Time the card takes to work on a command, between its last S(WTX)
+	 * and the first block of the response
+	 */
+	u32 proc_us;
+
+	hw_card_app app;
+};
+
+enum hw_card_state {
+	HW_CARD_IDLE,
+	HW_CARD_READY,
+	HW_CARD_ACTIVE,
+	HW_CARD_HALT,
+
+	/** Activated with RATS, exchanging blocks */
+	HW_CARD_PROTOCOL
+};
+
+struct hw_field_stats {
+	/** Frames sent by the reader */
+	u32 frames;
+	u32 collisions;
+	u32 timeouts;
+
+	/** Frames lost or corrupted by hw_field_noise_set() */
+	u32 errors;
+
+	/** Frames the cards did not take, for being too large or too fast */
+	u32 rejects;
+};
+
+/** Empties the field. */
+void hw_field_reset(void);
+
+/**
+ * Brings a card into the field, in the IDLE state.
+ *
+ * @returns A handle for the card.
+ */
+u32 hw_field_card_add(const struct hw_card *card);
+void hw_field_card_remove(u32 id);
+
+enum hw_card_state hw_field_card_state(u32 id);
+
+/**
+ * Loses every @p tx_period-th frame the reader sends, before any card sees it,
+ * and garbles every @p rx_period-th answer checked with a CRC. 0 turns either
+ * off.
+ */
+void hw_field_noise_set(u32 tx_period, u32 rx_period);
+
+void hw_field_stats_get(struct hw_field_stats *stats);
@@ -0,0 +1,388 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hal/dwt.h"
+#include "hal/nvic.h"
+
+#include "hw.h"
+
+enum {
+	SSP0_BASE_ADDR = 0x40088000,
+	SSP0_SIZE = 0x28,
+
+	GPDMA_BASE_ADDR = 0x50004000,
+	GPDMA_SIZE = 0x200,
+
+	/** Registers without a model which can be remembered at once. */
+	REG_NUM_MAX = 256,
+
+	/** Longest a wfi() may sleep before the test is considered hung. */
+	SLEEP_CYCLES_MAX = 100000000,
+
+	/** Handlers run back to back before an interrupt counts as stuck. */
+	ISR_RUN_MAX = 100000
+};
+
+// Handlers of the interrupts the models raise. Weak, so that a test only needs
+// to link the drivers it exercises.
+void isr_SSP0(void) __attribute__((weak));
+void isr_GPDMA(void) __attribute__((weak));
+
+static const struct {
+	uintptr_t base;
+	u32 size;
+	u32 (*read)(u32 off);
+	void (*write)(u32 off, u32 val);
+} periph[] = {
+	// clang-format off
+
+	{
+		.base	= SSP0_BASE_ADDR,
+		.size	= SSP0_SIZE,
+		.read	= hw_ssp_read,
+		.write	= hw_ssp_write
+	},
+
+	{
+		.base	= GPDMA_BASE_ADDR,
+		.size	= GPDMA_SIZE,
+		.read	= hw_gpdma_read,
+		.write	= hw_gpdma_write
+	}
+
+	// clang-format on
+};
+
+static const struct {
+	enum nvic_irq irq;
+	bool (*line)(void);
+	void (*isr)(void);
+} irq_src[] = {
+	// clang-format off
+
+	{
+		.irq	= NVIC_IRQ_SSP0,
+		.line	= hw_ssp_irq,
+		.isr	= isr_SSP0
+	},
+
+	{
+		.irq	= NVIC_IRQ_GPDMA,
+		.line	= hw_gpdma_irq,
+		.isr	= isr_GPDMA
+	}
+
+	// clang-format on
+};
+
+static struct {
+	u64 cycles;
+	u32 mmio_cycles;
+
+	u32 stall_period;
+	u32 stall_cycles;
+	u64 stall_next;
+
+	bool primask;
+	u32 basepri;
+	bool in_isr;
+	u32 nvic_enabled;
+
+	struct {
+		uintptr_t addr;
+		u32 val;
+	} reg[REG_NUM_MAX];
+	u32 reg_num;
+
+	struct hw_stats stats;
+} hw;
+
+void hw_fail(const char *const fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	fprintf(stderr, "hw: ");
+	vfprintf(stderr, fmt, ap);
+	fprintf(stderr, " (at cycle %llu)\n", (unsigned long long)hw.cycles);
+	va_end(ap);
+
+	abort();
+}
+
+static void step(void)
+{
+	hw.cycles++;
+
+	hw_ssp_step();
+	hw_gpdma_step();
+}
+
+static u32 irq_prio(const enum nvic_irq irq)
+{
+	return (hw_reg_peek(NVIC_IPR0 + (irq & ~0x3U)) >> ((irq & 0x3) * 8)) &
+	       0xFF;
+}
+
+// Returns the source whose interrupt the core would take, ignoring PRIMASK,
+// or -1 if there is none. Lower numbers win between equal priorities, as on
+// the NVIC.
+static int irq_pending(void)
+{
+	int best = -1;
+
+	for (u32 i = 0; i < ARRAY_SIZE(irq_src); ++i) {
+		const enum nvic_irq irq = irq_src[i].irq;
+
+		if (!(hw.nvic_enabled & (UINT32_C(1) << irq)) ||
+		    !irq_src[i].line())
+			continue;
+
+		if (hw.basepri && (irq_prio(irq) >= hw.basepri))
+			continue;
+
+		if ((best < 0) || (irq_prio(irq) < irq_prio(irq_src[best].irq)))
+			best = i;
+	}
+	return best;
+}
+
+static void irq_dispatch(void)
+{
+	for (u32 run = 0; !hw.primask && !hw.in_isr; ++run) {
+		const int src = irq_pending();
+
+		if (src < 0)
+			return;
+
+		if (run >= ISR_RUN_MAX)
+			hw_fail("IRQ %d never goes away", irq_src[src].irq);
+
+		if (!irq_src[src].isr)
+			hw_fail("IRQ %d has no handler", irq_src[src].irq);
+
+		hw.in_isr = true;
+
+		for (u32 i = 0; i < HW_EXC_ENTRY_CYCLES; ++i)
+			step();
+
+		irq_src[src].isr();
+		hw.stats.isr_calls++;
+		hw.in_isr = false;
+	}
+}
+
+void hw_reset(void)
+{
+	memset(&hw, 0, sizeof(hw));
+	hw.mmio_cycles = HW_MMIO_CYCLES_DEFAULT;
+
+	hw_ssp_reset();
+	hw_gpdma_reset();
+}
+
+u64 hw_cycles(void)
+{
+	return hw.cycles;
+}
+
+void hw_advance(const u64 cycles)
+{
+	// With both models off, only the clock moves.
+	if (!hw_ssp_enabled() && !hw_gpdma_enabled()) {
+		hw.cycles += cycles;
+	} else {
+		for (u64 i = 0; i < cycles; ++i)
+			step();
+	}
+
+	irq_dispatch();
+}
+
+void hw_mmio_cycles_set(const u32 cycles)
+{
+	hw.mmio_cycles = cycles;
+}
+
+void hw_stall_set(const u32 period_cycles, const u32 stall_cycles)
+{
+	hw.stall_period = period_cycles;
+	hw.stall_cycles = stall_cycles;
+	hw.stall_next = hw.cycles + period_cycles;
+}
+
+// Charges a register access, and the stall it may have run into.
+static void mmio_access(void)
+{
+	hw.stats.mmio_accesses++;
+
+	if (hw.stall_period && !hw.in_isr && (hw.cycles >= hw.stall_next)) {
+		hw.stats.stalls++;
+		hw_advance(hw.stall_cycles);
+		hw.stall_next = hw.cycles + hw.stall_period;
+	}
+
+	hw_advance(hw.mmio_cycles);
+}
+
+u32 hw_reg_peek(const uintptr_t addr)
+{
+	for (u32 i = 0; i < hw.reg_num; ++i) {
+		if (hw.reg[i].addr == addr)
+			return hw.reg[i].val;
+	}
+	return 0;
+}
+
+void hw_reg_poke(const uintptr_t addr, const u32 val)
+{
+	for (u32 i = 0; i < hw.reg_num; ++i) {
+		if (hw.reg[i].addr == addr) {
+			hw.reg[i].val = val;
+			return;
+		}
+	}
+
+	if (hw.reg_num >= REG_NUM_MAX)
+		hw_fail("too many registers without a model");
+
+	hw.reg[hw.reg_num].addr = addr;
+	hw.reg[hw.reg_num].val = val;
+	hw.reg_num++;
+}
+
+void hw_stats_get(struct hw_stats *const stats)
+{
+	*stats = hw.stats;
+}
+
+void hw_stats_reset(void)
+{
+	memset(&hw.stats, 0, sizeof(hw.stats));
+}
+
+u32 mmio_read32(const uintptr_t addr)
+{
+	mmio_access();
+
+	for (u32 i = 0; i < ARRAY_SIZE(periph); ++i) {
+		if ((addr >= periph[i].base) &&
+		    (addr < periph[i].base + periph[i].size))
+			return periph[i].read(addr - periph[i].base);
+	}
+
+	switch (addr) {
+	case NVIC_ISER0:
+	case NVIC_ICER0:
+		return hw.nvic_enabled;
+
+	case DWT_REG_CYCCNT:
+		return hw.cycles;
+
+	default:
+		return hw_reg_peek(addr);
+	}
+}
+
+void mmio_write32(const uintptr_t addr, const u32 val)
+{
+	mmio_access();
+
+	for (u32 i = 0; i < ARRAY_SIZE(periph); ++i) {
+		if ((addr >= periph[i].base) &&
+		    (addr < periph[i].base + periph[i].size)) {
+			periph[i].write(addr - periph[i].base, val);
+			irq_dispatch();
+			return;
+		}
+	}
+
+	switch (addr) {
+	case NVIC_ISER0:
+		hw.nvic_enabled |= val;
+		break;
+
+	case NVIC_ICER0:
+		hw.nvic_enabled &= ~val;
+		break;
+
+	default:
+		hw_reg_poke(addr, val);
+		break;
+	}
+	irq_dispatch();
+}
+
+void nop(void)
+{
+	hw_advance(1);
+}
+
+void bkpt(void)
+{
+	hw_fail("app_assert() failed");
+}
+
+void irq_disable(void)
+{
+	hw.primask = true;
+}
+
+void irq_enable(void)
+{
+	hw.primask = false;
+	irq_dispatch();
+}
+
+void wfi(void)
+{
+	if (hw.in_isr)
+		hw_fail("wfi() in an interrupt handler");
+
+	u64 slept = 0;
+
+	while (irq_pending() < 0) {
+		if (++slept > SLEEP_CYCLES_MAX)
+			hw_fail("wfi() with nothing left to wake the core");
+
+		step();
+	}
+
+	hw.stats.sleep_cycles += slept;
+	irq_dispatch();
+}
+
+u32 basepri_read(void)
+{
+	return hw.basepri;
+}
+
+void basepri_write(const u32 val)
+{
+	hw.basepri = val;
+	irq_dispatch();
+}
@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/types.h"
+
+// A model of the parts of the LPC1769 the host tests run the firmware against.
+//
+// Time is counted in core clock cycles. It only moves when the firmware touches
+// a register, sleeps in wfi(), or a test advances it explicitly; code running
+// between those points is free. Every register access is charged a fixed
+// number of cycles to stand in for the access itself and for the instructions
+// around it, see hw_mmio_cycles_set().
+//
+// Registers without a model behind them read back what was last written.
+
+enum {
+	/** Cycles charged per register access unless a test says otherwise. */
+	HW_MMIO_CYCLES_DEFAULT = 4,
+
+	/** Cycles from an interrupt becoming pending to its handler running. */
+	HW_EXC_ENTRY_CYCLES = 12
+};
+
+struct hw_stats {
+	u64 mmio_accesses;
+
+	/** Cycles spent asleep in wfi(). */
+	u64 sleep_cycles;
+	u32 isr_calls;
+	u32 stalls;
+};
+
+/** Resets the core and every peripheral model. */
+void hw_reset(void);
+
+u64 hw_cycles(void);
+
+/** Lets @p cycles pass, taking any interrupt which becomes pending. */
+void hw_advance(u64 cycles);
+
+void hw_mmio_cycles_set(u32 cycles);
+
+/**
+ * Takes the core away for @p stall_cycles every @p period_cycles, as a long
+ * interrupt handler would; 0 turns it off. The stall starts at the next
+ * register access once a period has passed.
+ */
+void hw_stall_set(u32 period_cycles, u32 stall_cycles);
+
+/** Reads or writes a register without charging any time. */
+u32 hw_reg_peek(uintptr_t addr);
+void hw_reg_poke(uintptr_t addr, u32 val);
+
+void hw_stats_get(struct hw_stats *stats);
+void hw_stats_reset(void);
+
+/** Reports a broken expectation of the model and aborts the test. */
+void hw_fail(const char *fmt, ...)
+	__attribute__((noreturn, format(printf, 1, 2)));
+
+// SSP0, with the slave on the other end of the bus.
+
+struct hw_ssp_stats {
+	u32 frames;
+
+	/** Frames which did not start right as the previous one ended. */
+	u32 gaps;
+	u64 gap_cycles;
+
+	/** Frames lost because the RX FIFO was full when they arrived. */
+	u32 overruns;
+};
+
+/** Called with every frame the master sends; returns the one sent back. */
+typedef u8 (*hw_ssp_slave)(u8 mosi);
+
+void hw_ssp_slave_set(hw_ssp_slave slave);
+
+/** Cycles one frame takes at the current configuration. */
+u32 hw_ssp_frame_cycles(void);
+
+void hw_ssp_stats_get(struct hw_ssp_stats *stats);
+void hw_ssp_stats_reset(void);
+
+// The GPDMA controller, serving the SSP0 requests.
+
+struct hw_gpdma_ch_info {
+	u32 starts;
+
+	/** Addresses the channel was last started with. */
+	u32 src;
+	u32 dst;
+};
+
+void hw_gpdma_ch_info_get(u32 ch, struct hw_gpdma_ch_info *info);
+
+// Entry points of the peripheral models, used by hw.c.
+
+void hw_ssp_reset(void);
+u32 hw_ssp_read(u32 off);
+void hw_ssp_write(u32 off, u32 val);
+void hw_ssp_step(void);
+bool hw_ssp_enabled(void);
+bool hw_ssp_irq(void);
+
+bool hw_ssp_dma_tx_req(void);
+bool hw_ssp_dma_rx_req(void);
+void hw_ssp_dma_push(u8 val);
+u8 hw_ssp_dma_pop(void);
+
+void hw_gpdma_reset(void);
+u32 hw_gpdma_read(u32 off);
+void hw_gpdma_write(u32 off, u32 val);
+void hw_gpdma_step(void);
+bool hw_gpdma_enabled(void);
+bool hw_gpdma_irq(void);
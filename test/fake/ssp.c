@@ -0,0 +1,333 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <string.h>
+
+#include "common/util.h"
+#include "hal/sysctl.h"
+
+#include "hw.h"
+
+// SSP0 in SPI master mode. Each frame takes 8 bits of SCK and is exchanged
+// with the slave as a whole once its last bit has been shifted. A frame waiting
+// in the TX FIFO starts shifting in the cycle the previous one completes, as
+// the hardware does.
+
+enum {
+	REG_CR0 = 0x0,
+	REG_CR1 = 0x4,
+	REG_DR = 0x8,
+	REG_SR = 0xC,
+	REG_CPSR = 0x10,
+	REG_IMSC = 0x14,
+	REG_RIS = 0x18,
+	REG_MIS = 0x1C,
+	REG_ICR = 0x20,
+	REG_DMACR = 0x24
+};
+
+enum {
+	CR0_DSS_MASK = BITMASK_FROM_RANGE(0, 3),
+	CR0_SCR_SHIFT = 8,
+	CR1_SSE = BIT_1,
+
+	SR_TFE = BIT_0,
+	SR_TNF = BIT_1,
+	SR_RNE = BIT_2,
+	SR_RFF = BIT_3,
+	SR_BSY = BIT_4,
+
+	RIS_ROR = BIT_0,
+	RIS_RT = BIT_1,
+	RIS_RX = BIT_2,
+	RIS_TX = BIT_3,
+
+	DMACR_RXDMAE = BIT_0,
+	DMACR_TXDMAE = BIT_1,
+
+	PCLKSEL1_SSP0_SHIFT = 10,
+
+	FIFO_DEPTH = 8
+};
+
+struct fifo {
+	u8 buf[FIFO_DEPTH];
+	u32 head;
+	u32 count;
+};
+
+static struct {
+	u32 CR0;
+	u32 CR1;
+	u32 CPSR;
+	u32 IMSC;
+	u32 RIS;
+	u32 DMACR;
+
+	struct fifo tx;
+	struct fifo rx;
+
+	bool shifting;
+	u8 mosi;
+	u32 shift_left;
+
+	/** When the last frame completed, if one has since the stats reset. */
+	bool done_any;
+	u64 done_at;
+
+	hw_ssp_slave slave;
+	struct hw_ssp_stats stats;
+} ssp;
+
+static bool fifo_push(struct fifo *const f, const u8 val)
+{
+	if (f->count >= FIFO_DEPTH)
+		return false;
+
+	f->buf[(f->head + f->count) % FIFO_DEPTH] = val;
+	f->count++;
+
+	return true;
+}
+
+static u8 fifo_pop(struct fifo *const f)
+{
+	if (!f->count)
+		return 0;
+
+	const u8 val = f->buf[f->head];
+
+	f->head = (f->head + 1) % FIFO_DEPTH;
+	f->count--;
+
+	return val;
+}
+
+static u8 slave_loopback(const u8 mosi)
+{
+	return mosi;
+}
+
+static u32 ris(void)
+{
+	u32 RIS = ssp.RIS;
+
+	if (ssp.rx.count >= (FIFO_DEPTH / 2))
+		RIS |= RIS_RX;
+
+	if (ssp.tx.count <= (FIFO_DEPTH / 2))
+		RIS |= RIS_TX;
+
+	return RIS;
+}
+
+void hw_ssp_reset(void)
+{
+	memset(&ssp, 0, sizeof(ssp));
+	ssp.slave = slave_loopback;
+}
+
+void hw_ssp_slave_set(const hw_ssp_slave slave)
+{
+	ssp.slave = slave ? slave : slave_loopback;
+}
+
+u32 hw_ssp_frame_cycles(void)
+{
+	// PCLK_SSP0 is CCLK divided by 4, 1, 2 or 8.
+	static const u32 pclk_div[] = { 4, 1, 2, 8 };
+
+	const u32 sel =
+		(hw_reg_peek(SYSCTL_REG_PCLKSEL1) >> PCLKSEL1_SSP0_SHIFT) & 0x3;
+	const u32 bits = (ssp.CR0 & CR0_DSS_MASK) + 1;
+	const u32 scr = ssp.CR0 >> CR0_SCR_SHIFT;
+
+	return pclk_div[sel] * ssp.CPSR * (scr + 1) * bits;
+}
+
+void hw_ssp_stats_get(struct hw_ssp_stats *const stats)
+{
+	*stats = ssp.stats;
+}
+
+void hw_ssp_stats_reset(void)
+{
+	memset(&ssp.stats, 0, sizeof(ssp.stats));
+	ssp.done_any = false;
+}
+
+u32 hw_ssp_read(const u32 off)
+{
+	switch (off) {
+	case REG_CR0:
+		return ssp.CR0;
+
+	case REG_CR1:
+		return ssp.CR1;
+
+	case REG_DR:
+		return fifo_pop(&ssp.rx);
+
+	case REG_SR: {
+		u32 SR = 0;
+
+		if (!ssp.tx.count)
+			SR |= SR_TFE;
+
+		if (ssp.tx.count < FIFO_DEPTH)
+			SR |= SR_TNF;
+
+		if (ssp.rx.count)
+			SR |= SR_RNE;
+
+		if (ssp.rx.count >= FIFO_DEPTH)
+			SR |= SR_RFF;
+
+		if (ssp.shifting || ssp.tx.count)
+			SR |= SR_BSY;
+
+		return SR;
+	}
+
+	case REG_CPSR:
+		return ssp.CPSR;
+
+	case REG_IMSC:
+		return ssp.IMSC;
+
+	case REG_RIS:
+		return ris();
+
+	case REG_MIS:
+		return ris() & ssp.IMSC;
+
+	case REG_DMACR:
+		return ssp.DMACR;
+
+	default:
+		return 0;
+	}
+}
+
+void hw_ssp_write(const u32 off, const u32 val)
+{
+	switch (off) {
+	case REG_CR0:
+		ssp.CR0 = val & 0xFFFF;
+		break;
+
+	case REG_CR1:
+		ssp.CR1 = val & 0xF;
+		break;
+
+	case REG_DR:
+		if (!fifo_push(&ssp.tx, val))
+			hw_fail("SSP0: DR written with the TX FIFO full");
+		break;
+
+	case REG_CPSR:
+		if ((val & 0xFF) < 2 || (val & 1))
+			hw_fail("SSP0: CPSDVSR must be even and at least 2");
+
+		ssp.CPSR = val & 0xFF;
+		break;
+
+	case REG_IMSC:
+		ssp.IMSC = val & 0xF;
+		break;
+
+	case REG_ICR:
+		ssp.RIS &= ~(val & (RIS_ROR | RIS_RT));
+		break;
+
+	case REG_DMACR:
+		ssp.DMACR = val & 0x3;
+		break;
+
+	default:
+		break;
+	}
+}
+
+bool hw_ssp_enabled(void)
+{
+	return ssp.CR1 & CR1_SSE;
+}
+
+void hw_ssp_step(void)
+{
+	if (!(ssp.CR1 & CR1_SSE))
+		return;
+
+	const u64 now = hw_cycles();
+
+	if (ssp.shifting && !--ssp.shift_left) {
+		const u8 miso = ssp.slave(ssp.mosi);
+
+		ssp.shifting = false;
+		ssp.done_any = true;
+		ssp.done_at = now;
+		ssp.stats.frames++;
+
+		if (!fifo_push(&ssp.rx, miso)) {
+			ssp.RIS |= RIS_ROR;
+			ssp.stats.overruns++;
+		}
+	}
+
+	if (!ssp.shifting && ssp.tx.count) {
+		ssp.mosi = fifo_pop(&ssp.tx);
+		ssp.shifting = true;
+		ssp.shift_left = hw_ssp_frame_cycles();
+
+		if (ssp.done_any && (now > ssp.done_at)) {
+			ssp.stats.gaps++;
+			ssp.stats.gap_cycles += now - ssp.done_at;
+		}
+	}
+}
+
+bool hw_ssp_irq(void)
+{
+	return ris() & ssp.IMSC;
+}
+
+bool hw_ssp_dma_tx_req(void)
+{
+	return (ssp.DMACR & DMACR_TXDMAE) && (ssp.tx.count < FIFO_DEPTH);
+}
+
+bool hw_ssp_dma_rx_req(void)
+{
+	return (ssp.DMACR & DMACR_RXDMAE) && ssp.rx.count;
+}
+
+void hw_ssp_dma_push(const u8 val)
+{
+	if (!fifo_push(&ssp.tx, val))
+		hw_fail("SSP0: DMA wrote with the TX FIFO full");
+}
+
+u8 hw_ssp_dma_pop(void)
+{
+	return fifo_pop(&ssp.rx);
+}
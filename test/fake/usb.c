@@ -0,0 +1,180 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stdint.h>
+#include <string.h>
+
+#include "hw.h"
+#include "usb.h"
+
+enum {
+	BUF_SIZE = 1 << 20,
+
+	/** Full-speed bulk endpoints. */
+	PACKET_SIZE = 64
+};
+
+struct pipe {
+	u8 buf[BUF_SIZE];
+	u32 head;
+
+	/** The end of what the other side may take. */
+	u32 ready;
+	u32 tail;
+};
+
+static struct {
+	u32 chunk;
+
+	struct {
+		struct pipe rx;
+
+		// Ready for the host once the firmware flushes it.
+		struct pipe tx;
+
+		u32 tx_space;
+
+		struct ccc_usb_tx_stats stats;
+	} link[CCC_USB_LINK_NUM];
+} usb;
+
+static void pipe_put(struct pipe *const p, const u8 *const src, const u32 size)
+{
+	if (size > BUF_SIZE - p->tail) {
+		// Everything before head has been consumed; make room.
+		memmove(p->buf, &p->buf[p->head], p->tail - p->head);
+		p->ready -= p->head;
+		p->tail -= p->head;
+		p->head = 0;
+	}
+
+	if (size > BUF_SIZE - p->tail)
+		hw_fail("USB: %u bytes do not fit into the pipe", size);
+
+	memcpy(&p->buf[p->tail], src, size);
+	p->tail += size;
+}
+
+static u32 pipe_get(struct pipe *const p, u8 *const dst, const u32 size)
+{
+	u32 n = p->ready - p->head;
+
+	if (n > size)
+		n = size;
+
+	memcpy(dst, &p->buf[p->head], n);
+	p->head += n;
+
+	return n;
+}
+
+void hw_usb_reset(void)
+{
+	memset(&usb, 0, sizeof(usb));
+	usb.chunk = CCC_USB_RX_SIZE_MAX;
+
+	for (u32 i = 0; i < CCC_USB_LINK_NUM; ++i)
+		usb.link[i].tx_space = UINT32_MAX;
+}
+
+void hw_usb_chunk_set(const u32 size)
+{
+	usb.chunk = size;
+}
+
+void hw_usb_tx_space_set(const enum ccc_usb_link link, const u32 size)
+{
+	usb.link[link].tx_space = size;
+}
+
+void hw_usb_host_send(const enum ccc_usb_link link, const u8 *const src,
+		      const u32 size)
+{
+	struct pipe *const rx = &usb.link[link].rx;
+
+	pipe_put(rx, src, size);
+	rx->ready = rx->tail;
+}
+
+u32 hw_usb_host_pending(const enum ccc_usb_link link)
+{
+	return usb.link[link].rx.tail - usb.link[link].rx.head;
+}
+
+u32 hw_usb_host_recv(const enum ccc_usb_link link, u8 *const dst,
+		     const u32 size)
+{
+	return pipe_get(&usb.link[link].tx, dst, size);
+}
+
+u32 ccc_usb_read(const enum ccc_usb_link link, u8 *const dst, const u32 size)
+{
+	return pipe_get(&usb.link[link].rx, dst,
+			(size < usb.chunk) ? size : usb.chunk);
+}
+
+bool ccc_usb_write(const enum ccc_usb_link link,
+		   const struct ccc_usb_buf *const bufs, const u32 num)
+{
+	u32 size = 0;
+
+	for (u32 i = 0; i < num; ++i)
+		size += bufs[i].size;
+
+	if (size > usb.link[link].tx_space) {
+		usb.link[link].stats.drops++;
+		return false;
+	}
+
+	if (usb.link[link].tx_space != UINT32_MAX)
+		usb.link[link].tx_space -= size;
+
+	for (u32 i = 0; i < num; ++i)
+		pipe_put(&usb.link[link].tx, bufs[i].data, bufs[i].size);
+
+	usb.link[link].stats.bytes += size;
+	return true;
+}
+
+void ccc_usb_flush(const enum ccc_usb_link link)
+{
+	struct pipe *const tx = &usb.link[link].tx;
+	const u32 size = tx->tail - tx->ready;
+
+	if (!size)
+		return;
+
+	usb.link[link].stats.packets += (size / PACKET_SIZE) + 1;
+	usb.link[link].stats.flushes++;
+	tx->ready = tx->tail;
+}
+
+void ccc_usb_tx_stats_get(const enum ccc_usb_link link,
+			  struct ccc_usb_tx_stats *const stats)
+{
+	*stats = usb.link[link].stats;
+}
+
+void ccc_usb_dispatch_stats_get(struct ccc_usb_dispatch_stats *const stats)
+{
+	memset(stats, 0, sizeof(*stats));
+}
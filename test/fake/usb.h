@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "board/ccc/usb.h"
+#include "common/types.h"
+
+// The host end of the command links, standing in for board/ccc/usb.c. Bytes
+// the host sends are handed out by ccc_usb_read() in chunks of at most the
+// configured size; bytes the firmware writes reach the host once it flushes.
+
+void hw_usb_reset(void);
+
+/** Largest number of bytes a single ccc_usb_read() returns. */
+void hw_usb_chunk_set(u32 size);
+
+/**
+ * Limits the TX FIFO of @p link to @p size more bytes, as when the host stops
+ * reading. Unlimited after hw_usb_reset().
+ */
+void hw_usb_tx_space_set(enum ccc_usb_link link, u32 size);
+
+void hw_usb_host_send(enum ccc_usb_link link, const u8 *src, u32 size);
+
+/** Returns the number of bytes sent by the host not yet read. */
+u32 hw_usb_host_pending(enum ccc_usb_link link);
+
+/**
+ * Moves up to @p size bytes the firmware has flushed into @p dst.
+ *
+ * @returns The number of bytes moved.
+ */
+u32 hw_usb_host_recv(enum ccc_usb_link link, u8 *dst, u32 size);
@@ -0,0 +1,443 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <string.h>
+
+#include "board/nfc/iso14443_4.h"
+#include "board/nfc/iso14443a.h"
+#include "fake/field.h"
+#include "fake/hw.h"
+#include "hal/sysctl.h"
+
+#include "test.h"
+
+// Block exchanges with a simulated card: chaining both ways, recovery from
+// lost and garbled blocks, waiting time extensions and bit rates up to
+// 848 kbit/s.
+
+enum {
+	// FSC 128, FWI 4, SFGI 1, all bit rates both ways
+	ATS_T0 = 0x77,
+	ATS_TA = 0x77,
+	ATS_TB = 0x41,
+	ATS_TC = 0x02,
+	ATS_HIST = 0x80,
+
+	FSC = 128,
+	FSD = ISO14443_4_FSD,
+	FWT_US = 8458,
+
+	WTXM = 5,
+
+	APDU_SIZE_MAX = 4096
+};
+
+static const u8 ats[] = { 6, ATS_T0, ATS_TA, ATS_TB, ATS_TC, ATS_HIST };
+
+static u32 card_id;
+
+static u32 hash(const u8 *const buf, const u32 size)
+{
+	u32 h = 2166136261;
+
+	for (u32 i = 0; i < size; ++i)
+		h = (h ^ buf[i]) * 16777619;
+
+	return h;
+}
+
+/**
+ * Answers with as many bytes as the first two of the command ask for, derived
+ * from all of the command.
+ */
+static u32 app(const u8 *const cmd, const u32 size, u8 *const rsp)
+{
+	if (size < 2)
+		return 0;
+
+	const u32 rsp_size = cmd[0] | (cmd[1] << 8);
+	const u32 h = hash(cmd, size);
+
+	for (u32 i = 0; i < rsp_size; ++i)
+		rsp[i] = (h >> ((i % 4) * 8)) ^ i;
+
+	return rsp_size;
+}
+
+static void setup(const u16 chain_size, const u8 wtx_num,
+		  const u32 proc_us)
+{
+	hw_reset();
+	hw_field_reset();
+
+	struct hw_card card = {
+		// clang-format off
+
+		.uid		= { 0x04, 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC },
+		.uid_size	= 7,
+		.atqa		= { 0x44, 0x03 },
+		.sak		= ISO14443A_SAK_ISO14443_4,
+		.ats_size	= sizeof(ats),
+		.chain_size	= chain_size,
+		.wtx_num	= wtx_num,
+		.wtxm		= WTXM,
+		.proc_us	= proc_us,
+		.app		= app
+
+		// clang-format on
+	};
+
+	memcpy(card.ats, ats, sizeof(ats));
+	card_id = hw_field_card_add(&card);
+
+	struct iso14443a_card selected;
+	struct iso14443_4_ats parsed;
+
+	CHECK(nfc_protocol_set(NFC_PROTOCOL_MIFARE_106));
+	CHECK_EQ(iso14443a_activate(ISO14443A_REQ_REQA, &selected),
+		 NFC_STATUS_OK);
+	CHECK_EQ(iso14443_4_rats(&parsed), NFC_STATUS_OK);
+	CHECK_EQ(hw_field_card_state(card_id), HW_CARD_PROTOCOL);
+}
+
+static u32 blocks(const u32 size, const u32 inf_size_max)
+{
+	return size ? (size + inf_size_max - 1) / inf_size_max : 1;
+}
+
+/**
+ * Sends a command of @p tx_size bytes asking for @p rsp_size bytes, and
+ * checks the response.
+ */
+static void exchange(const u32 tx_size, const u32 rsp_size)
+{
+	static u8 tx[APDU_SIZE_MAX];
+	static u8 rx[APDU_SIZE_MAX];
+	static u8 expected[APDU_SIZE_MAX];
+
+	tx[0] = rsp_size >> 0;
+	tx[1] = rsp_size >> 8;
+
+	for (u32 i = 2; i < tx_size; ++i)
+		tx[i] = (i * 31) ^ tx_size;
+
+	const u32 expected_size = app(tx, tx_size, expected);
+
+	u32 rx_size;
+
+	CHECK_EQ(iso14443_4_exchange(tx, tx_size, rx, sizeof(rx), &rx_size),
+		 NFC_STATUS_OK);
+	CHECK_EQ(rx_size, expected_size);
+	CHECK(!memcmp(rx, expected, rx_size));
+}
+
+static const u32 tx_sizes[] = {
+	2, FSC - 4, FSC - 3, FSC - 2, 2 * (FSC - 3), (2 * (FSC - 3)) + 1, 1000
+};
+
+static const u32 rsp_sizes[] = {
+	0, 1, FSD - 4, FSD - 3, FSD - 2, 1500, APDU_SIZE_MAX
+};
+
+static void test_rats(void)
+{
+	struct iso14443a_card selected;
+	struct iso14443_4_ats parsed;
+
+	setup(0, 0, 0);
+
+	CHECK_EQ(iso14443_4_deselect(), NFC_STATUS_OK);
+	CHECK_EQ(hw_field_card_state(card_id), HW_CARD_HALT);
+
+	CHECK_EQ(iso14443a_activate(ISO14443A_REQ_WUPA, &selected),
+		 NFC_STATUS_OK);
+	CHECK_EQ(iso14443_4_rats(&parsed), NFC_STATUS_OK);
+
+	CHECK_EQ(parsed.fsc, FSC);
+	CHECK_EQ(parsed.fwt_us, FWT_US);
+	CHECK_EQ(parsed.ta, ATS_TA);
+	CHECK_EQ(parsed.tb, ATS_TB);
+	CHECK_EQ(parsed.tc, ATS_TC);
+	CHECK_EQ(parsed.hist_size, 1);
+	CHECK_EQ(parsed.hist[0], ATS_HIST);
+}
+
+static void test_chaining(void)
+{
+	static const u16 chain_sizes[] = { 0, 61 };
+
+	for (u32 c = 0; c < ARRAY_SIZE(chain_sizes); ++c) {
+		setup(chain_sizes[c], 0, 0);
+
+		const u32 rx_inf_size_max =
+			chain_sizes[c] ? chain_sizes[c] : FSD - 3;
+
+		for (u32 t = 0; t < ARRAY_SIZE(tx_sizes); ++t) {
+			for (u32 r = 0; r < ARRAY_SIZE(rsp_sizes); ++r) {
+				struct hw_field_stats before;
+				struct hw_field_stats after;
+
+				hw_field_stats_get(&before);
+				exchange(tx_sizes[t], rsp_sizes[r]);
+				hw_field_stats_get(&after);
+
+				// One frame per block each way, the R(ACK)s
+				// asking for the rest of the response
+				// included, and nothing else.
+				CHECK_EQ(after.frames - before.frames,
+					 blocks(tx_sizes[t], FSC - 3) +
+						 blocks(rsp_sizes[r],
+							rx_inf_size_max) -
+						 1);
+			}
+		}
+
+		struct iso14443_4_stats stats;
+		iso14443_4_stats_get(&stats);
+
+		CHECK_EQ(stats.retransmissions, 0);
+
+		struct hw_field_stats field;
+		hw_field_stats_get(&field);
+
+		CHECK_EQ(field.rejects, 0);
+		CHECK_EQ(field.timeouts, 0);
+	}
+}
+
+static void test_noise(void)
+{
+	static const u32 periods[][2] = {
+		{ 3, 0 }, { 0, 3 }, { 4, 5 }, { 5, 4 }, { 7, 3 }, { 3, 7 },
+	};
+
+	for (u32 p = 0; p < ARRAY_SIZE(periods); ++p) {
+		setup(61, p % 2, 0);
+
+		struct iso14443_4_stats before;
+		iso14443_4_stats_get(&before);
+
+		hw_field_noise_set(periods[p][0], periods[p][1]);
+
+		for (u32 t = 0; t < ARRAY_SIZE(tx_sizes); ++t) {
+			for (u32 r = 0; r < ARRAY_SIZE(rsp_sizes); ++r)
+				exchange(tx_sizes[t], rsp_sizes[r]);
+		}
+
+		struct iso14443_4_stats after;
+		iso14443_4_stats_get(&after);
+
+		struct hw_field_stats field;
+		hw_field_stats_get(&field);
+
+		CHECK(field.errors > 0);
+		CHECK_EQ(after.failures, before.failures);
+		CHECK(after.retransmissions - before.retransmissions >=
+		      field.errors);
+	}
+}
+
+static void test_wtx(void)
+{
+	// The card needs more time than the frame waiting time, and asks for
+	// it.
+	setup(61, 3, 2 * FWT_US);
+
+	struct iso14443_4_stats before;
+	struct iso14443_4_stats after;
+	struct hw_field_stats field_before;
+	struct hw_field_stats field_after;
+
+	iso14443_4_stats_get(&before);
+	hw_field_stats_get(&field_before);
+
+	exchange(300, 1000);
+
+	iso14443_4_stats_get(&after);
+	hw_field_stats_get(&field_after);
+
+	CHECK_EQ(after.wtx - before.wtx, 3);
+	CHECK_EQ(after.retransmissions, before.retransmissions);
+	CHECK_EQ(field_after.timeouts, field_before.timeouts);
+	CHECK_EQ(field_after.frames - field_before.frames,
+		 blocks(300, FSC - 3) + blocks(1000, 61) - 1 + 3);
+
+	// Without asking, it is too late.
+	setup(0, 0, 2 * FWT_US);
+
+	u8 tx[2] = { 0 };
+	u8 rx[16];
+	u32 rx_size;
+
+	CHECK_EQ(iso14443_4_exchange(tx, sizeof(tx), rx, sizeof(rx), &rx_size),
+		 NFC_STATUS_OK);
+
+	iso14443_4_stats_get(&after);
+	CHECK(after.retransmissions > 0);
+
+	// A card asking for more than the reader grants is given up on.
+	setup(0, 33, 0);
+
+	CHECK_EQ(iso14443_4_exchange(tx, sizeof(tx), rx, sizeof(rx), &rx_size),
+		 NFC_STATUS_TIMEOUT);
+}
+
+static void test_pps(void)
+{
+	static const enum iso14443_4_div divs[][2] = {
+		{ ISO14443_4_DIV_2, ISO14443_4_DIV_1 },
+		{ ISO14443_4_DIV_1, ISO14443_4_DIV_8 },
+		{ ISO14443_4_DIV_4, ISO14443_4_DIV_4 },
+		{ ISO14443_4_DIV_8, ISO14443_4_DIV_2 },
+	};
+
+	for (u32 i = 0; i < ARRAY_SIZE(divs); ++i) {
+		setup(0, 0, 0);
+
+		CHECK_EQ(iso14443_4_pps(divs[i][0], divs[i][1]),
+			 NFC_STATUS_OK);
+
+		exchange(FSC * 2, FSD * 2);
+
+		// Back at 106 kbit/s for the next activation.
+		CHECK_EQ(iso14443_4_deselect(), NFC_STATUS_OK);
+		CHECK_EQ(hw_field_card_state(card_id), HW_CARD_HALT);
+
+		struct iso14443a_card selected;
+
+		CHECK_EQ(iso14443a_activate(ISO14443A_REQ_WUPA, &selected),
+			 NFC_STATUS_OK);
+	}
+
+	// The highest bit rates the ATS allows, both ways.
+	struct iso14443_4_ats parsed;
+
+	setup(0, 0, 0);
+	CHECK_EQ(iso14443_4_deselect(), NFC_STATUS_OK);
+
+	struct iso14443a_card selected;
+
+	CHECK_EQ(iso14443a_activate(ISO14443A_REQ_WUPA, &selected),
+		 NFC_STATUS_OK);
+	CHECK_EQ(iso14443_4_rats(&parsed), NFC_STATUS_OK);
+
+	enum iso14443_4_div ds;
+	enum iso14443_4_div dr;
+
+	CHECK_EQ(iso14443_4_rate_raise(&parsed, &ds, &dr), NFC_STATUS_OK);
+	CHECK_EQ(ds, ISO14443_4_DIV_8);
+	CHECK_EQ(dr, ISO14443_4_DIV_8);
+
+	exchange(1000, 1000);
+
+	struct hw_field_stats field;
+	hw_field_stats_get(&field);
+
+	CHECK_EQ(field.rejects, 0);
+}
+
+/**
+ * Runs @p num exchanges of @p tx_size bytes out and @p rsp_size back at
+ * 106 kbit/s times @p div both ways, and returns the throughput of INF bytes
+ * in simulated time, in bit/s.
+ */
+static u64 bench_run(const enum iso14443_4_div div, const u32 num,
+		     const u32 tx_size, const u32 rsp_size,
+		     const u32 noise_period, const u8 wtx_num)
+{
+	setup(0, wtx_num, 0);
+
+	if (div != ISO14443_4_DIV_1)
+		CHECK_EQ(iso14443_4_pps(div, div), NFC_STATUS_OK);
+
+	hw_field_noise_set(noise_period, noise_period ? noise_period + 2 : 0);
+
+	const u64 start = hw_cycles();
+
+	for (u32 i = 0; i < num; ++i)
+		exchange(tx_size, rsp_size);
+
+	const u64 cycles = hw_cycles() - start;
+	const u64 bits = (u64)num * (tx_size + rsp_size) * 8;
+
+	return (bits * SYSCTL_CCLK_HZ) / cycles;
+}
+
+/**
+ * Throughput of exchanges against the simulated card, in time on air and
+ * waiting for the card; the firmware's own processing time is not modelled.
+ */
+static void bench_throughput(void)
+{
+	static const char *const rates[ISO14443_4_DIV_NUM] = {
+		"106", "212", "424", "848"
+	};
+
+	static const struct {
+		const char *name;
+		u32 tx_size;
+		u32 rsp_size;
+		u32 noise_period;
+		u8 wtx_num;
+	} cases[] = {
+		// clang-format off
+
+		{ "short",		16,	16,	0,	0 },
+		{ "chained",		1000,	4000,	0,	0 },
+		{ "chained, noise",	1000,	4000,	5,	0 },
+		{ "chained, wtx",	1000,	4000,	0,	2 },
+
+		// clang-format on
+	};
+
+	for (u32 c = 0; c < ARRAY_SIZE(cases); ++c) {
+		u64 prev = 0;
+
+		for (u32 div = 0; div < ISO14443_4_DIV_NUM; ++div) {
+			const u64 bps = bench_run(div, 8, cases[c].tx_size,
+						  cases[c].rsp_size,
+						  cases[c].noise_period,
+						  cases[c].wtx_num);
+
+			printf("bench: %-16s %s kbit/s: %4llu kbit/s\n",
+			       cases[c].name, rates[div],
+			       (unsigned long long)bps / 1000);
+
+			// A higher bit rate must pay off, even with the
+			// fixed frame delay times and timeouts.
+			CHECK(bps > prev);
+			prev = bps;
+		}
+	}
+}
+
+int main(void)
+{
+	RUN(test_rats);
+	RUN(test_chaining);
+	RUN(test_noise);
+	RUN(test_wtx);
+	RUN(test_pps);
+	RUN(bench_throughput);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,431 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <string.h>
+
+#include "board/nfc/inventory.h"
+#include "board/nfc/iso14443a.h"
+#include "fake/field.h"
+#include "fake/hw.h"
+
+#include "test.h"
+
+// Activation and anticollision against cards in a simulated field, down to the
+// bit on which their UIDs first differ.
+
+enum {
+	CASCADE_TAG = 0x88,
+	BRANCH_NUM_MAX = 8
+};
+
+static struct {
+	struct iso14443a_path paths[BRANCH_NUM_MAX];
+	u32 num;
+} branches;
+
+static u32 rand_state;
+
+static u8 rand_u8(void)
+{
+	rand_state = (rand_state * 1103515245) + 12345;
+	return rand_state >> 16;
+}
+
+static void branch_push(void *const ctx,
+			const struct iso14443a_path *const branch)
+{
+	CHECK(ctx == &branches);
+	CHECK(branches.num < BRANCH_NUM_MAX);
+
+	branches.paths[branches.num++] = *branch;
+}
+
+static void setup(void)
+{
+	hw_reset();
+	hw_field_reset();
+
+	memset(&branches, 0, sizeof(branches));
+	rand_state = 1;
+}
+
+static struct hw_card card_make(const u8 uid_size)
+{
+	struct hw_card card = {
+		// clang-format off
+
+		.uid_size	= uid_size,
+		.atqa		= { 0x44, 0x00 },
+		.sak		= 0x08
+
+		// clang-format on
+	};
+
+	for (u32 i = 0; i < uid_size; ++i)
+		card.uid[i] = rand_u8();
+
+	// A cascade tag as the first byte is reserved.
+	if (card.uid[0] == CASCADE_TAG)
+		card.uid[0] = 0;
+
+	return card;
+}
+
+/** The UID CLn of @p card at @p level, as sent during anticollision */
+static void uid_cl(const struct hw_card *const card, const u32 level,
+		   u8 *const cl)
+{
+	const u32 level_num = (card->uid_size == 4) ? 1 :
+			      (card->uid_size == 7) ? 2 :
+						      3;
+	const u8 *const uid = &card->uid[level * 3];
+
+	if (level + 1 < level_num) {
+		cl[0] = CASCADE_TAG;
+		memcpy(&cl[1], uid, 3);
+	} else {
+		memcpy(cl, uid, 4);
+	}
+
+	cl[4] = cl[0] ^ cl[1] ^ cl[2] ^ cl[3];
+}
+
+static bool bit_get(const u8 *const buf, const u32 pos)
+{
+	return (buf[pos / 8] >> (pos % 8)) & 1;
+}
+
+static void bit_set(u8 *const buf, const u32 pos, const bool val)
+{
+	if (val)
+		buf[pos / 8] |= 1U << (pos % 8);
+	else
+		buf[pos / 8] &= ~(1U << (pos % 8));
+}
+
+static void check_card(const struct iso14443a_card *const card,
+		       const struct hw_card *const expected)
+{
+	CHECK_EQ(card->uid_size, expected->uid_size);
+	CHECK(!memcmp(card->uid, expected->uid, expected->uid_size));
+	CHECK_EQ(card->sak, expected->sak);
+}
+
+/**
+ * Checks that @p branch leads to the cards with a 0 at bit @p pos of the UID
+ * CLn at @p level, below the path to @p card.
+ */
+static void check_branch(const struct iso14443a_path *const branch,
+			 const struct hw_card *const card, const u32 level,
+			 const u32 pos)
+{
+	CHECK_EQ(branch->level, level);
+	CHECK_EQ(branch->known_bits, pos + 1);
+
+	u8 cl[ISO14443A_UID_CL_SIZE];
+
+	for (u32 l = 0; l < level; ++l) {
+		uid_cl(card, l, cl);
+		CHECK(!memcmp(branch->uid_cl[l], cl, sizeof(cl)));
+	}
+
+	uid_cl(card, level, cl);
+
+	for (u32 i = 0; i < pos; ++i)
+		CHECK_EQ(bit_get(branch->uid_cl[level], i), bit_get(cl, i));
+
+	CHECK(!bit_get(branch->uid_cl[level], pos));
+}
+
+static void select_card(struct iso14443a_path *const path,
+			const struct hw_card *const expected)
+{
+	struct iso14443a_card card;
+
+	CHECK_EQ(iso14443a_request(ISO14443A_REQ_REQA, card.atqa),
+		 NFC_STATUS_OK);
+	CHECK_EQ(iso14443a_select_path(path, branch_push, &branches, &card),
+		 NFC_STATUS_OK);
+	check_card(&card, expected);
+
+	CHECK_EQ(iso14443a_halt(), NFC_STATUS_OK);
+}
+
+static void test_single(void)
+{
+	static const u8 uid_sizes[] = { 4, 7, 10 };
+
+	for (u32 i = 0; i < ARRAY_SIZE(uid_sizes); ++i) {
+		setup();
+
+		const struct hw_card cfg = card_make(uid_sizes[i]);
+		const u32 id = hw_field_card_add(&cfg);
+
+		struct iso14443a_card card;
+
+		CHECK_EQ(iso14443a_activate(ISO14443A_REQ_REQA, &card),
+			 NFC_STATUS_OK);
+		check_card(&card, &cfg);
+		CHECK(!memcmp(card.atqa, cfg.atqa, sizeof(cfg.atqa)));
+		CHECK_EQ(hw_field_card_state(id), HW_CARD_ACTIVE);
+
+		// A halted card only answers WUPA.
+		CHECK_EQ(iso14443a_halt(), NFC_STATUS_OK);
+		CHECK_EQ(hw_field_card_state(id), HW_CARD_HALT);
+		CHECK_EQ(iso14443a_activate(ISO14443A_REQ_REQA, &card),
+			 NFC_STATUS_TIMEOUT);
+		CHECK_EQ(iso14443a_reselect(ISO14443A_REQ_WUPA, &card),
+			 NFC_STATUS_OK);
+		CHECK_EQ(hw_field_card_state(id), HW_CARD_ACTIVE);
+
+		// Reselecting takes one SELECT per level and no anticollision.
+		struct hw_field_stats before;
+		struct hw_field_stats after;
+
+		CHECK_EQ(iso14443a_halt(), NFC_STATUS_OK);
+		hw_field_stats_get(&before);
+		CHECK_EQ(iso14443a_reselect(ISO14443A_REQ_WUPA, &card),
+			 NFC_STATUS_OK);
+		hw_field_stats_get(&after);
+
+		CHECK_EQ(after.frames - before.frames, 1 + (1 + i));
+	}
+}
+
+/**
+ * Two cards whose UIDs differ only at bit @p pos of the UID CLn at @p level,
+ * which is where they collide. The BCCs differ as well, but only after it.
+ */
+static void collide(const u8 uid_size, const u32 level, const u32 pos)
+{
+	setup();
+
+	struct hw_card one = card_make(uid_size);
+
+	u8 *const uid = &one.uid[level * 3];
+	u32 uid_pos = pos;
+
+	// Below the last level, the first byte holds the cascade tag.
+	if (level + 1 < ((uid_size == 4) ? 1U : (uid_size == 7) ? 2U : 3U)) {
+		if (pos < 8)
+			return;
+
+		uid_pos -= 8;
+	}
+
+	bit_set(uid, uid_pos, true);
+
+	struct hw_card zero = one;
+	bit_set(&zero.uid[level * 3], uid_pos, false);
+
+	if (zero.uid[0] == CASCADE_TAG)
+		return;
+
+	// The card with a 1 at the colliding bit wins.
+	hw_field_card_add(&zero);
+	hw_field_card_add(&one);
+
+	struct iso14443a_path path = { 0 };
+	select_card(&path, &one);
+
+	CHECK_EQ(branches.num, 1);
+	check_branch(&branches.paths[0], &one, level, pos);
+
+	// The other card dropped out when the first one was selected, and is
+	// found by resuming the walk from the branch, continuing the UID in
+	// the middle of a byte unless the collision was on its last bit.
+	path = branches.paths[--branches.num];
+	select_card(&path, &zero);
+
+	CHECK_EQ(branches.num, 0);
+
+	struct iso14443a_card card;
+
+	CHECK_EQ(iso14443a_request(ISO14443A_REQ_REQA, card.atqa),
+		 NFC_STATUS_TIMEOUT);
+}
+
+static void test_collision(void)
+{
+	for (u32 pos = 0; pos < 32; ++pos) {
+		collide(4, 0, pos);
+		collide(7, 1, pos);
+		collide(10, 2, pos);
+		collide(10, 1, pos);
+	}
+}
+
+/**
+ * Three cards, colliding first at bit @p pos_a, then among the two with a 1
+ * there, at bit @p pos_b. The second collision is reported for a response
+ * which starts at the bit after @p pos_a.
+ */
+static void collide_twice(const u32 pos_a, const u32 pos_b)
+{
+	setup();
+
+	struct hw_card one = card_make(4);
+
+	bit_set(one.uid, pos_a, true);
+	bit_set(one.uid, pos_b, true);
+
+	struct hw_card zero_a = one;
+	bit_set(zero_a.uid, pos_a, false);
+
+	struct hw_card zero_b = one;
+	bit_set(zero_b.uid, pos_b, false);
+
+	if ((zero_a.uid[0] == CASCADE_TAG) || (zero_b.uid[0] == CASCADE_TAG))
+		return;
+
+	hw_field_card_add(&zero_a);
+	hw_field_card_add(&zero_b);
+	hw_field_card_add(&one);
+
+	struct iso14443a_path path = { 0 };
+	select_card(&path, &one);
+
+	CHECK_EQ(branches.num, 2);
+	check_branch(&branches.paths[0], &one, 0, pos_a);
+	check_branch(&branches.paths[1], &one, 0, pos_b);
+
+	path = branches.paths[--branches.num];
+	select_card(&path, &zero_b);
+
+	path = branches.paths[--branches.num];
+	select_card(&path, &zero_a);
+
+	CHECK_EQ(branches.num, 0);
+
+	struct iso14443a_stats stats;
+	iso14443a_stats_get(&stats);
+
+	CHECK(stats.collisions >= 2);
+}
+
+static void test_collision_twice(void)
+{
+	for (u32 pos_a = 0; pos_a < 32; ++pos_a) {
+		for (u32 pos_b = pos_a + 1; pos_b < 32; ++pos_b)
+			collide_twice(pos_a, pos_b);
+	}
+}
+
+static bool card_listed(const struct hw_card *const cfg)
+{
+	u32 num;
+	const struct iso14443a_card *const cards = inventory_cards_get(&num);
+
+	for (u32 i = 0; i < num; ++i) {
+		if ((cards[i].uid_size == cfg->uid_size) &&
+		    !memcmp(cards[i].uid, cfg->uid, cfg->uid_size))
+			return true;
+	}
+
+	return false;
+}
+
+static void test_inventory(void)
+{
+	static const u8 uid_sizes[] = { 4, 7, 10 };
+
+	struct hw_card cfgs[INVENTORY_CARD_NUM_MAX];
+	u32 ids[INVENTORY_CARD_NUM_MAX];
+
+	setup();
+	inventory_reset();
+
+	// Some of the longer UIDs share their first cascade level, so that
+	// they only collide at the next one.
+	for (u32 i = 0; i < INVENTORY_CARD_NUM_MAX; ++i) {
+		cfgs[i] = card_make(uid_sizes[i % ARRAY_SIZE(uid_sizes)]);
+
+		if ((i >= 3) && (cfgs[i].uid_size != 4) && (i % 2))
+			memcpy(cfgs[i].uid, cfgs[i - 3].uid, 3);
+
+		cfgs[i].atqa[0] = rand_u8();
+		ids[i] = hw_field_card_add(&cfgs[i]);
+	}
+
+	struct inventory_stats before;
+	struct inventory_stats after;
+
+	inventory_stats_get(&before);
+	CHECK_EQ(inventory_poll(), INVENTORY_CARD_NUM_MAX);
+	inventory_stats_get(&after);
+
+	for (u32 i = 0; i < INVENTORY_CARD_NUM_MAX; ++i) {
+		CHECK(card_listed(&cfgs[i]));
+		CHECK_EQ(hw_field_card_state(ids[i]), HW_CARD_HALT);
+	}
+
+	// Every node visited found a card: none of the branches pushed was
+	// lost, and the walk never had to start over from the root.
+	CHECK_EQ(after.arrivals - before.arrivals, INVENTORY_CARD_NUM_MAX);
+	CHECK_EQ(after.branches - before.branches, INVENTORY_CARD_NUM_MAX);
+
+	struct inventory_event event;
+	u32 events = 0;
+
+	while (inventory_event_pop(&event)) {
+		CHECK_EQ(event.type, INVENTORY_EVENT_ARRIVED);
+		events++;
+	}
+
+	CHECK_EQ(events, INVENTORY_CARD_NUM_MAX);
+
+	// Nothing changes on the next poll.
+	CHECK_EQ(inventory_poll(), INVENTORY_CARD_NUM_MAX);
+	CHECK(!inventory_event_pop(&event));
+
+	// Some cards leave, and others take their place.
+	for (u32 i = 0; i < INVENTORY_CARD_NUM_MAX; i += 4)
+		hw_field_card_remove(ids[i]);
+
+	CHECK_EQ(inventory_poll(), INVENTORY_CARD_NUM_MAX * 3 / 4);
+
+	for (u32 i = 0; i < INVENTORY_CARD_NUM_MAX; i += 4) {
+		CHECK(!card_listed(&cfgs[i]));
+
+		CHECK(inventory_event_pop(&event));
+		CHECK_EQ(event.type, INVENTORY_EVENT_DEPARTED);
+
+		cfgs[i] = card_make(7);
+		ids[i] = hw_field_card_add(&cfgs[i]);
+	}
+
+	CHECK(!inventory_event_pop(&event));
+	CHECK_EQ(inventory_poll(), INVENTORY_CARD_NUM_MAX);
+
+	for (u32 i = 0; i < INVENTORY_CARD_NUM_MAX; ++i)
+		CHECK(card_listed(&cfgs[i]));
+}
+
+int main(void)
+{
+	RUN(test_single);
+	RUN(test_collision);
+	RUN(test_collision_twice);
+	RUN(test_inventory);
+
+	return EXIT_SUCCESS;
+}
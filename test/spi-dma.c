@@ -0,0 +1,272 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <string.h>
+
+#include "board/nfc/spi.h"
+#include "drivers/clrc663/clrc663-spi.h"
+#include "fake/hw.h"
+#include "hal/gpdma.h"
+
+#include "test.h"
+
+enum {
+	SSP0_REG_SR = 0x4008800C,
+	SR_RNE = BIT_2,
+
+	// The slave answers every frame with the frame it was sent, XORed with
+	// this.
+	SLAVE_XOR = 0xA5
+};
+
+static struct {
+	u8 mosi[1024];
+	u32 count;
+} bus;
+
+static u8 slave(const u8 mosi)
+{
+	if (bus.count < sizeof(bus.mosi))
+		bus.mosi[bus.count] = mosi;
+
+	bus.count++;
+	return mosi ^ SLAVE_XOR;
+}
+
+static void setup(void)
+{
+	hw_reset();
+	hw_ssp_slave_set(slave);
+
+	gpdma_init();
+	nfc_spi_init();
+
+	memset(&bus, 0, sizeof(bus));
+	hw_stats_reset();
+	hw_ssp_stats_reset();
+}
+
+static void pattern(u8 *const buf, const u32 size, const u8 seed)
+{
+	for (u32 i = 0; i < size; ++i)
+		buf[i] = seed + (i * 7);
+}
+
+static void check_rx(const u8 *const tx, const u8 *const rx, const u32 size)
+{
+	CHECK_EQ(bus.count, size);
+	CHECK(!memcmp(bus.mosi, tx, size));
+
+	for (u32 i = 0; i < size; ++i)
+		CHECK_EQ(rx[i], tx[i] ^ SLAVE_XOR);
+}
+
+static u32 ch_starts(const enum gpdma_channel ch)
+{
+	struct hw_gpdma_ch_info info;
+
+	hw_gpdma_ch_info_get(ch, &info);
+	return info.starts;
+}
+
+// Buffers in GPDMA_MEM are handed to the controller as they are, and the core
+// sleeps while the transfer runs.
+static void test_in_place(void)
+{
+	static GPDMA_MEM u8 tx[300];
+	static GPDMA_MEM u8 rx[300];
+
+	setup();
+	pattern(tx, sizeof(tx), 1);
+
+	const u64 start = hw_cycles();
+	drv_clrc663_spi_tx_rx_blocking(tx, rx, sizeof(tx));
+	const u64 elapsed = hw_cycles() - start;
+
+	check_rx(tx, rx, sizeof(tx));
+
+	struct hw_gpdma_ch_info rx_ch;
+	struct hw_gpdma_ch_info tx_ch;
+
+	hw_gpdma_ch_info_get(GPDMA_CHANNEL_0, &rx_ch);
+	hw_gpdma_ch_info_get(GPDMA_CHANNEL_1, &tx_ch);
+
+	CHECK_EQ(rx_ch.starts, 1);
+	CHECK_EQ(tx_ch.starts, 1);
+	CHECK_EQ(rx_ch.dst, (uintptr_t)rx);
+	CHECK_EQ(tx_ch.src, (uintptr_t)tx);
+
+	struct hw_stats stats;
+	hw_stats_get(&stats);
+
+	CHECK(stats.isr_calls >= 1);
+	CHECK(stats.sleep_cycles >= (elapsed * 9) / 10);
+
+	struct hw_ssp_stats ssp;
+	hw_ssp_stats_get(&ssp);
+
+	CHECK_EQ(ssp.frames, sizeof(tx));
+	CHECK_EQ(ssp.gaps, 0);
+	CHECK_EQ(ssp.overruns, 0);
+}
+
+// Buffers the controller cannot reach go through the staging buffers.
+static void test_staged(void)
+{
+	u8 tx[300];
+	u8 rx[300];
+
+	CHECK(!gpdma_addr_reachable(tx));
+	CHECK(!gpdma_addr_reachable(rx));
+
+	setup();
+	pattern(tx, sizeof(tx), 2);
+	memset(rx, 0, sizeof(rx));
+
+	drv_clrc663_spi_tx_rx_blocking(tx, rx, sizeof(tx));
+	check_rx(tx, rx, sizeof(tx));
+
+	struct hw_gpdma_ch_info rx_ch;
+	struct hw_gpdma_ch_info tx_ch;
+
+	hw_gpdma_ch_info_get(GPDMA_CHANNEL_0, &rx_ch);
+	hw_gpdma_ch_info_get(GPDMA_CHANNEL_1, &tx_ch);
+
+	CHECK(gpdma_addr_reachable((const void *)(uintptr_t)rx_ch.dst));
+	CHECK(gpdma_addr_reachable((const void *)(uintptr_t)tx_ch.src));
+}
+
+static void test_rx_fill(void)
+{
+	static GPDMA_MEM u8 rx[100];
+
+	setup();
+	drv_clrc663_spi_rx_fill_blocking(0x8B, rx, sizeof(rx));
+
+	CHECK_EQ(bus.count, sizeof(rx));
+
+	for (u32 i = 0; i < sizeof(rx); ++i) {
+		CHECK_EQ(bus.mosi[i], 0x8B);
+		CHECK_EQ(rx[i], 0x8B ^ SLAVE_XOR);
+	}
+}
+
+// What is received while only transmitting is drained by the DMA as well, so
+// nothing is left behind for the next transfer.
+static void test_tx_only(void)
+{
+	static GPDMA_MEM u8 tx[200];
+
+	setup();
+	pattern(tx, sizeof(tx), 3);
+
+	drv_clrc663_spi_tx_blocking(tx, sizeof(tx));
+
+	CHECK_EQ(bus.count, sizeof(tx));
+	CHECK(!memcmp(bus.mosi, tx, sizeof(tx)));
+	CHECK(!(mmio_read32(SSP0_REG_SR) & SR_RNE));
+}
+
+// Transfers which fit the FIFO are done by hand.
+static void test_small(void)
+{
+	u8 tx[8];
+	u8 rx[8];
+
+	setup();
+	pattern(tx, sizeof(tx), 4);
+
+	drv_clrc663_spi_tx_rx_blocking(tx, rx, sizeof(tx));
+	check_rx(tx, rx, sizeof(tx));
+
+	CHECK_EQ(ch_starts(GPDMA_CHANNEL_0), 0);
+	CHECK_EQ(ch_starts(GPDMA_CHANNEL_1), 0);
+}
+
+static struct {
+	u32 calls;
+	bool err;
+} done;
+
+static void dma_done(const enum spi_instance inst, const bool err,
+		     void *const ctx)
+{
+	CHECK_EQ(inst, SPI_INST);
+	CHECK(ctx == &done);
+
+	done.calls++;
+	done.err = err;
+}
+
+// A chain of descriptors runs as one transfer and completes once, from the
+// GPDMA interrupt.
+static void test_desc_chain(void)
+{
+	static GPDMA_MEM u8 tx[64];
+	static GPDMA_MEM u8 rx[64];
+	static GPDMA_MEM u8 tail[16];
+
+	setup();
+	pattern(tx, sizeof(tx), 5);
+	pattern(tail, sizeof(tail), 6);
+	memset(&done, 0, sizeof(done));
+
+	const struct spi_dma_desc desc[] = {
+		// clang-format off
+
+		{ .src = tx, .dst = rx, .size = sizeof(tx) },
+		{ .fill = 0x3C, .size = 10 },
+		{ .src = tail, .size = sizeof(tail) }
+
+		// clang-format on
+	};
+
+	spi_dma_tx_rx_u8(SPI_INST, desc, ARRAY_SIZE(desc), dma_done, &done);
+
+	while (spi_dma_busy(SPI_INST))
+		hw_advance(1);
+
+	CHECK_EQ(done.calls, 1);
+	CHECK(!done.err);
+
+	CHECK_EQ(bus.count, sizeof(tx) + 10 + sizeof(tail));
+	CHECK(!memcmp(bus.mosi, tx, sizeof(tx)));
+	CHECK(!memcmp(&bus.mosi[sizeof(tx) + 10], tail, sizeof(tail)));
+
+	for (u32 i = 0; i < 10; ++i)
+		CHECK_EQ(bus.mosi[sizeof(tx) + i], 0x3C);
+
+	for (u32 i = 0; i < sizeof(tx); ++i)
+		CHECK_EQ(rx[i], tx[i] ^ SLAVE_XOR);
+}
+
+int main(void)
+{
+	RUN(test_in_place);
+	RUN(test_staged);
+	RUN(test_rx_fill);
+	RUN(test_tx_only);
+	RUN(test_small);
+	RUN(test_desc_chain);
+
+	return EXIT_SUCCESS;
+}
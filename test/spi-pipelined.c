@@ -0,0 +1,259 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <string.h>
+
+#include "board/nfc/spi.h"
+#include "fake/hw.h"
+#include "hal/util.h"
+
+#include "test.h"
+
+// The blocking SPI transfers keep up to a FIFO's worth of frames in flight.
+// These tests run them against the cycle-counting SSP0 model and check that
+// SCK never idles between two frames and that the RX FIFO never overruns.
+//
+// Each register access is charged HW_MMIO_CYCLES_DEFAULT cycles, standing in
+// for the access over the APB and for the loop's own instructions. The overrun
+// checks do not depend on that: they are repeated with a core far slower than
+// the bus, and with one taken away for longer than both FIFOs last.
+
+enum {
+	SSP0_REG_DR = 0x40088008,
+	SSP0_REG_SR = 0x4008800C,
+	SSP0_REG_IMSC = 0x40088014,
+	SSP0_REG_RIS = 0x40088018,
+
+	SR_TNF = BIT_1,
+	SR_RNE = BIT_2,
+	RIS_ROR = BIT_0,
+
+	// The fastest SCK the SSP can generate: CCLK / 2.
+	PRESCALER_MIN = 2,
+
+	// nfc_spi_init(): CCLK / 24.
+	BOARD_PRESCALER = 24,
+
+	XFER_SIZE_MAX = 513
+};
+
+static u8 slave(const u8 mosi)
+{
+	return ~mosi;
+}
+
+static void setup(const u8 prescaler)
+{
+	hw_reset();
+	hw_ssp_slave_set(slave);
+
+	const struct spi_cfg_moto_master cfg = {
+		// clang-format off
+
+		.clk_speed		= SYSCTL_PCLKSEL_CCLK_DIV_1,
+		.data_size		= SPI_DATA_SIZE_8BIT,
+		.cpol			= SPI_CFG_MOTO_SPI_CPOL_LOW,
+		.cpha			= SPI_CFG_MOTO_SPI_CPHA_FIRST,
+		.prescaler		= prescaler,
+		.serial_clk_rate	= 0
+
+		// clang-format on
+	};
+	spi_init_moto_master(SPI_INST, &cfg);
+}
+
+enum xfer_kind {
+	XFER_TX_RX,
+	XFER_TX,
+	XFER_RX
+};
+
+// Runs one transfer and checks what was received. Returns the cycles it took.
+static u64 xfer(const enum xfer_kind kind, const u32 size)
+{
+	static u8 tx[XFER_SIZE_MAX];
+	static u8 rx[XFER_SIZE_MAX];
+
+	for (u32 i = 0; i < size; ++i)
+		tx[i] = i * 13;
+
+	memset(rx, 0, sizeof(rx));
+	hw_ssp_stats_reset();
+
+	const u64 start = hw_cycles();
+
+	switch (kind) {
+	case XFER_TX_RX:
+		spi_tx_rx_blocking_u8(SPI_INST, tx, rx, size);
+
+		for (u32 i = 0; i < size; ++i)
+			CHECK_EQ(rx[i], (u8)~tx[i]);
+		break;
+
+	case XFER_TX:
+		spi_tx_blocking_u8(SPI_INST, tx, size);
+		break;
+
+	case XFER_RX:
+		spi_rx_blocking_u8(SPI_INST, 0x5A, rx, size);
+
+		for (u32 i = 0; i < size; ++i)
+			CHECK_EQ(rx[i], (u8)~0x5A);
+		break;
+
+	default:
+		CHECK(false);
+	}
+
+	const u64 elapsed = hw_cycles() - start;
+
+	struct hw_ssp_stats ssp;
+	hw_ssp_stats_get(&ssp);
+
+	CHECK_EQ(ssp.frames, size);
+	CHECK_EQ(ssp.overruns, 0);
+	CHECK(!(mmio_read32(SSP0_REG_SR) & SR_RNE));
+
+	return elapsed;
+}
+
+static const u32 sizes[] = { 1, 2, 7, 8, 9, 16, 64, 255, XFER_SIZE_MAX };
+
+// No gaps at the clock the board runs the CLRC663 at, nor at the fastest one.
+// The transfer then takes as long as its frames, plus the time to get the
+// first one going and to see the last one out.
+static void check_back_to_back(const u8 prescaler)
+{
+	setup(prescaler);
+
+	const u32 frame = hw_ssp_frame_cycles();
+
+	for (u32 k = XFER_TX_RX; k <= XFER_RX; ++k) {
+		for (u32 i = 0; i < ARRAY_SIZE(sizes); ++i) {
+			const u64 elapsed = xfer(k, sizes[i]);
+
+			struct hw_ssp_stats ssp;
+			hw_ssp_stats_get(&ssp);
+
+			CHECK_EQ(ssp.gaps, 0);
+			CHECK(elapsed <= ((u64)sizes[i] * frame) +
+						 (16 * HW_MMIO_CYCLES_DEFAULT));
+		}
+	}
+}
+
+static void test_board_clock(void)
+{
+	check_back_to_back(BOARD_PRESCALER);
+}
+
+static void test_fastest_clock(void)
+{
+	check_back_to_back(PRESCALER_MIN);
+}
+
+// A core too slow for the bus can only cause gaps, never an overrun. RORIM is
+// enabled in debug builds, so an overrun would also end the test through
+// isr_SSP0.
+static void test_slow_core(void)
+{
+	setup(PRESCALER_MIN);
+
+	CHECK(mmio_read32(SSP0_REG_IMSC) & BIT_0);
+
+	const u32 frame = hw_ssp_frame_cycles();
+	hw_mmio_cycles_set(20 * frame);
+
+	for (u32 k = XFER_TX_RX; k <= XFER_RX; ++k) {
+		for (u32 i = 0; i < ARRAY_SIZE(sizes); ++i) {
+			xfer(k, sizes[i]);
+
+			struct hw_ssp_stats ssp;
+			hw_ssp_stats_get(&ssp);
+
+			CHECK((sizes[i] == 1) || ssp.gaps);
+		}
+	}
+
+	CHECK(!(mmio_read32(SSP0_REG_RIS) & RIS_ROR));
+}
+
+// Neither can an interrupt taking the core away for longer than both FIFOs
+// last: nothing is written to the TX FIFO while a FIFO's worth of frames has
+// not been collected yet. At the board's clock the loop keeps the TX FIFO full
+// most of the time, which is when a stall hurts most.
+static void test_preempted(void)
+{
+	setup(BOARD_PRESCALER);
+
+	const u32 frame = hw_ssp_frame_cycles();
+
+	// Every period is tried, so that the stall hits the loop at every point
+	// of its progress.
+	for (u32 period = 1; period <= 40 * HW_MMIO_CYCLES_DEFAULT; ++period) {
+		hw_stall_set(period, 20 * frame);
+
+		for (u32 k = XFER_TX_RX; k <= XFER_RX; ++k)
+			xfer(k, 32);
+	}
+
+	struct hw_stats stats;
+	hw_stats_get(&stats);
+
+	CHECK(stats.stalls > 0);
+	CHECK(!(mmio_read32(SSP0_REG_RIS) & RIS_ROR));
+}
+
+// Filling the TX FIFO whenever there is room, and being preempted, overruns
+// the RX FIFO, which shows that the model catches it.
+static void test_model_catches_overrun(void)
+{
+	setup(BOARD_PRESCALER);
+	mmio_write32(SSP0_REG_IMSC, 0);
+	hw_stall_set(40 * HW_MMIO_CYCLES_DEFAULT, 20 * hw_ssp_frame_cycles());
+
+	for (u32 sent = 0; sent < 32;) {
+		if (mmio_read32(SSP0_REG_SR) & SR_TNF) {
+			mmio_write32(SSP0_REG_DR, sent);
+			sent++;
+		}
+	}
+
+	hw_advance(64 * hw_ssp_frame_cycles());
+
+	struct hw_ssp_stats ssp;
+	hw_ssp_stats_get(&ssp);
+
+	CHECK(ssp.overruns > 0);
+	CHECK(mmio_read32(SSP0_REG_RIS) & RIS_ROR);
+}
+
+int main(void)
+{
+	RUN(test_board_clock);
+	RUN(test_fastest_clock);
+	RUN(test_slow_core);
+	RUN(test_preempted);
+	RUN(test_model_catches_overrun);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright 2025 Michael Rodriguez
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the “Software”), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Every test is a program of its own, exiting with a non-zero status on the
+// first failed check.
+
+#define CHECK(expr)                                                  \
+	({                                                           \
+		if (!(expr)) {                                       \
+			fprintf(stderr, "%s:%d: CHECK(%s) failed\n", \
+				__FILE__, __LINE__, #expr);          \
+			exit(EXIT_FAILURE);                          \
+		}                                                    \
+	})
+
+#define CHECK_EQ(a, b)                                               \
+	({                                                           \
+		const unsigned long long _a = (a);                   \
+		const unsigned long long _b = (b);                   \
+                                                                     \
+		if (_a != _b) {                                      \
+			fprintf(stderr,                              \
+				"%s:%d: CHECK_EQ(%s, %s) failed: "   \
+				"%llu != %llu\n",                    \
+				__FILE__, __LINE__, #a, #b, _a, _b); \
+			exit(EXIT_FAILURE);                          \
+		}                                                    \
+	})
+
+#define RUN(test)                         \
+	({                                \
+		test();                   \
+		printf("ok %s\n", #test); \
+	})